@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+
+namespace smf {
+
+// Largest denominator used when a float is converted to a Duration.
+constexpr int64_t MAX_DURATION_DENOMINATOR = 1 << 16;
+
+/*
+ * An exact length of time in quarter notes, stored as a fraction in lowest
+ * terms, e.g. 4/3 for each note of a triplet of half notes.  Adding up
+ * Durations does not drift like adding up floats does, and the fractions
+ * tell MidiOutput which resolution renders them exactly.  If a result would
+ * overflow 64 bits, it is rounded to a nearby fraction with a denominator
+ * of at most MAX_DURATION_DENOMINATOR instead.
+ */
+class Duration {
+private:
+    int64_t num;
+    int64_t den; // always positive
+
+public:
+    explicit Duration(int64_t numerator = 0, int64_t denominator = 1);
+
+    // The simplest fraction close to a float: the last continued fraction
+    // convergent with a denominator of at most maxDenominator, e.g. 0.8f
+    // --> 4/5 and 1.3333334f --> 4/3.  Binary fractions such as 0.375 are
+    // converted exactly.
+    static Duration fromFloat(double value,
+        int64_t maxDenominator = MAX_DURATION_DENOMINATOR);
+
+    int64_t getNumerator() const;
+    int64_t getDenominator() const;
+    float toFloat() const;
+
+    // The nearest tick at a resolution of ticksPerQuarter ticks per
+    // quarter note (halves are rounded up).  Exact when ticksPerQuarter is
+    // a multiple of the denominator.
+    int64_t toTicks(int ticksPerQuarter) const;
+
+    Duration& operator+=(const Duration &d);
+    friend Duration operator+(Duration a, const Duration &b);
+    Duration& operator*=(const Duration &d);
+    friend Duration operator*(Duration a, const Duration &b);
+
+    friend bool operator==(const Duration &a, const Duration &b);
+    friend bool operator!=(const Duration &a, const Duration &b);
+
+    friend std::ostream& operator<<(std::ostream &os, const Duration &d);
+};
+
+inline int64_t Duration::getNumerator() const {
+    return num;
+}
+
+inline int64_t Duration::getDenominator() const {
+    return den;
+}
+
+} // namespace smf
@@ -1,6 +1,7 @@
 #pragma once
 
-#include <map>
+#include <array>
+#include <initializer_list>
 #include <string>
 #include <vector>
 #include "Pitch.hpp"
@@ -22,7 +23,13 @@ const vector<int> OCTATONIC = { 0, 2, 3, 5, 6, 8, 9, 11 };
 
 class Scale {
 private:
-    vector<int> scaleDegrees;
+    // The degrees are stored in the Scale itself, so Scales can be copied
+    // and used for modulating without allocating memory.
+    std::array<int, OCTAVE_WIDTH> scaleDegrees;
+    int count = 0;
+
+    // Add a degree to the end of the scale (at most 12).
+    void addDegree(int degree);
 
     // Make each scale degree higher than the next.
     void makeAscending();
@@ -36,16 +43,19 @@ public:
     const int& operator[](int index) const;
     int& operator[](int index);
 
-    // Get a mapping to another scale. The keys are the pitches of the current
-    // scale and the values are the deltas to the corresponding pitches in the
-    // new scale.
-    map<int, int> createMappingTo(const Scale &s) const;
+    // Get a mapping to another scale: for the pitch class of each degree of
+    // the current scale, the delta to the corresponding degree of the new
+    // scale.
+    PitchClassDeltas createMappingTo(const Scale &s) const;
 
     // Constructs a chord from the specified scale degree.
     Pitch getPitch(int degree) const;
 
     // Constructs a chord from the specified degrees in a scale.
-    Note getChord(vector<int> degrees, float length = DEFAULT_LENGTH) const;
+    Note getChord(std::initializer_list<int> degrees,
+        float length = DEFAULT_LENGTH) const;
+    Note getChord(const vector<int> &degrees,
+        float length = DEFAULT_LENGTH) const;
 };
 
 } // namespace smf
@@ -7,10 +7,18 @@
 #include "Note.hpp"
 #include "Pitch.hpp"
 #include "Track.hpp"
+#include "TrackTransform.hpp"
 
 namespace smf {
 
-constexpr uint8_t TICKS_PER_QUARTER = 120;
+// The resolution of the output is the smallest multiple of
+// TICKS_PER_QUARTER which renders every note length exactly, as long as it
+// is at most MAX_TICKS_PER_QUARTER (the largest MIDI resolution).
+constexpr int TICKS_PER_QUARTER = 120;
+constexpr int MAX_TICKS_PER_QUARTER = 0x7fff;
+// The latest tick which can be written: a delta time is stored in at most
+// four bytes of seven bits each.
+constexpr int64_t MAX_TICK = 0x0fffffff;
 constexpr uint8_t META_MSG = 0xff;
 constexpr uint8_t TEMPO_CHANGE = 0x51;
 constexpr uint8_t NOTE_ON = 0x90;
@@ -26,8 +34,21 @@ private:
     int tempo;
     vector<Track> tracks;
 
-    void writeNotes(MidiFile& outputFile, Note c, Track trk, int trackNum,
-        int actionTime);
+    // Transpositions, modulations and resizes of each Track which have not
+    // been applied yet.  They are applied to each Note as it is rendered,
+    // and the Tracks themselves are never changed.
+    vector<TrackTransform> transforms;
+
+    // Render tracks on multiple threads when writing large files.
+    bool parallel = true;
+
+    // Ticks per quarter note of the output file, or 0 to choose them from
+    // the note lengths.
+    int ticksPerQuarter = 0;
+
+    // Render the notes of a Track into a track of the output file.
+    void writeTrack(MidiFile& outputFile, const Track& trk,
+        const TrackTransform& t, int trackNum, int pitchCount, int tpq) const;
 
 public:
 
@@ -39,15 +60,34 @@ public:
 
     void setTempo(int t);
 
+    // Whether write() may render tracks on multiple threads (the output
+    // is the same either way).
+    bool isParallel() const;
+    void setParallel(bool p);
+
+    // Fix the resolution of the output file, or 0 (the default) to choose
+    // it when writing.  Note boundaries which do not fall on a tick are
+    // rounded to the nearest tick.
+    int getTicksPerQuarter() const;
+    void setTicksPerQuarter(int tpq);
+
     void addTrack(Track trk);
 
+    // Transform the tracks which have been added so far.
     void transpose(int delta);
 
     void resize(float factor);
 
     void modulate(const Scale &src, const Scale &dest);
 
-    void write(string filename);
+    void transform(const TrackTransform &t);
+
+    void write(const string& filename) const;
+
+    // Write the same file as write() with a MidiStreamWriter, one track at a
+    // time on this thread, without building a MidiFile in memory.  Notes
+    // with negative lengths cannot be streamed.
+    void stream(const string& filename) const;
 };
 
 } // namespace smf
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "MidiOutput.hpp"
+#include "Note.hpp"
+#include "Track.hpp"
+#include "TrackTransform.hpp"
+
+namespace smf {
+
+/*
+ * Writes a Standard MIDI File while the notes are generated, one track at
+ * a time, without building a MidiFile.  Events are written as soon as they
+ * are known, and the length of each track chunk (and the number of tracks
+ * in the header) is filled in when it is finished, so the output must be a
+ * file or another seekable stream.  Memory use is bounded by the note-offs
+ * which are still waiting to be written, however long the piece is.
+ *
+ * The first track holds the tempo, like the files of MidiOutput::write().
+ * Note boundaries are rounded to the nearest tick at the resolution given
+ * to the constructor.  Exceptions leave an incomplete file.
+ */
+class MidiStreamWriter {
+public:
+    // A generator of notes: fills in the next Note and returns true, or
+    // returns false at the end of the track.
+    using NoteSource = std::function<bool(Note &note)>;
+
+private:
+    std::ofstream file;
+    std::ostream &out;
+    int ticksPerQuarter;
+    int trackCount = 0;
+    bool closed = false;
+    std::streampos fileStart;
+
+    // State of the track being written.
+    bool inTrack = false;
+    std::streampos chunkStart;
+    vector<uchar> buffer;     // events not written to out yet
+    Duration time;            // exact end of the last note
+    int64_t actionTime = 0;   // ticks of time
+    int64_t lastTick = 0;     // tick of the last event written
+    int octaveOffset = 0;
+    uchar velocity = 0;
+
+    // note-offs which have not been written yet: (tick, order, key), with
+    // the earliest (and then the first added) on top
+    using PendingOff = std::tuple<int64_t, uint64_t, uchar>;
+    std::priority_queue<PendingOff, vector<PendingOff>,
+        std::greater<PendingOff> > offs;
+    uint64_t offCount = 0;
+
+    void writeHeader(int tempo);
+    void writeEvent(int64_t tick, uchar command, uchar p1, uchar p2);
+    void flushBuffer();
+
+public:
+    MidiStreamWriter(const string &filename, int tempo = 120,
+        int ticksPerQuarter = TICKS_PER_QUARTER);
+    MidiStreamWriter(std::ostream &out, int tempo = 120,
+        int ticksPerQuarter = TICKS_PER_QUARTER);
+    ~MidiStreamWriter();
+
+    int getTicksPerQuarter() const;
+
+    // Number of tracks written so far, including the tempo track.
+    int getTrackCount() const;
+
+    // Write a track note by note.
+    void beginTrack(int octave = DEFAULT_OCTAVE,
+        int velocity = DEFAULT_VELOCITY);
+    void addNote(const Note &note);
+    void endTrack();
+
+    // Write a whole Track (with a transform applied to each of its notes,
+    // leaving the Track unchanged), or the notes of a generator, as one
+    // track.
+    void writeTrack(const Track &trk,
+        const TrackTransform &t = TrackTransform{});
+    void writeTrack(const NoteSource &next, int octave = DEFAULT_OCTAVE,
+        int velocity = DEFAULT_VELOCITY);
+
+    // Finish the file.  Called by the destructor if needed.
+    void close();
+};
+
+} // namespace smf
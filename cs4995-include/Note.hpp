@@ -3,11 +3,13 @@
 #include <map>
 #include <iostream>
 #include <sstream>
+#include "Duration.hpp"
 #include "Pitch.hpp"
 
 namespace smf {
 
-// In MIDI format, the unit of length is a quarter note.
+// In MIDI format, the unit of length is a quarter note.  Float lengths are
+// stored as exact Durations (see Duration::fromFloat()).
 constexpr float QUARTER_LENGTH = 1.0;
 constexpr float HALF_LENGTH = 2.0;
 constexpr float WHOLE_LENGTH = 4.0;
@@ -27,22 +29,27 @@ private:
     // Empty vector represents a rest, and a vector with more than one
     // element represents a chord.
     vector<Pitch> pitches;
-    float length;
+    Duration length;
 
 public:
 
     // Construct a chord out of a vector of Pitches.
-    Note(const vector<Pitch> &pitches, float length = DEFAULT_LENGTH);
+    Note(vector<Pitch> pitches, float length = DEFAULT_LENGTH);
+    Note(vector<Pitch> pitches, Duration length);
 
     // Construct a single note.
     Note(Pitch pitch, float length = DEFAULT_LENGTH);
+    Note(Pitch pitch, Duration length);
 
     // Construct an empty note, i.e. a rest.
     Note(float length = DEFAULT_LENGTH);
+    Note(Duration length);
 
-    vector<Pitch> getPitches();
+    const vector<Pitch>& getPitches() const;
     float getLength() const;
     void setLength(float l);
+    const Duration& getDuration() const;
+    void setDuration(const Duration &d);
     bool isRest() const;
     bool isSingleNote() const;
     const Pitch& operator[](int index) const;
@@ -57,9 +64,8 @@ public:
     friend Note& operator<<(Note &note, Pitch p);
     friend Note& operator<<(Note &note, vector<Pitch> pitches);
 
-    // Modify each Pitch represented by a key in the map. Each value
-    // represents the delta for changing the corresponding Pitch.
-    void transform(const map<int, int> &deltas);
+    // Modify each Pitch by the delta for its pitch class.
+    void transform(const PitchClassDeltas &deltas);
 
 };
 
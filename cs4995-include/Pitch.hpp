@@ -1,9 +1,12 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <map>
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <vector>
 
 namespace smf {
 
@@ -17,14 +20,24 @@ enum BasePitch {
     C = 0, D = 2, E = 4, F = 5, G = 7, A = 9, B = 11
 };
 
-const map<char, BasePitch> charPitchMap {
-    {'C', C}, {'D', D}, {'E', E}, {'F', F}, {'G', G}, {'A', A}, {'B', B}
-};
+// BasePitch of each letter from 'A' to 'G', for parsing.
+constexpr BasePitch letterPitchTable[7] = { A, B, C, D, E, F, G };
 
-const map<char, int> charAccidentalMap {
-    {'#', 1} /* sharp */, {'b', -1} /* flat */
+// Accidental used to spell each pitch class (C = 0 to B = 11) when a Pitch
+// is made from a MIDI number: C#, Eb, F#, Ab and Bb.
+constexpr int8_t spellingTable[OCTAVE_WIDTH] = {
+    0, 1, 0, -1, 0, 0, 1, 0, -1, 0, -1, 0
 };
 
+// Pitch class (0 to 11) of a MIDI number, also for negative numbers.
+constexpr int pitchClass(int midiValue) {
+    return (midiValue % OCTAVE_WIDTH + OCTAVE_WIDTH) % OCTAVE_WIDTH;
+}
+
+// Interval to move the pitches of each pitch class by, e.g. for changing
+// key (see Scale::createMappingTo()).  0 leaves them unchanged.
+using PitchClassDeltas = std::array<int8_t, OCTAVE_WIDTH>;
+
 
 /*
  * Helper functions for processing character and string representations for
@@ -44,13 +57,14 @@ int octaveFromString(string token);
 
 /*
  * A Pitch is composed of a base note, an optional accidental, and an octave.
- * For example, middle C is { C, 0, 5 }.
+ * For example, middle C is { C, 0, 5 }.  It is stored as its MIDI number
+ * plus the accidental used to spell it, so it fits in four bytes and
+ * transposing it is integer arithmetic.
  */
 class Pitch {
 private:
-    BasePitch base;
-    int accidental; // e.g. sharp or flat
-    int octave;
+    int16_t value;     // MIDI number, e.g. 60 for middle C
+    int8_t accidental; // e.g. sharp or flat
 
 public:
     Pitch(BasePitch base = C, int accidental = 0, int octave = 0);
@@ -63,11 +77,17 @@ public:
     Pitch(int midiValue);
 
     BasePitch getBasePitch() const;
+    int getAccidental() const;
+    int getOctave() const;
     int toInt() const;
 
-    // If the Pitch is represented by a key in the delta map, apply the
-    // corresponding delta.
-    void transform(const map<int, int> &deltas);
+    // Apply the delta for the pitch class of the Pitch, if it has one.  The
+    // table is indexed by pitch class, so enharmonic spellings are moved
+    // alike: B# like C and Cb like B.  (Looking up the spelled name, as
+    // the map of scale degrees used to be, left B# and Cb unmoved because
+    // their names are 12 and -1.)  A chain of modulations can then be
+    // composed into one table, as TrackTransform does.
+    void transform(const PitchClassDeltas &deltas);
 
     Pitch& operator+=(int delta);
     friend Pitch operator+(const Pitch &p, int delta);
@@ -82,4 +102,49 @@ public:
     friend std::ostream& operator<<(std::ostream &os, const Pitch &p);
 };
 
+/*
+ * The arithmetic functions are inline so that loops over many Pitches
+ * (such as Track::transpose()) can be optimized.
+ */
+
+inline BasePitch Pitch::getBasePitch() const {
+    return static_cast<BasePitch>(pitchClass(value - accidental));
+}
+
+inline int Pitch::getAccidental() const {
+    return accidental;
+}
+
+inline int Pitch::getOctave() const {
+    int natural = value - accidental;
+    return (natural - pitchClass(natural)) / OCTAVE_WIDTH;
+}
+
+inline int Pitch::toInt() const {
+    return value;
+}
+
+inline void Pitch::transform(const PitchClassDeltas &deltas) {
+    int delta = deltas[pitchClass(value)];
+    if (delta != 0) {
+        *this += delta;
+    }
+}
+
+// Transposing respells the Pitch in the same way as Pitch(int).
+inline Pitch& Pitch::operator+=(int delta) {
+    value += delta;
+    accidental = spellingTable[pitchClass(value)];
+    return *this;
+}
+
+inline Pitch& Pitch::operator-=(int delta) {
+    return *this += -1 * delta;
+}
+
+inline Pitch& Pitch::operator^=(int delta) {
+    value += OCTAVE_WIDTH * delta;
+    return *this;
+}
+
 } // namespace smf
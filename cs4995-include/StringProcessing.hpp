@@ -2,6 +2,7 @@
 
 #include <string>
 #include <sstream>
+#include <stdexcept>
 #include <vector>
 #include <iostream>
 #include "Note.hpp"
@@ -22,7 +23,24 @@ vector<string> tokenizeNotestr(string str);
 // e.g. CEG or C/E/G --> { C, E, G }
 vector<Pitch> parsePitches(string s);
 
-// Parse a string representing a series of notes.
-vector<Note> parseNotes(string s);
+// Thrown by parseNotes() for an invalid note string.  The message and
+// getPosition() give the index of the offending character.
+class NoteParseError : public std::invalid_argument {
+private:
+    size_t position;
+
+public:
+    NoteParseError(const string &message, size_t position);
+
+    size_t getPosition() const;
+};
+
+// Parse a string representing a series of notes, e.g. "8( C E/G - ) .".
+// The string is validated and the Notes are built in a single scan.
+vector<Note> parseNotes(const string &s);
+
+// Parse the length characters starting at s, appending the Notes to
+// result.  If the string is invalid, result is left unchanged.
+void parseNotes(const char *s, size_t length, vector<Note> &result);
 
 } // namespace smf
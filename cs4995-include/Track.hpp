@@ -5,6 +5,7 @@
 #include "Note.hpp"
 #include "Pitch.hpp"
 #include "StringProcessing.hpp"
+#include "TrackTransform.hpp"
 
 namespace smf {
 
@@ -20,15 +21,17 @@ private:
     int octave;
     int velocity;
 
-    // Apply the given mapping to each pitch in the Track.
-    void transformPitch(const map<int, int> &deltas);
+    // Append the first count Notes of src, which may be this Track's own
+    // notes, transposed by delta.
+    void appendNotes(const vector<Note> &src, size_t count, int delta);
 
 public:
     Track(int octave = DEFAULT_OCTAVE, int velocity = DEFAULT_VELOCITY);
-    Track(string str, int octave = DEFAULT_OCTAVE,
+    Track(const string &str, int octave = DEFAULT_OCTAVE,
         int velocity = DEFAULT_VELOCITY);
 
     const vector<Note>& getNotes() const;
+
     int getVelocity() const;
     void setVelocity(int v);
     int getOctave() const;
@@ -43,13 +46,17 @@ public:
     // Stretch or compress the note lengths of the Track by the given factor.
     void resize(float factor);
 
+    // Apply a chain of transpositions, modulations and resizes to every
+    // Note in a single pass.
+    void transform(const TrackTransform &t);
+
     const Note& operator[](int index) const;
     Note& operator[](int index);
 
     // Operations for appending.
     friend Track& operator<<(Track &trk, Note c);
     friend Track& operator<<(Track &trk, const vector<Note> &c);
-    friend Track& operator<<(Track &trk, string s);
+    friend Track& operator<<(Track &trk, const string &s);
 
     // Adding Tracks appends them to each other.
     Track &operator+=(const Track &t2);
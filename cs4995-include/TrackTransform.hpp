@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Note.hpp"
+#include "Pitch.hpp"
+
+namespace smf {
+
+/*
+ * A chain of transpositions, modulations and resizes composed into a single
+ * transform, so that Track::transform() can apply them all in one pass over
+ * its notes.  Each transposition or modulation adds an
+ * interval which only depends on the pitch class, so any chain of them is
+ * a table of 12 intervals, one for each pitch class.  Resizes multiply into
+ * a single exact Duration factor.
+ */
+class TrackTransform {
+private:
+    // Interval added to the pitches of each pitch class (C = 0 to B = 11).
+    int deltas[OCTAVE_WIDTH];
+
+    // Whether the pitches of each pitch class are changed (and so are
+    // respelled in the same way as Pitch::operator+=).
+    bool changed[OCTAVE_WIDTH];
+
+    Duration scale;
+
+public:
+    TrackTransform();
+
+    // Whether the transform leaves every Note as it is.
+    bool isIdentity() const;
+
+    // Compose another operation after the transform.
+    void transpose(int delta);
+    void modulate(const PitchClassDeltas &mapping);
+    void resize(const Duration &factor);
+    void compose(const TrackTransform &next);
+
+    // Apply the transform to a Note.
+    void apply(Note &n) const;
+};
+
+} // namespace smf
@@ -0,0 +1,158 @@
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include "Duration.hpp"
+
+namespace smf {
+
+static int64_t gcd(int64_t a, int64_t b) {
+    a = a < 0 ? -a : a;
+    b = b < 0 ? -b : b;
+    while (b != 0) {
+        int64_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Store a * b in result, unless it overflows.
+static bool checkedMultiply(int64_t a, int64_t b, int64_t &result) {
+    if (a != 0 && (b > INT64_MAX / (a < 0 ? -a : a) ||
+        b < -INT64_MAX / (a < 0 ? -a : a))) {
+        return false;
+    }
+    result = a * b;
+    return true;
+}
+
+// Store a + b in result, unless it overflows.
+static bool checkedAdd(int64_t a, int64_t b, int64_t &result) {
+    if ((b > 0 && a > INT64_MAX - b) || (b < 0 && a < INT64_MIN - b)) {
+        return false;
+    }
+    result = a + b;
+    return true;
+}
+
+// Division rounding towards negative infinity.
+static int64_t floorDivide(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+Duration::Duration(int64_t numerator, int64_t denominator) {
+    if (denominator == 0) {
+        throw std::invalid_argument("Duration with a denominator of 0");
+    }
+    if (denominator < 0) {
+        numerator = -numerator;
+        denominator = -denominator;
+    }
+    int64_t g = gcd(numerator, denominator);
+    num = numerator / g;
+    den = denominator / g;
+}
+
+Duration Duration::fromFloat(double value, int64_t maxDenominator) {
+    if (!std::isfinite(value)) {
+        throw std::invalid_argument("Duration out of range");
+    }
+    double x = std::fabs(value);
+    // convergents p/q, starting from 0/1 and 1/0
+    int64_t p0 = 0, q0 = 1, p1 = 1, q1 = 0;
+    double rest = x;
+    while (true) {
+        double a = std::floor(rest);
+        if (a * q1 + q0 > maxDenominator || a * p1 + p0 > INT64_MAX / 2) {
+            break;
+        }
+        int64_t p2 = (int64_t) a * p1 + p0;
+        int64_t q2 = (int64_t) a * q1 + q0;
+        p0 = p1;
+        q0 = q1;
+        p1 = p2;
+        q1 = q2;
+        if (rest == a) {
+            break;
+        }
+        rest = 1 / (rest - a);
+    }
+    if (q1 == 0) {
+        throw std::invalid_argument("Duration out of range");
+    }
+    return Duration{value < 0 ? -p1 : p1, q1};
+}
+
+float Duration::toFloat() const {
+    return (float) ((double) num / den);
+}
+
+int64_t Duration::toTicks(int ticksPerQuarter) const {
+    int64_t ticks;
+    if (!checkedMultiply(num, 2 * (int64_t) ticksPerQuarter, ticks)) {
+        return (int64_t) std::floor((double) num / den * ticksPerQuarter + 0.5);
+    }
+    return floorDivide(ticks + den, 2 * den);
+}
+
+Duration& Duration::operator+=(const Duration &d) {
+    int64_t g = gcd(den, d.den);
+    int64_t a, b, n, m;
+    if (checkedMultiply(num, d.den / g, a) &&
+        checkedMultiply(d.num, den / g, b) &&
+        checkedAdd(a, b, n) &&
+        checkedMultiply(den / g, d.den, m)) {
+        *this = Duration{n, m};
+    } else {
+        *this = fromFloat((double) num / den + (double) d.num / d.den);
+    }
+    return *this;
+}
+
+Duration operator+(Duration a, const Duration &b) {
+    a += b;
+    return a;
+}
+
+// Common factors are cancelled first, so the result is in lowest terms.
+Duration& Duration::operator*=(const Duration &d) {
+    if (num == 0 || d.num == 0) {
+        *this = Duration{};
+        return *this;
+    }
+    int64_t g1 = gcd(num, d.den);
+    int64_t g2 = gcd(d.num, den);
+    int64_t n, m;
+    if (checkedMultiply(num / g1, d.num / g2, n) &&
+        checkedMultiply(den / g2, d.den / g1, m)) {
+        num = n;
+        den = m;
+    } else {
+        *this = fromFloat(((double) num / den) * ((double) d.num / d.den));
+    }
+    return *this;
+}
+
+Duration operator*(Duration a, const Duration &b) {
+    a *= b;
+    return a;
+}
+
+bool operator==(const Duration &a, const Duration &b) {
+    return a.num == b.num && a.den == b.den;
+}
+
+bool operator!=(const Duration &a, const Duration &b) {
+    return !(a == b);
+}
+
+std::ostream& operator<<(std::ostream &os, const Duration &d) {
+    os << d.num;
+    if (d.den != 1) {
+        os << "/" << d.den;
+    }
+    return os;
+}
+
+} // namespace smf
@@ -1,40 +1,32 @@
-#include <map>
 #include <string>
 #include <vector>
 #include "Key.hpp"
 #include <exception>
+#include <utility>
 
 namespace smf {
 
 using std::string;
 using std::vector;
-using std::map;
 
 
-template <typename KeyType, typename ValueType>
-map<KeyType, ValueType> generateMap(
-    vector<KeyType> keys, vector<ValueType> values)
-{
-    if (keys.size() != values.size()) {
-	throw std::invalid_argument("Different number of keys and values in generateMap()");
-    }
-    map<KeyType, ValueType> m;
-    for (int i = 0; i < keys.size(); i++) {
-        if (values[i] != 0) {
-            m[keys[i]] = values[i];
-        }
+void Scale::addDegree(int degree) {
+    if (count == OCTAVE_WIDTH) {
+	throw std::invalid_argument(
+	    "Scale cannot have more than 12 notes"
+	    );
     }
-    return m;
+    scaleDegrees[count++] = degree;
 }
 
 void Scale::makeAscending() {
     auto prev = scaleDegrees.begin();
-    if (prev == scaleDegrees.end()) {
+    if (count == 0) {
         return;
     }
 
     auto it = prev + 1;
-    while(it != scaleDegrees.end()) {
+    while(it != scaleDegrees.begin() + count) {
         while (*it < *prev) {
             *it += OCTAVE_WIDTH;
         }
@@ -44,7 +36,7 @@ void Scale::makeAscending() {
 
 Scale::Scale(const vector<Pitch> &pitches) {
     for (Pitch p : pitches) {
-        scaleDegrees.push_back(p.toInt() % OCTAVE_WIDTH);
+        addDegree(p.toInt() % OCTAVE_WIDTH);
     }
     makeAscending();
 }
@@ -53,39 +45,44 @@ Scale::Scale(const string &input) {
     vector<string> tokens = tokenize(input, ' ');
     for (string tok : tokens) {
         Pitch p{tok};
-        scaleDegrees.push_back(p.toInt());
+        addDegree(p.toInt());
     }
     makeAscending();
 }
 
 Scale::Scale(int key, const vector<int> &intervals) {
     for (int i : intervals) {
-        scaleDegrees.push_back(key + i);
+        addDegree(key + i);
     }
     makeAscending();
 }
 
-map<int, int> Scale::createMappingTo(const Scale &s) const {
-    if (scaleDegrees.size() != s.scaleDegrees.size()) {
+PitchClassDeltas Scale::createMappingTo(const Scale &s) const {
+    if (count != s.count) {
 	throw std::invalid_argument(
 	    "Provided scales in createMappingTo()"
 	    "have different number of notes"
 	    );
     }
-    vector<int> diffs;
-    for (int i = 0; i < scaleDegrees.size(); i++) {
-        diffs.push_back((int) s.scaleDegrees[i] - (int) scaleDegrees[i]);
-    }
-    // Need to round down scale degrees to their common denominator to be
-    // used for transformations.
-    vector<int> baseDegrees;
-    for (int deg : scaleDegrees) {
-        baseDegrees.push_back(deg % OCTAVE_WIDTH);
+    // Scale degrees are rounded down to their pitch class to be used for
+    // transformations.  A later degree of the same pitch class replaces an
+    // earlier one, unless its delta is 0.
+    PitchClassDeltas deltas{};
+    for (int i = 0; i < count; i++) {
+        int diff = s.scaleDegrees[i] - scaleDegrees[i];
+        if (diff < INT8_MIN || diff > INT8_MAX) {
+	    throw std::invalid_argument(
+		"Provided scales in createMappingTo() are too far apart"
+		);
+        }
+        if (diff != 0) {
+            deltas[pitchClass(scaleDegrees[i])] = diff;
+        }
     }
-    return generateMap(baseDegrees, diffs);
+    return deltas;
 }
 
-int Scale::size() const { return scaleDegrees.size(); };
+int Scale::size() const { return count; };
 
 const int& Scale::operator[](int index) const { return scaleDegrees[index]; }
 
@@ -107,12 +104,27 @@ Pitch Scale::getPitch(int deg) const {
     return p;
 }
 
-Note Scale::getChord(vector<int> degrees, float length) const {
-    Note c{length};
+// The pitches are collected with a single allocation and moved into the
+// Note.
+template <typename Degrees>
+static Note makeChord(const Scale &scale, const Degrees &degrees,
+    float length)
+{
+    vector<Pitch> pitches;
+    pitches.reserve(degrees.size());
     for (int deg : degrees) {
-        c << getPitch(deg);
+        pitches.push_back(scale.getPitch(deg));
     }
-    return c;
+    return Note{std::move(pitches), length};
+}
+
+Note Scale::getChord(std::initializer_list<int> degrees, float length) const
+{
+    return makeChord(*this, degrees, length);
+}
+
+Note Scale::getChord(const vector<int> &degrees, float length) const {
+    return makeChord(*this, degrees, length);
 }
 
 } // namespace smf
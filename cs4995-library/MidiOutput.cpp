@@ -1,6 +1,11 @@
 #include "MidiOutput.hpp"
+#include "MidiStreamWriter.hpp"
+#include <algorithm>
 #include <exception>
 #include <climits>
+#include <set>
+#include <string>
+#include <utility>
 
 static void assert_no_uchar_overflow(int i){
     if (i > UCHAR_MAX){
@@ -25,95 +30,292 @@ vector<uchar> getTempoMsg(int tempo) {
     return tempoMsg;
 }
 
-// writes notes from current collection of notes to midifile
-// does not assume single notes are a special case
-// does not handle incrementing actionTime
-void MidiOutput::writeNotes(
-    MidiFile& outputFile, Note note, Track trk, int trackNum, int actionTime)
+// Returns the Note with the transform applied: the Note itself if the
+// transform is the identity, or else a transformed copy in scratch.
+static const Note& applyTransform(const Note& note, const TrackTransform& t,
+    bool identity, Note& scratch)
 {
-    for (Pitch p : note.getPitches()) {
+    if (identity) {
+        return note;
+    }
+    scratch = note;
+    t.apply(scratch);
+    return scratch;
+}
 
-	// if provided int values exceed uchar maximum, 
-	//throw exception to avoid overflow
-        assert_no_uchar_overflow(p.toInt() + OCTAVE_WIDTH * trk.getOctave());
-	assert_no_uchar_overflow(trk.getVelocity());
+// Returns the number of pitches in a Track, and adds the denominators of
+// its note lengths (after the transform) to the set.  latest is raised to
+// the latest time (in quarter notes) at which a note of the Track starts
+// or ends.  Throws std::underflow_error if the velocity or a transformed
+// key number does not fit in a MIDI data byte, so that all tracks can be
+// checked before any of them are rendered.
+static int countPitches(const Track& trk, const TrackTransform& t,
+    std::set<int64_t>& denominators, double& latest)
+{
+    int pitchCount = 0;
+    int octaveOffset = OCTAVE_WIDTH * trk.getOctave();
+    int64_t lastDenominator = 0;
+    double time = 0.0;
+    bool identity = t.isIdentity();
+    Note scratch;
+    for (const Note& original : trk.getNotes()) {
+        const Note& note = applyTransform(original, t, identity, scratch);
+        const Duration& duration = note.getDuration();
+        time += (double) duration.getNumerator() / duration.getDenominator();
+        latest = std::max(latest, time);
+        int64_t denominator = duration.getDenominator();
+        if (denominator != lastDenominator) {
+            denominators.insert(denominator);
+            lastDenominator = denominator;
+        }
+        for (const Pitch& p : note.getPitches()) {
+            // if provided int values exceed uchar maximum,
+            // throw exception to avoid overflow
+            assert_no_uchar_overflow(p.toInt() + octaveOffset);
+            assert_no_uchar_overflow(trk.getVelocity());
+        }
+        pitchCount += note.getPitches().size();
+    }
+    return pitchCount;
+}
 
-	vector<uchar> midievent = {
-            NOTE_ON,
-            static_cast<uchar>(p.toInt() + OCTAVE_WIDTH * trk.getOctave()),
-            static_cast<uchar>(trk.getVelocity())
-        };
+// Returns the ticks per quarter note for rendering notes with lengths of
+// the given denominators: the least common multiple of TICKS_PER_QUARTER
+// and the denominators.  Starting with the smallest, denominators which
+// would take it over MAX_TICKS_PER_QUARTER are left out, and the notes
+// with those lengths are rounded to the nearest tick.
+static int chooseTicksPerQuarter(const std::set<int64_t>& denominators)
+{
+    int64_t tpq = TICKS_PER_QUARTER;
+    for (int64_t denominator : denominators) {
+        if (denominator > MAX_TICKS_PER_QUARTER) {
+            break;
+        }
+        int64_t a = tpq;
+        int64_t b = denominator;
+        while (b != 0) {
+            int64_t t = a % b;
+            a = b;
+            b = t;
+        }
+        int64_t lcm = tpq / a * denominator;
+        if (lcm <= MAX_TICKS_PER_QUARTER) {
+            tpq = lcm;
+        }
+    }
+    return static_cast<int>(tpq);
+}
 
-        outputFile.addEvent(trackNum + 1, actionTime, midievent);
+// Throws std::overflow_error if a note which ends at the given time (in
+// quarter notes) would be past MAX_TICK at the given resolution.
+static void checkTickRange(double latest, int tpq)
+{
+    if (latest * tpq > MAX_TICK) {
+        throw std::overflow_error("Tracks are too long to be written at " +
+            std::to_string(tpq) + " ticks per quarter note");
+    }
+}
 
-        midievent[0] = NOTE_OFF;
-        outputFile.addEvent(
-            trackNum + 1,
-            actionTime + TICKS_PER_QUARTER * note.getLength(),
-            midievent);
+// Renders one Track into track trackNum + 1 of the output file, given the
+// number of pitches from countPitches() and the ticks per quarter note.
+// The transform is applied to each note as it is read.
+// The start and end of each note are rounded from its exact time, so
+// rounding does not add up along the track and consecutive notes never
+// overlap or leave gaps.  Storage for the exact number of
+// events is reserved first.  Note-ons are emitted in time order, and
+// note-offs wait in a queue until the first note-on at or after their
+// tick, so the events come out in time order with note-offs before
+// note-ons at the same tick, as MidiFile::sortTracks() puts them, and the
+// track does not need to be sorted afterwards.
+// Chords do not need special handling, and rests only advance the time.
+// Neither the Track nor the other tracks of the file are changed, so
+// several tracks can be rendered at the same time.
+void MidiOutput::writeTrack(MidiFile& outputFile, const Track& trk,
+    const TrackTransform& t, int trackNum, int pitchCount, int tpq) const
+{
+    if (pitchCount == 0) {
+        return;
+    }
+    const vector<Note>& notes = trk.getNotes();
+    int octaveOffset = OCTAVE_WIDTH * trk.getOctave();
+    uchar velocity = static_cast<uchar>(trk.getVelocity());
+
+    MidiEventList& events = outputFile[trackNum + 1];
+    events.reserve(events.size() + 2 * pitchCount);
+
+    // note-offs which have not been written yet: (tick, key)
+    vector< std::pair<int, uchar> > offs;
+    offs.reserve(pitchCount);
+    size_t nextOff = 0;
+
+    MidiEvent event;
+    event.track = trackNum + 1;
+    event.resize(3);
+    event[2] = velocity;
+
+    // exact time of the end of the current note, and its ticks
+    Duration time;
+    int actionTime = 0;
+    bool identity = t.isIdentity();
+    Note scratch;
+    for (const Note& original : notes) {
+        const Note& note = applyTransform(original, t, identity, scratch);
+        const vector<Pitch>& pitches = note.getPitches();
+        time += note.getDuration();
+        // in range, as checked by checkTickRange()
+        int offTime = static_cast<int>(time.toTicks(tpq));
+        if (!pitches.empty()) {
+            while (nextOff < offs.size() && offs[nextOff].first <= actionTime) {
+                event.tick = offs[nextOff].first;
+                event[0] = NOTE_OFF;
+                event[1] = offs[nextOff].second;
+                events.append(event);
+                nextOff++;
+            }
+            for (const Pitch& p : pitches) {
+                uchar key = static_cast<uchar>(p.toInt() + octaveOffset);
+                event.tick = actionTime;
+                event[0] = NOTE_ON;
+                event[1] = key;
+                events.append(event);
+                offs.push_back(std::make_pair(offTime, key));
+            }
+        }
+        actionTime = offTime;
+    }
+    for (; nextOff < offs.size(); nextOff++) {
+        event.tick = offs[nextOff].first;
+        event[0] = NOTE_OFF;
+        event[1] = offs[nextOff].second;
+        events.append(event);
+    }
+
+    // Negative note lengths put events out of order.
+    if (!events.isSorted()) {
+        outputFile.sortTrack(trackNum + 1);
     }
 }
 
 MidiOutput::MidiOutput(vector<Track> tracks, int tempo) :
-    tempo(tempo), tracks(tracks) {}
+    tempo(tempo), tracks(tracks), transforms(this->tracks.size()) {}
 
 MidiOutput::MidiOutput(Track trk, int tempo) : tempo(tempo) {
-    tracks.push_back(trk);
+    addTrack(trk);
 }
 
 int MidiOutput::getTempo() { return tempo; }
 
 void MidiOutput::setTempo(int t) { tempo = t; }
 
+bool MidiOutput::isParallel() const { return parallel; }
+
+void MidiOutput::setParallel(bool p) { parallel = p; }
+
+int MidiOutput::getTicksPerQuarter() const { return ticksPerQuarter; }
+
+void MidiOutput::setTicksPerQuarter(int tpq) {
+    if (tpq < 0 || tpq > MAX_TICKS_PER_QUARTER) {
+        throw std::invalid_argument("Invalid ticks per quarter note");
+    }
+    ticksPerQuarter = tpq;
+}
+
 void MidiOutput::addTrack(Track trk) {
     tracks.push_back(trk);
+    transforms.push_back(TrackTransform{});
 }
 
+// The operations are only composed into the pending transforms here, and
+// applied to the notes when they are rendered by write() or stream().
 void MidiOutput::transpose(int delta) {
-    for (Track &trk : tracks) {
-        trk.transpose(delta);
+    for (TrackTransform &t : transforms) {
+        t.transpose(delta);
     }
 }
 
 void MidiOutput::resize(float factor) {
-    for (Track &trk : tracks) {
-        trk.resize(factor);
+    Duration scale = Duration::fromFloat(factor);
+    for (TrackTransform &t : transforms) {
+        t.resize(scale);
     }
 }
 
 void MidiOutput::modulate(const Scale &src, const Scale &dest) {
-    for (Track &trk : tracks) {
-        trk.modulate(src, dest);
+    PitchClassDeltas mapping = src.createMappingTo(dest);
+    for (TrackTransform &t : transforms) {
+        t.modulate(mapping);
+    }
+}
+
+void MidiOutput::transform(const TrackTransform &t) {
+    for (TrackTransform &pending : transforms) {
+        pending.compose(t);
     }
 }
 
-// can throw std::overflow_error from writeNotes()
-void MidiOutput::write(string filename) {
+// can throw std::underflow_error from countPitches(), or
+// std::overflow_error from checkTickRange()
+void MidiOutput::write(const string& filename) const {
     MidiFile outputFile;
     outputFile.absoluteTicks();
-    outputFile.setTicksPerQuarterNote(TICKS_PER_QUARTER);
     outputFile.addTracks(tracks.size());
 
     // Define tempo
     auto tempoMsg = getTempoMsg(tempo);
     outputFile.addEvent(0, 0, tempoMsg);
 
-    // Write tracks
-    for (int trackNum = 0; trackNum < tracks.size(); trackNum++) {
-        int actionTime = 0;
-        Track trk = tracks[trackNum];
+    // Check the tracks and count their events before rendering, so that
+    // no exceptions are thrown while rendering on other threads.  The
+    // resolution is chosen from the note lengths of all the tracks.
+    int trackCount = tracks.size();
+    vector<int> pitchCounts(trackCount);
+    std::set<int64_t> denominators;
+    double latest = 0.0;
+    int eventCount = 0;
+    for (int trackNum = 0; trackNum < trackCount; trackNum++) {
+        pitchCounts[trackNum] = countPitches(tracks[trackNum],
+            transforms[trackNum], denominators, latest);
+        eventCount += 2 * pitchCounts[trackNum];
+    }
+    int tpq = ticksPerQuarter != 0 ? ticksPerQuarter :
+        chooseTicksPerQuarter(denominators);
+    checkTickRange(latest, tpq);
+    outputFile.setTicksPerQuarterNote(tpq);
 
-        // write all notes to midifile
-        // if it's a rest, just increment actionTime
-        for (Note note : trk.getNotes()) {
-            if (!(note.isRest())) {
-                writeNotes(outputFile, note, trk, trackNum, actionTime);
-            }
-            actionTime += TICKS_PER_QUARTER * note.getLength();
+    // Write tracks (each one is already in time order).  Each Track has
+    // its own MIDI track, so the output is the same on any number of
+    // threads.
+    auto render = [&](int trackNum) {
+        writeTrack(outputFile, tracks[trackNum], transforms[trackNum],
+            trackNum, pitchCounts[trackNum], tpq);
+    };
+    if (parallel) {
+        parallelFor(trackCount, eventCount, render);
+    } else {
+        for (int trackNum = 0; trackNum < trackCount; trackNum++) {
+            render(trackNum);
         }
     }
-    outputFile.sortTracks();
     outputFile.write(filename);
 }
 
+// can throw std::underflow_error from countPitches(), or
+// std::overflow_error from checkTickRange(), before anything is written
+void MidiOutput::stream(const string& filename) const {
+    std::set<int64_t> denominators;
+    double latest = 0.0;
+    for (size_t i = 0; i < tracks.size(); i++) {
+        countPitches(tracks[i], transforms[i], denominators, latest);
+    }
+    int tpq = ticksPerQuarter != 0 ? ticksPerQuarter :
+        chooseTicksPerQuarter(denominators);
+    checkTickRange(latest, tpq);
+
+    MidiStreamWriter writer(filename, tempo, tpq);
+    for (size_t i = 0; i < tracks.size(); i++) {
+        writer.writeTrack(tracks[i], transforms[i]);
+    }
+    writer.close();
+}
+
 } // namespace smf
@@ -0,0 +1,257 @@
+#include "MidiStreamWriter.hpp"
+#include <climits>
+#include <stdexcept>
+
+namespace smf {
+
+// Events are written to the stream in blocks of about this many bytes.
+static const size_t BUFFER_SIZE = 1 << 16;
+
+// Offset of the format (followed by the track count) in the header chunk.
+static const int FORMAT_OFFSET = 8;
+
+static void putShort(std::ostream &out, int value) {
+    out.put(static_cast<char>((value >> 8) & 0xff));
+    out.put(static_cast<char>(value & 0xff));
+}
+
+static void putLong(std::ostream &out, uint32_t value) {
+    out.put(static_cast<char>((value >> 24) & 0xff));
+    out.put(static_cast<char>((value >> 16) & 0xff));
+    out.put(static_cast<char>((value >> 8) & 0xff));
+    out.put(static_cast<char>(value & 0xff));
+}
+
+// Appends a variable-length quantity (at most 0x0fffffff).
+static void putVlq(vector<uchar> &buffer, uint32_t value) {
+    uchar bytes[4];
+    int count = 0;
+    do {
+        bytes[count++] = value & 0x7f;
+        value >>= 7;
+    } while (value != 0);
+    while (count > 1) {
+        buffer.push_back(bytes[--count] | 0x80);
+    }
+    buffer.push_back(bytes[0]);
+}
+
+static void checkDataByte(int value) {
+    if (value < 0 || value > UCHAR_MAX) {
+        throw std::underflow_error(
+            "provided integer values to MidiStreamWriter exceed "
+            "8-bit maximum for midifile event format");
+    }
+}
+
+MidiStreamWriter::MidiStreamWriter(const string &filename, int tempo,
+    int ticksPerQuarter) :
+    file(filename, std::ios::binary | std::ios::trunc), out(file),
+    ticksPerQuarter(ticksPerQuarter)
+{
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open " + filename);
+    }
+    writeHeader(tempo);
+}
+
+MidiStreamWriter::MidiStreamWriter(std::ostream &out, int tempo,
+    int ticksPerQuarter) : out(out), ticksPerQuarter(ticksPerQuarter)
+{
+    writeHeader(tempo);
+}
+
+MidiStreamWriter::~MidiStreamWriter() {
+    try {
+        close();
+    } catch (...) {
+        // errors can only be reported by calling close()
+    }
+}
+
+int MidiStreamWriter::getTicksPerQuarter() const { return ticksPerQuarter; }
+
+int MidiStreamWriter::getTrackCount() const { return trackCount; }
+
+// Writes the header chunk and the tempo track.  The format and track count
+// are written by close().
+void MidiStreamWriter::writeHeader(int tempo) {
+    if (ticksPerQuarter <= 0 || ticksPerQuarter > MAX_TICKS_PER_QUARTER) {
+        throw std::invalid_argument("Invalid ticks per quarter note");
+    }
+    fileStart = out.tellp();
+    out.write("MThd", 4);
+    putLong(out, 6);
+    putShort(out, 0);
+    putShort(out, 0);
+    putShort(out, ticksPerQuarter);
+
+    beginTrack();
+    vector<uchar> tempoMsg = getTempoMsg(tempo);
+    buffer.push_back(0);
+    buffer.insert(buffer.end(), tempoMsg.begin(), tempoMsg.end());
+    endTrack();
+}
+
+void MidiStreamWriter::flushBuffer() {
+    out.write(reinterpret_cast<const char *>(buffer.data()), buffer.size());
+    buffer.clear();
+}
+
+void MidiStreamWriter::writeEvent(int64_t tick, uchar command, uchar p1,
+    uchar p2)
+{
+    int64_t delta = tick - lastTick;
+    if (delta > 0x0fffffff) {
+        throw std::overflow_error("Time between MIDI events is too long");
+    }
+    putVlq(buffer, static_cast<uint32_t>(delta));
+    buffer.push_back(command);
+    buffer.push_back(p1);
+    buffer.push_back(p2);
+    lastTick = tick;
+    if (buffer.size() >= BUFFER_SIZE) {
+        flushBuffer();
+    }
+}
+
+void MidiStreamWriter::beginTrack(int octave, int velocity) {
+    if (closed) {
+        throw std::logic_error("MidiStreamWriter is closed");
+    }
+    if (inTrack) {
+        throw std::logic_error("Track started before the last one ended");
+    }
+    checkDataByte(velocity);
+    inTrack = true;
+    chunkStart = out.tellp();
+    out.write("MTrk", 4);
+    putLong(out, 0);
+    time = Duration{};
+    actionTime = 0;
+    lastTick = 0;
+    octaveOffset = OCTAVE_WIDTH * octave;
+    this->velocity = static_cast<uchar>(velocity);
+    offCount = 0;
+}
+
+// Works like MidiOutput::writeTrack(): note-ons are written in time order,
+// and each note-off waits until the first note-on at or after its tick.
+// The note-offs wait in a heap rather than a queue, so chords of different
+// lengths come out in order.  Negative note lengths, which would need the
+// track to be sorted, are not allowed.
+void MidiStreamWriter::addNote(const Note &note) {
+    if (!inTrack) {
+        throw std::logic_error("Note added outside of a track");
+    }
+    Duration length = note.getDuration();
+    if (length.getNumerator() < 0) {
+        throw std::invalid_argument(
+            "Notes with negative lengths cannot be streamed");
+    }
+    const vector<Pitch> &pitches = note.getPitches();
+    time += length;
+    int64_t offTime = time.toTicks(ticksPerQuarter);
+    if (!pitches.empty()) {
+        for (const Pitch &p : pitches) {
+            checkDataByte(p.toInt() + octaveOffset);
+        }
+        while (!offs.empty() && std::get<0>(offs.top()) <= actionTime) {
+            writeEvent(std::get<0>(offs.top()), NOTE_OFF,
+                std::get<2>(offs.top()), velocity);
+            offs.pop();
+        }
+        for (const Pitch &p : pitches) {
+            uchar key = static_cast<uchar>(p.toInt() + octaveOffset);
+            writeEvent(actionTime, NOTE_ON, key, velocity);
+            offs.push(PendingOff{offTime, offCount++, key});
+        }
+    }
+    actionTime = offTime;
+}
+
+// Writes the remaining note-offs and the end of the track, then goes back
+// to fill in the length of the chunk.
+void MidiStreamWriter::endTrack() {
+    if (!inTrack) {
+        throw std::logic_error("Track ended before it was started");
+    }
+    while (!offs.empty()) {
+        writeEvent(std::get<0>(offs.top()), NOTE_OFF,
+            std::get<2>(offs.top()), velocity);
+        offs.pop();
+    }
+    buffer.push_back(0);
+    buffer.push_back(0xff);
+    buffer.push_back(0x2f);
+    buffer.push_back(0);
+    flushBuffer();
+
+    std::streampos end = out.tellp();
+    out.seekp(chunkStart + std::streamoff(4));
+    putLong(out, static_cast<uint32_t>(end - chunkStart - 8));
+    out.seekp(end);
+    if (!out) {
+        throw std::runtime_error("Unable to write MIDI track");
+    }
+    inTrack = false;
+    trackCount++;
+}
+
+void MidiStreamWriter::writeTrack(const Track &trk, const TrackTransform &t)
+{
+    beginTrack(trk.getOctave(), trk.getVelocity());
+    if (t.isIdentity()) {
+        for (const Note &note : trk.getNotes()) {
+            addNote(note);
+        }
+    } else {
+        // transform a copy of each note, reusing its storage
+        Note current;
+        for (const Note &note : trk.getNotes()) {
+            current = note;
+            t.apply(current);
+            addNote(current);
+        }
+    }
+    endTrack();
+}
+
+// The same Note is passed to the generator each time, so that its storage
+// can be reused.
+void MidiStreamWriter::writeTrack(const NoteSource &next, int octave,
+    int velocity)
+{
+    beginTrack(octave, velocity);
+    Note note;
+    while (next(note)) {
+        addNote(note);
+    }
+    endTrack();
+}
+
+// A file with only the tempo track is written as format 0, like
+// MidiFile::write() does.
+void MidiStreamWriter::close() {
+    if (closed) {
+        return;
+    }
+    if (inTrack) {
+        endTrack();
+    }
+    closed = true;
+    std::streampos end = out.tellp();
+    out.seekp(fileStart + std::streamoff(FORMAT_OFFSET));
+    putShort(out, trackCount == 1 ? 0 : 1);
+    putShort(out, trackCount);
+    out.seekp(end);
+    out.flush();
+    if (file.is_open()) {
+        file.close();
+    }
+    if (!out) {
+        throw std::runtime_error("Unable to write MIDI file");
+    }
+}
+
+} // namespace smf
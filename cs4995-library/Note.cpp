@@ -1,4 +1,5 @@
 #include <map>
+#include <utility>
 #include <vector>
 #include "Note.hpp"
 
@@ -7,21 +8,36 @@ namespace smf {
 using std::map;
 using std::vector;
 
-Note::Note(const vector<Pitch> &pitches, float length) :
-    pitches(pitches), length(length) {}
+Note::Note(vector<Pitch> pitches, float length) :
+    pitches(std::move(pitches)), length(Duration::fromFloat(length)) {}
 
-Note::Note(Pitch pitch, float length) : pitches(), length(length)
+Note::Note(vector<Pitch> pitches, Duration length) :
+    pitches(std::move(pitches)), length(length) {}
+
+Note::Note(Pitch pitch, float length) :
+    pitches(), length(Duration::fromFloat(length))
+{
+    pitches.push_back(pitch);
+}
+
+Note::Note(Pitch pitch, Duration length) : pitches(), length(length)
 {
     pitches.push_back(pitch);
 }
 
-Note::Note(float length) : length(length) {}
+Note::Note(float length) : length(Duration::fromFloat(length)) {}
+
+Note::Note(Duration length) : length(length) {}
+
+const vector<Pitch>& Note::getPitches() const { return pitches; }
+
+float Note::getLength() const { return length.toFloat(); }
 
-vector<Pitch> Note::getPitches() { return pitches; }
+void Note::setLength(float l) { length = Duration::fromFloat(l); }
 
-float Note::getLength() const { return length; }
+const Duration& Note::getDuration() const { return length; }
 
-void Note::setLength(float l) { length = l; }
+void Note::setDuration(const Duration &d) { length = d; }
 
 bool Note::isRest() const { return pitches.size() == 0; }
 
@@ -85,7 +101,7 @@ Note& operator<<(Note &note, vector<Pitch> v) {
     return note;
 }
 
-void Note::transform(const map<int, int> &deltas) {
+void Note::transform(const PitchClassDeltas &deltas) {
     for (Pitch &p : pitches) {
         p.transform(deltas);
     }
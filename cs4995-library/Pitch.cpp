@@ -9,19 +9,19 @@ using std::string;
 using std::vector;
 
 bool isBasePitch(char c) {
-    return charPitchMap.find(c) != charPitchMap.end();
+    return c >= 'A' && c <= 'G';
 }
 
 BasePitch toBasePitch(char c) {
-    return charPitchMap.find(c)->second;
+    return isBasePitch(c) ? letterPitchTable[c - 'A'] : C;
 }
 
 bool isAccidental(char c) {
-    return charAccidentalMap.find(c) != charAccidentalMap.end();
+    return c == '#' || c == 'b';
 }
 
 int toAccidental(char c) {
-    return charAccidentalMap.find(c)->second;
+    return c == '#' ? 1 : c == 'b' ? -1 : 0;
 }
 
 int toOctave(char c) {
@@ -59,72 +59,18 @@ int octaveFromString(string token) {
 }
 
 Pitch::Pitch(BasePitch base, int accidental, int octave) :
-    base(base), accidental(accidental), octave(octave) {}
+    value(base + accidental + OCTAVE_WIDTH * octave), accidental(accidental) {}
 
 Pitch::Pitch(string s) {
     if (s.length() == 0) {
         throw std::invalid_argument("Invalid conversion from empty string to Pitch");
     }
-    base = baseFromString(s);
     accidental = accidentalFromString(s);
-    octave = octaveFromString(s);
+    value = baseFromString(s) + accidental + OCTAVE_WIDTH * octaveFromString(s);
 }
 
-Pitch::Pitch(int midiValue) {
-    int remainder = midiValue % OCTAVE_WIDTH;
-    octave = midiValue / OCTAVE_WIDTH;
-    if(remainder < 0) {
-        remainder += OCTAVE_WIDTH;
-        octave--;
-    }
-    switch(remainder) {
-        case 0:  base = C; accidental = 0;  break;
-        case 1:  base = C; accidental = 1;  break;
-        case 2:  base = D; accidental = 0;  break;
-        case 3:  base = E; accidental = -1; break;
-        case 4:  base = E; accidental = 0;  break;
-        case 5:  base = F; accidental = 0;  break;
-        case 6:  base = F; accidental = 1;  break;
-        case 7:  base = G; accidental = 0;  break;
-        case 8:  base = A; accidental = -1; break;
-        case 9:  base = A; accidental = 0;  break;
-        case 10: base = B; accidental = -1; break;
-        case 11: base = B; accidental = 0;  break;
-        default: break;
-    }
-}
-
-BasePitch Pitch::getBasePitch() const {
-    return base;
-}
-
-int Pitch::toInt() const {
-    return base + accidental + OCTAVE_WIDTH * octave;
-}
-
-Pitch& Pitch::operator+=(int delta) {
-    Pitch result{toInt() + delta};
-    base = result.base;
-    accidental = result.accidental;
-    octave = result.octave;
-    return *this;
-}
-
-Pitch& Pitch::operator-=(int delta) {
-    return *this += -1 * delta;
-}
-
-Pitch& Pitch::operator^=(int delta) {
-    octave += delta;
-    return *this;
-}
-
-void Pitch::transform(const map<int, int> &deltas) {
-    auto val = deltas.find(base + accidental);
-    if (val != deltas.end()) {
-        *this += val->second;
-    }
-}
+Pitch::Pitch(int midiValue) :
+    value(midiValue), accidental(spellingTable[pitchClass(midiValue)]) {}
 
 Pitch operator+(const Pitch &p, int delta) {
     Pitch temp{p};
@@ -147,8 +93,9 @@ Pitch operator^(const Pitch &p, int delta) {
 }
 
 std::ostream& operator<<(std::ostream &os, const Pitch &p) {
-    os << p.base <<
-        (p.accidental == 1 ? "#" : p.accidental == -1 ? "b" : "") << p.octave;
+    os << p.getBasePitch() <<
+        (p.accidental == 1 ? "#" : p.accidental == -1 ? "b" : "") <<
+        p.getOctave();
     return os;
 }
 
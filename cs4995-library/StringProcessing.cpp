@@ -3,7 +3,6 @@
 #include <vector>
 #include <iostream>
 #include "StringProcessing.hpp"
-#include "StringValidation.hpp"
 
 using std::vector;
 using std::string;
@@ -59,46 +58,151 @@ vector<Pitch> parsePitches(string str) {
     return pitches;
 }
 
-vector<Note> parseNotes(string str) {
+NoteParseError::NoteParseError(const string &message, size_t position) :
+    std::invalid_argument("invalid note string at position " +
+        std::to_string(position) + ": " + message),
+    position(position) {}
+
+size_t NoteParseError::getPosition() const { return position; }
+
+static bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Characters which may appear somewhere in a note string.
+static bool isNoteStringChar(char c) {
+    return isDigit(c) || isBasePitch(c) || isAccidental(c) ||
+        string(" -.^_/()").find(c) != string::npos;
+}
+
+vector<Note> parseNotes(const string &str) {
     vector<Note> result;
+    parseNotes(str.data(), str.size(), result);
+    return result;
+}
+
+// Each token is lexed and turned into Notes as it is read, so no
+// substrings are made.  The grammar, with tokens separated by spaces:
+//   N(   start of a group of notes of length 1/N of a whole note
+//   )    end of the group, back to quarter notes
+//   .    a rest
+//   -    extend the previous note or rest by one note length
+//   a note or chord of one or more pitches, optionally separated by '/',
+//   each a letter A-G with an optional '#' or 'b' and an optional octave
+//   '^' or '_' followed by a digit, e.g. "CEG", "B_1/D/G" or "F#^1".  The
+//   accidental may also come after the octave, as in "F^1#".
+void parseNotes(const char *s, size_t length, vector<Note> &result) {
+    const char *p = s;
+    const char *end = s + length;
+    size_t oldSize = result.size();
 
-    validate_str_input(str);
+    auto fail = [&](const char *at, const string &message) {
+        result.erase(result.begin() + oldSize, result.end());
+        throw NoteParseError(message, at - s);
+    };
 
-    vector<string> tokens = tokenize(str, ' ');
-    if (tokens.size() == 0) {
-        return result;
+    if (p == end || !(isBasePitch(*p) || isDigit(*p))) {
+        fail(p, "input must start with digit or a note A-G");
     }
 
-    // reserve space >= the amount needed
-    result.reserve(tokens.size());
-
-    float noteLength = DEFAULT_LENGTH;
-    auto it = tokens.begin();
-    while (it < tokens.end()) {
-        string tok = *it;
-        Note note{noteLength};
-
-        if (tok[tok.length() - 1] == '(') {
-            // Start specifying note length
-            int subdivision = std::stoi(tok.substr(0, tok.length() - 1));
-            noteLength = WHOLE_LENGTH / subdivision;
-            ++it;
-        } else if (tok.compare(")") == 0) {
-            // Stop specifying note length
-            noteLength = DEFAULT_LENGTH;
-            ++it;
-        } else {
-            if (it->compare(REST) != 0) {
-                note << parsePitches(tok);
+    Duration noteLength{1};
+    const char *openParen = nullptr; // '(' of the current group
+    bool canExtend = false;          // a '-' extends the last Note
+
+    while (p < end) {
+        const char *token = p;
+        if (*p == ' ') {
+            ++p;
+            continue;
+        } else if (isDigit(*p)) {
+            int subdivision = 0;
+            while (p < end && isDigit(*p)) {
+                if (p - token == 6) {
+                    fail(token, "note subdivision is too large");
+                }
+                subdivision = subdivision * 10 + (*p++ - '0');
             }
-            while(++it < tokens.end() && it->compare(EXTEND) == 0) {
-                note.setLength(note.getLength() + noteLength);
+            if (p == end || *p != '(') {
+                fail(p, "digits must be followed by an open parenthesis");
             }
-            result.push_back(note);
+            if (openParen) {
+                fail(p, "input contains nested parentheses");
+            }
+            if (subdivision == 0) {
+                fail(token, "note subdivision must be positive");
+            }
+            openParen = p++;
+            if (p == end || *p != ' ') {
+                fail(p, "open parenthesis must be followed by a space");
+            }
+            noteLength = Duration{4, subdivision};
+            canExtend = false;
+        } else if (*p == ')') {
+            if (!openParen) {
+                fail(p, "input contains unbalanced parentheses");
+            }
+            ++p;
+            openParen = nullptr;
+            noteLength = Duration{1};
+            canExtend = false;
+        } else if (*p == '-') {
+            if (!canExtend) {
+                fail(p, "'-' must follow a note or rest");
+            }
+            ++p;
+            Note &note = result.back();
+            note.setDuration(note.getDuration() + noteLength);
+        } else if (*p == '.') {
+            ++p;
+            result.emplace_back(noteLength);
+            canExtend = true;
+        } else if (isBasePitch(*p)) {
+            result.emplace_back(noteLength);
+            Note &note = result.back();
+            while (true) {
+                BasePitch base = toBasePitch(*p++);
+                int accidental = 0;
+                int octave = 0;
+                if (p < end && isAccidental(*p)) {
+                    accidental = toAccidental(*p++);
+                }
+                if (p < end && (*p == '^' || *p == '_')) {
+                    int sign = *p++ == '^' ? 1 : -1;
+                    if (p == end || !isDigit(*p)) {
+                        fail(p, "octave must be a digit after '^' or '_'");
+                    }
+                    octave = sign * toOctave(*p++);
+                    if (accidental == 0 && p < end && isAccidental(*p)) {
+                        accidental = toAccidental(*p++);
+                    }
+                }
+                note << Pitch{base, accidental, octave};
+                if (p < end && *p == '/') {
+                    ++p;
+                    if (p == end || !isBasePitch(*p)) {
+                        fail(p, "'/' must be followed by one of A-G");
+                    }
+                } else if (p == end || !isBasePitch(*p)) {
+                    break;
+                }
+            }
+            canExtend = true;
+        } else {
+            fail(p, isNoteStringChar(*p) ?
+                string("unexpected '") + *p + "'" :
+                "input contains illegal characters");
+        }
+
+        if (p < end && *p != ' ') {
+            fail(p, isNoteStringChar(*p) ?
+                "tokens must be delimited by spaces" :
+                "input contains illegal characters");
         }
     }
 
-    return result;
+    if (openParen) {
+        fail(openParen, "unclosed parentheses");
+    }
 }
 
 } // namespace smf
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <string>
 #include "Track.hpp"
 #include <exception>
@@ -7,15 +8,9 @@ namespace smf {
 using std::string;
 using std::vector;
 
-void Track::transformPitch(const map<int, int> &deltas) {
-    for (Note &n : notes) {
-        n.transform(deltas);
-    }
-}
-
 Track::Track(int octave, int velocity) : octave(octave), velocity(velocity) {}
 
-Track::Track(string str, int octave, int velocity) :
+Track::Track(const string &str, int octave, int velocity) :
     octave(octave), velocity(velocity)
 {
     *this << str;
@@ -32,24 +27,39 @@ int Track::getOctave() const { return octave; }
 void Track::setOctave(int o) { octave = o; }
 
 void Track::transpose(int delta) {
-    for (Note &n : notes) {
-        n += delta;
-    }
+    TrackTransform t;
+    t.transpose(delta);
+    transform(t);
 }
 
 void Track::modulate(const Scale &src, const Scale &dest) {
-    transformPitch(src.createMappingTo(dest));
+    TrackTransform t;
+    t.modulate(src.createMappingTo(dest));
+    transform(t);
 }
 
 void Track::resize(float factor) {
+    TrackTransform t;
+    t.resize(Duration::fromFloat(factor));
+    transform(t);
+}
+
+void Track::transform(const TrackTransform &t) {
+    if (t.isIdentity()) {
+        return;
+    }
     for (Note &n : notes) {
-        n.setLength(n.getLength() * factor);
+        t.apply(n);
     }
 }
 
-const Note& Track::operator[](int index) const { return notes[index]; }
+const Note& Track::operator[](int index) const {
+    return notes[index];
+}
 
-Note& Track::operator[](int index) { return notes[index]; }
+Note& Track::operator[](int index) {
+    return notes[index];
+}
 
 Track& operator<<(Track &trk, Note c) {
     trk.notes.push_back(c);
@@ -62,19 +72,27 @@ Track& operator<<(Track &trk, const vector<Note> &v) {
     return trk;
 }
 
-Track& operator<<(Track &trk, string s) {
-    vector<Note> notes = parseNotes(s);
-    trk << notes;
+Track& operator<<(Track &trk, const string &s) {
+    parseNotes(s.data(), s.size(), trk.notes);
     return trk;
 }
 
+void Track::appendNotes(const vector<Note> &src, size_t count, int delta)
+{
+    // grow geometrically, so that appending many short Tracks stays linear
+    size_t size = notes.size() + count;
+    if (size > notes.capacity()) {
+        notes.reserve(std::max(size, 2 * notes.capacity()));
+    }
+    for (size_t i = 0; i < count; i++) {
+        notes.push_back(src[i]);
+        notes.back() += delta;
+    }
+}
+
 Track& Track::operator+=(const Track &t2) {
     int octaveDiff = t2.octave - this->octave;
-    Track temp{t2};
-    temp.transpose(octaveDiff * OCTAVE_WIDTH);
-    for (Note c : temp.notes) {
-        this->notes.push_back(c);
-    }
+    appendNotes(t2.notes, t2.notes.size(), octaveDiff * OCTAVE_WIDTH);
     return *this;
 }
 
@@ -85,22 +103,28 @@ Track& Track::operator*=(int factor) {
     if (factor == 0) {
         notes = vector<Note>{};
     } else {
-        Track temp = *this;
+        // reserve once; each copy is appended from the original notes
+        size_t count = notes.size();
+        notes.reserve(count * factor);
         for (int i = 0; i < factor - 1; i++) {
-            *this += temp;
+            appendNotes(notes, count, 0);
         }
     }
     return *this;
 }
 
 Track operator+(const Track &t1, const Track &t2) {
-    Track sum{t1};
+    Track sum{t1.octave, t1.velocity};
+    sum.notes.reserve(t1.notes.size() + t2.notes.size());
+    sum.notes = t1.notes;
     sum += t2;
     return sum;
 }
 
 Track operator*(const Track &t, int factor) {
-    Track multiple{t};
+    Track multiple{t.octave, t.velocity};
+    multiple.notes.reserve(t.notes.size() * std::max(factor, 1));
+    multiple.notes = t.notes;
     multiple *= factor;
     return multiple;
 }
@@ -0,0 +1,70 @@
+#include "TrackTransform.hpp"
+
+namespace smf {
+
+TrackTransform::TrackTransform() : scale(1) {
+    for (int pc = 0; pc < OCTAVE_WIDTH; pc++) {
+        deltas[pc] = 0;
+        changed[pc] = false;
+    }
+}
+
+bool TrackTransform::isIdentity() const {
+    for (int pc = 0; pc < OCTAVE_WIDTH; pc++) {
+        if (changed[pc]) {
+            return false;
+        }
+    }
+    return scale == Duration{1};
+}
+
+void TrackTransform::transpose(int delta) {
+    for (int pc = 0; pc < OCTAVE_WIDTH; pc++) {
+        deltas[pc] += delta;
+        changed[pc] = true;
+    }
+}
+
+// A pitch of class pc has been moved to pc + deltas[pc] by the earlier
+// operations, so that is the key it is looked up with.
+void TrackTransform::modulate(const PitchClassDeltas &mapping) {
+    for (int pc = 0; pc < OCTAVE_WIDTH; pc++) {
+        int delta = mapping[pitchClass(pc + deltas[pc])];
+        if (delta != 0) {
+            deltas[pc] += delta;
+            changed[pc] = true;
+        }
+    }
+}
+
+void TrackTransform::resize(const Duration &factor) {
+    scale *= factor;
+}
+
+// Like modulate(), the pitches of class pc are looked up in next by the
+// class they have been moved to.
+void TrackTransform::compose(const TrackTransform &next) {
+    for (int pc = 0; pc < OCTAVE_WIDTH; pc++) {
+        int moved = pitchClass(pc + deltas[pc]);
+        if (next.changed[moved]) {
+            deltas[pc] += next.deltas[moved];
+            changed[pc] = true;
+        }
+    }
+    scale *= next.scale;
+}
+
+void TrackTransform::apply(Note &n) const {
+    int count = n.getPitches().size();
+    for (int i = 0; i < count; i++) {
+        int pc = pitchClass(n[i].toInt());
+        if (changed[pc]) {
+            n[i] = Pitch{n[i].toInt() + deltas[pc]};
+        }
+    }
+    if (scale != Duration{1}) {
+        n.setDuration(n.getDuration() * scale);
+    }
+}
+
+} // namespace smf
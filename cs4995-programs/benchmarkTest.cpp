@@ -0,0 +1,338 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <string>
+#include "MidiOutput.hpp"
+#include "StringValidation.hpp"
+
+using namespace smf;
+
+/*
+ * Benchmarks for the cs4995 layer on a deterministic synthetic corpus:
+ * parsing note strings into Tracks (with the single-pass parser and with
+ * the earlier token-based one), and writing the Tracks with
+ * MidiOutput::write() on one thread and on several, and with
+ * MidiOutput::stream().  The different ways of doing the same job must
+ * give the same result.  Each case is run several times, and the results
+ * are printed as JSON (progress goes to stderr): the fastest and median
+ * times, ns/event, MB/s and heap allocations/event.
+ * The corpus is made with a fixed linear congruential generator, so it is
+ * the same on every platform.  See src-programs/midibench.cpp for the
+ * MidiFile benchmarks.
+ */
+
+constexpr int NUM_TRACKS = 8;
+constexpr int NUM_GROUPS = 20000;
+constexpr int REPEATS = 5;
+
+// Every heap allocation in the program is counted, so that the
+// allocations made by a benchmark case can be measured.
+static std::atomic<unsigned long long> allocationCount{0};
+
+void *operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    void *pointer = std::malloc(size == 0 ? 1 : size);
+    if (!pointer) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+struct BenchResult {
+    string name;
+    long long events;
+    long long bytes;
+    vector<long long> times;        // nanoseconds, one for each run
+    unsigned long long allocations; // in the first run
+};
+
+string generateNoteString(unsigned int seed);
+vector<Note> parseNotesByTokens(const string &str);
+bool sameNotes(const vector<Note> &a, const vector<Note> &b);
+BenchResult runCase(const string &name, long long events, long long bytes,
+    const std::function<void()> &body);
+long long fileSize(const string &filename);
+string readFile(const string &filename);
+void printJson(long long chars, long long notes,
+    const vector<BenchResult> &results);
+
+int main() {
+    vector<string> strings;
+    long long chars = 0;
+    for (int i = 0; i < NUM_TRACKS; i++) {
+        strings.push_back(generateNoteString(4995 + i));
+        chars += strings.back().size();
+    }
+
+    vector<BenchResult> results;
+    vector<Track> tracks;
+    results.push_back(runCase("parseNotes", 0, chars, [&]() {
+        tracks.clear();
+        for (const string &str : strings) {
+            tracks.push_back(Track{str});
+        }
+    }));
+    vector<vector<Note>> tokenized;
+    results.push_back(runCase("parseNotes (tokens)", 0, chars, [&]() {
+        tokenized.clear();
+        for (const string &str : strings) {
+            tokenized.push_back(parseNotesByTokens(str));
+        }
+    }));
+    for (int i = 0; i < NUM_TRACKS; i++) {
+        if (!sameNotes(tracks[i].getNotes(), tokenized[i])) {
+            std::cerr << "\tError: the parsers read different notes\n";
+            return 1;
+        }
+    }
+
+    // notes parsed, and MIDI events written (a note-on and a note-off for
+    // each pitch, and the tempo)
+    long long notes = 0;
+    long long events = 1;
+    for (const Track &trk : tracks) {
+        notes += trk.getNotes().size();
+        for (const Note &note : trk.getNotes()) {
+            events += 2 * note.getPitches().size();
+        }
+    }
+    results[0].events = notes;
+    results[1].events = notes;
+
+    MidiOutput out{tracks, 132};
+    out.write("benchmark.mid");
+    long long bytes = fileSize("benchmark.mid");
+
+    out.setParallel(false);
+    results.push_back(runCase("MidiOutput::write", events, bytes, [&]() {
+        out.write("benchmark_serial.mid");
+    }));
+    out.setParallel(true);
+    results.push_back(runCase("MidiOutput::write (parallel)", events, bytes,
+        [&]() { out.write("benchmark.mid"); }));
+    results.push_back(runCase("MidiOutput::stream", events, bytes, [&]() {
+        out.stream("benchmark_stream.mid");
+    }));
+    string written = readFile("benchmark.mid");
+    if (written != readFile("benchmark_serial.mid")) {
+        std::cerr << "\tError: serial and parallel output differ\n";
+        return 1;
+    }
+    if (written != readFile("benchmark_stream.mid")) {
+        std::cerr << "\tError: streamed output differs from write()\n";
+        return 1;
+    }
+
+    printJson(chars, notes, results);
+    return 0;
+}
+
+// Groups of notes, chords and rests of random lengths, with accidentals,
+// octave marks and extended notes.
+string generateNoteString(unsigned int seed) {
+    unsigned int state = seed;
+    auto next = [&](int range) {
+        state = state * 1103515245u + 12345u;
+        return (int) ((state >> 16) % (unsigned int) range);
+    };
+    string str;
+    str.reserve(NUM_GROUPS * 64);
+    for (int i = 0; i < NUM_GROUPS; i++) {
+        // subdivisions which keep the resolution at TICKS_PER_QUARTER, so
+        // that the piece fits in the MIDI tick range
+        static const int subdivisions[] = { 1, 2, 3, 4, 6, 8, 12, 16 };
+        str += std::to_string(subdivisions[next(8)]) + "( ";
+        for (int n = 1 + next(12); n > 0; n--) {
+            if (next(10) == 0) {
+                str += ". ";
+                continue;
+            }
+            int pitches = next(10) < 7 ? 1 : 3;
+            bool slashes = next(2) == 0;
+            for (int j = 0; j < pitches; j++) {
+                if (j > 0 && slashes) {
+                    str += '/';
+                }
+                str += (char) ('A' + next(7));
+                int c = next(10);
+                if (c == 0) {
+                    str += '#';
+                } else if (c == 1) {
+                    str += 'b';
+                }
+                // an octave digit must be followed by a slash or space
+                c = (slashes || pitches == 1) ? next(10) : 9;
+                if (c == 0) {
+                    str += "^1";
+                } else if (c == 1) {
+                    str += "_1";
+                }
+            }
+            str += ' ';
+            while (next(10) < 2) {
+                str += "- ";
+            }
+        }
+        str += ") ";
+    }
+    return str;
+}
+
+// The earlier implementation of parseNotes(), which validates the string
+// and then splits it into tokens, and each token into Pitch strings.
+vector<Note> parseNotesByTokens(const string &str) {
+    vector<Note> result;
+    validate_str_input(str);
+    vector<string> tokens = tokenize(str, ' ');
+    result.reserve(tokens.size());
+
+    float noteLength = DEFAULT_LENGTH;
+    auto it = tokens.begin();
+    while (it < tokens.end()) {
+        string tok = *it;
+        Note note{noteLength};
+        if (tok[tok.length() - 1] == '(') {
+            int subdivision = std::stoi(tok.substr(0, tok.length() - 1));
+            noteLength = WHOLE_LENGTH / subdivision;
+            ++it;
+        } else if (tok.compare(")") == 0) {
+            noteLength = DEFAULT_LENGTH;
+            ++it;
+        } else {
+            if (it->compare(REST) != 0) {
+                note << parsePitches(tok);
+            }
+            while (++it < tokens.end() && it->compare(EXTEND) == 0) {
+                note.setLength(note.getLength() + noteLength);
+            }
+            result.push_back(note);
+        }
+    }
+    return result;
+}
+
+bool sameNotes(const vector<Note> &a, const vector<Note> &b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        const vector<Pitch> &pa = a[i].getPitches();
+        const vector<Pitch> &pb = b[i].getPitches();
+        if (a[i].getLength() != b[i].getLength() || pa.size() != pb.size()) {
+            return false;
+        }
+        for (size_t j = 0; j < pa.size(); j++) {
+            if (pa[j].toInt() != pb[j].toInt() ||
+                pa[j].getAccidental() != pb[j].getAccidental()) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Runs body() REPEATS times.  Allocations are counted in the first run.
+BenchResult runCase(const string &name, long long events, long long bytes,
+    const std::function<void()> &body)
+{
+    using namespace std::chrono;
+    BenchResult result{name, events, bytes, {}, 0};
+    for (int i = 0; i < REPEATS; i++) {
+        unsigned long long allocations = allocationCount.load();
+        auto start = steady_clock::now();
+        body();
+        auto stop = steady_clock::now();
+        if (i == 0) {
+            result.allocations = allocationCount.load() - allocations;
+        }
+        result.times.push_back(
+            duration_cast<nanoseconds>(stop - start).count());
+    }
+    std::cerr << "\t" << name << ": "
+              << *std::min_element(result.times.begin(), result.times.end())
+                 / 1000000.0 << " ms\n";
+    return result;
+}
+
+long long fileSize(const string &filename) {
+    std::ifstream input(filename, std::ios::binary | std::ios::ate);
+    return input.tellg();
+}
+
+string readFile(const string &filename) {
+    std::ifstream input(filename, std::ios::binary);
+    return string(std::istreambuf_iterator<char>(input),
+        std::istreambuf_iterator<char>());
+}
+
+string number(double value) {
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%.3f", value);
+    return buffer;
+}
+
+void printJson(long long chars, long long notes,
+    const vector<BenchResult> &results)
+{
+    std::cout << "{\n";
+    std::cout << "  \"benchmark\": \"cs4995\",\n";
+    std::cout << "  \"corpus\": {\n";
+    std::cout << "    \"tracks\": " << NUM_TRACKS << ",\n";
+    std::cout << "    \"groups\": " << NUM_GROUPS << ",\n";
+    std::cout << "    \"characters\": " << chars << ",\n";
+    std::cout << "    \"notes\": " << notes << "\n";
+    std::cout << "  },\n";
+    std::cout << "  \"repeat\": " << REPEATS << ",\n";
+    std::cout << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult &result = results[i];
+        vector<long long> times = result.times;
+        std::sort(times.begin(), times.end());
+        long long fastest = times[0];
+        long long median = times[times.size() / 2];
+        std::cout << "    {\n";
+        std::cout << "      \"name\": \"" << result.name << "\",\n";
+        std::cout << "      \"events\": " << result.events << ",\n";
+        std::cout << "      \"bytes\": " << result.bytes << ",\n";
+        std::cout << "      \"ns_min\": " << fastest << ",\n";
+        std::cout << "      \"ns_median\": " << median << ",\n";
+        std::cout << "      \"ns_per_event\": "
+                  << number((double) fastest / result.events) << ",\n";
+        std::cout << "      \"mb_per_s\": "
+                  << number(fastest == 0 ? 0.0 :
+                         result.bytes * 1000.0 / fastest) << ",\n";
+        std::cout << "      \"allocations\": " << result.allocations << ",\n";
+        std::cout << "      \"allocations_per_event\": "
+                  << number((double) result.allocations / result.events)
+                  << "\n";
+        std::cout << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    std::cout << "  ]\n";
+    std::cout << "}\n";
+}
@@ -0,0 +1,116 @@
+#include <fstream>
+#include <iterator>
+#include <string>
+#include "MidiOutput.hpp"
+
+using namespace smf;
+
+/*
+ * Checks the event order of MidiOutput::write(), which renders each Track
+ * into its own MIDI track (on several threads for large files) without
+ * sorting the file afterwards.  At equal ticks the note-offs must come
+ * before the note-ons, so that a repeated key is not cut short, and each
+ * Track must stay in its own MIDI track.  A file which is large enough to
+ * be rendered on several threads must be the same as the one rendered on
+ * a single thread.
+ */
+
+// A note event read back from a MIDI file: tick, on or off, key.
+struct Event {
+    int tick;
+    bool on;
+    int key;
+};
+
+vector<Event> readTrack(const MidiFile &file, int track);
+bool checkTrack(const MidiFile &file, int track, const vector<Event> &expected);
+string readFile(const string &filename);
+
+int main() {
+    // Repeated keys, a chord followed by one of its keys, and a chord
+    // after a rest, at the same ticks in different tracks.
+    vector<Track> tracks;
+    tracks.push_back(Track{"C C"});
+    tracks.push_back(Track{"C/E C . E"});
+    tracks.push_back(Track{"E - . C/E"});
+    MidiOutput out{tracks, 120};
+    out.write("multitrack.mid");
+
+    MidiFile file;
+    file.read("multitrack.mid");
+    file.makeAbsoluteTicks();
+    if (file.getTrackCount() != 4) {
+        std::cout << "\tError: expected one MIDI track for each Track\n";
+        return 1;
+    }
+    // C is key 60 and E is key 64 in the default octave
+    bool ok = checkTrack(file, 1, {
+            { 0, true, 60 }, { 120, false, 60 },
+            { 120, true, 60 }, { 240, false, 60 } }) &&
+        checkTrack(file, 2, {
+            { 0, true, 60 }, { 0, true, 64 },
+            { 120, false, 60 }, { 120, false, 64 }, { 120, true, 60 },
+            { 240, false, 60 }, { 360, true, 64 }, { 480, false, 64 } }) &&
+        checkTrack(file, 3, {
+            { 0, true, 64 }, { 240, false, 64 },
+            { 360, true, 60 }, { 360, true, 64 },
+            { 480, false, 60 }, { 480, false, 64 } });
+    if (!ok) {
+        return 1;
+    }
+
+    // 16 tracks of 3000 chords make over 100000 events, enough to be
+    // rendered on several threads.
+    tracks.clear();
+    for (int i = 0; i < 16; i++) {
+        tracks.push_back(Track{"C/E/G D/F/A - . B_1/D/G", 2 + i % 6} * 1000);
+    }
+    MidiOutput large{tracks, 120};
+    large.setParallel(false);
+    large.write("multitrack_serial.mid");
+    large.setParallel(true);
+    large.write("multitrack.mid");
+    if (readFile("multitrack_serial.mid") != readFile("multitrack.mid")) {
+        std::cout << "\tError: serial and parallel output differ\n";
+        return 1;
+    }
+    return 0;
+}
+
+vector<Event> readTrack(const MidiFile &file, int track)
+{
+    vector<Event> events;
+    for (int i = 0; i < file[track].size(); i++) {
+        const MidiEvent &event = file[track][i];
+        if (event.isNoteOn() || event.isNoteOff()) {
+            events.push_back(Event{ event.tick, event.isNoteOn(),
+                event.getKeyNumber() });
+        }
+    }
+    return events;
+}
+
+bool checkTrack(const MidiFile &file, int track, const vector<Event> &expected)
+{
+    vector<Event> events = readTrack(file, track);
+    bool same = events.size() == expected.size();
+    for (size_t i = 0; same && i < events.size(); i++) {
+        same = events[i].tick == expected[i].tick &&
+            events[i].on == expected[i].on && events[i].key == expected[i].key;
+    }
+    if (!same) {
+        std::cout << "\tError: unexpected events in track " << track << ":";
+        for (const Event &e : events) {
+            std::cout << " " << e.tick << (e.on ? "+" : "-") << e.key;
+        }
+        std::cout << "\n";
+    }
+    return same;
+}
+
+string readFile(const string &filename)
+{
+    std::ifstream input(filename, std::ios::binary);
+    return string(std::istreambuf_iterator<char>(input),
+        std::istreambuf_iterator<char>());
+}
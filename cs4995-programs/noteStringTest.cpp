@@ -0,0 +1,111 @@
+#include <string>
+#include "MidiOutput.hpp"
+
+using namespace smf;
+
+/*
+ * Checks the single-pass note string parser: pitches with accidentals and
+ * octaves in either order, chords with and without slashes, extended
+ * notes and subdivisions, and the position reported for malformed
+ * strings, which must leave the output unchanged.
+ */
+
+// A valid note string, and the pitch values and the length (in quarter
+// notes) of each of its Notes.
+struct ValidCase {
+    string str;
+    vector<vector<int>> pitches;
+    vector<Duration> lengths;
+};
+
+// A malformed note string, and the position of the offending character.
+struct InvalidCase {
+    string str;
+    size_t position;
+};
+
+bool checkValid(const ValidCase &c);
+bool checkInvalid(const InvalidCase &c);
+
+int main() {
+    vector<ValidCase> valid = {
+        // the accidental may come before or after the octave
+        { "F#^1 F^1# Bb_1 B_1b", { { 18 }, { 18 }, { -2 }, { -2 } },
+            { Duration{1}, Duration{1}, Duration{1}, Duration{1} } },
+        { "CE/G C/E/G", { { 0, 4, 7 }, { 0, 4, 7 } },
+            { Duration{1}, Duration{1} } },
+        { "8( C - ) . -", { { 0 }, {} }, { Duration{1}, Duration{2} } },
+        { "3( C D^1# ) E", { { 0 }, { 15 }, { 4 } },
+            { Duration{4, 3}, Duration{4, 3}, Duration{1} } },
+    };
+    vector<InvalidCase> invalid = {
+        { "- C", 0 },              // must start with a note or digit
+        { "C4", 1 },               // stray digit in a note
+        { "C^", 2 },               // octave without a digit
+        { "C#^1#", 4 },            // two accidentals
+        { "C x", 2 },              // illegal character
+        { "C E ^1", 4 },           // octave without a note
+        { "4( C E/ G )", 7 },      // '/' without a following pitch
+        { "8( C D 4( E ) )", 8 },  // nested parentheses
+        { "C )", 2 },              // unbalanced parentheses
+        { "4( C", 1 },             // unclosed parentheses
+        { "0( C )", 0 },           // subdivision of 0
+        { "8( - C )", 3 },         // '-' without a note
+    };
+
+    bool ok = true;
+    for (const ValidCase &c : valid) {
+        ok = checkValid(c) && ok;
+    }
+    for (const InvalidCase &c : invalid) {
+        ok = checkInvalid(c) && ok;
+    }
+    return ok ? 0 : 1;
+}
+
+bool checkValid(const ValidCase &c) {
+    vector<Note> notes;
+    try {
+        notes = parseNotes(c.str);
+    } catch (const NoteParseError &e) {
+        std::cout << "\tError: \"" << c.str << "\": " << e.what() << "\n";
+        return false;
+    }
+    bool same = notes.size() == c.pitches.size();
+    for (size_t i = 0; same && i < notes.size(); i++) {
+        const vector<Pitch> &pitches = notes[i].getPitches();
+        same = pitches.size() == c.pitches[i].size() &&
+            notes[i].getDuration() == c.lengths[i];
+        for (size_t j = 0; same && j < pitches.size(); j++) {
+            same = pitches[j].toInt() == c.pitches[i][j];
+        }
+    }
+    if (!same) {
+        std::cout << "\tError: \"" << c.str << "\" was parsed as:";
+        for (const Note &note : notes) {
+            std::cout << " " << note.getDuration() << "{";
+            for (const Pitch &p : note.getPitches()) {
+                std::cout << " " << p.toInt();
+            }
+            std::cout << " }";
+        }
+        std::cout << "\n";
+    }
+    return same;
+}
+
+bool checkInvalid(const InvalidCase &c) {
+    // the Notes which are already in the vector must be left unchanged
+    vector<Note> notes = parseNotes("C D");
+    try {
+        parseNotes(c.str.data(), c.str.size(), notes);
+        std::cout << "\tError: \"" << c.str << "\" was accepted\n";
+        return false;
+    } catch (const NoteParseError &e) {
+        if (e.getPosition() != c.position || notes.size() != 2) {
+            std::cout << "\tError: \"" << c.str << "\": " << e.what() << "\n";
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,122 @@
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include "MidiOutput.hpp"
+#include "MidiStreamWriter.hpp"
+
+using namespace smf;
+
+/*
+ * Checks that MidiOutput::stream() writes the same bytes as
+ * MidiOutput::write(), including for empty tracks, tracks of rests and a
+ * piece with no tracks at all, and that a generator which produces no
+ * notes streams the same track as an empty Track.  The transpositions,
+ * modulations and resizes of a MidiOutput are applied while rendering, and
+ * must give the same file as the same operations applied to its Tracks.
+ * Notes with negative lengths and notes outside of a track must be
+ * rejected.
+ */
+
+string readFile(const string &filename);
+bool sameOutput(const string &name, const vector<Track> &tracks);
+bool sameStream(const string &name, const MidiOutput &out);
+bool sameTransform();
+
+int main() {
+    bool ok = sameOutput("empty", { Track{}, Track{"C D"}, Track{} });
+    Track rests;
+    rests << Note{Duration{2}} << Note{Duration{1, 3}};
+    ok = sameOutput("rests", { rests, Track{"C . E"} }) && ok;
+    ok = sameOutput("no tracks", {}) && ok;
+    ok = sameOutput("chords",
+        { Track{"C/E/G - 3( D E/G F ) .", 4, 90}, Track{"B_1 C/E/G"} }) && ok;
+    ok = sameTransform() && ok;
+
+    // a generator with no notes, and an empty Track
+    std::stringstream generated;
+    std::stringstream empty;
+    {
+        MidiStreamWriter writer(generated);
+        writer.writeTrack([](Note &) { return false; });
+        writer.close();
+        MidiStreamWriter trackWriter(empty);
+        trackWriter.writeTrack(Track{});
+        trackWriter.close();
+    }
+    if (generated.str() != empty.str()) {
+        std::cout << "\tError: empty generator and empty Track differ\n";
+        ok = false;
+    }
+
+    std::stringstream output;
+    MidiStreamWriter writer(output);
+    try {
+        writer.addNote(Note{Pitch{0}, Duration{1}});
+        std::cout << "\tError: a note was added outside of a track\n";
+        ok = false;
+    } catch (const std::logic_error &) {}
+    writer.beginTrack();
+    try {
+        writer.addNote(Note{Pitch{0}, Duration{-1}});
+        std::cout << "\tError: a note with a negative length was streamed\n";
+        ok = false;
+    } catch (const std::invalid_argument &) {}
+    return ok ? 0 : 1;
+}
+
+// Writes the tracks with write() and with stream(), and compares the files.
+bool sameOutput(const string &name, const vector<Track> &tracks) {
+    return sameStream(name, MidiOutput{tracks, 132});
+}
+
+bool sameStream(const string &name, const MidiOutput &out) {
+    out.write("stream_write.mid");
+    out.stream("stream.mid");
+    if (readFile("stream_write.mid") != readFile("stream.mid")) {
+        std::cout << "\tError: " << name
+                  << ": streamed output differs from write()\n";
+        return false;
+    }
+    return true;
+}
+
+// Transforms a MidiOutput, and the Tracks of another one, in the same way.
+// A Track added after a transposition is not transposed.
+bool sameTransform() {
+    Track melody{"C D E F G A B_1/D/F", 4};
+    Track chords{"C/E/G 3( D/F A ) ."};
+    Track bass{"C_1 G_1"};
+    MidiOutput out{{melody, chords}};
+    out.transpose(2);
+    out.addTrack(bass);
+    TrackTransform t;
+    t.modulate(Scale{C, MAJOR}.createMappingTo(Scale{A, MINOR}));
+    t.resize(Duration{1, 3});
+    out.transform(t);
+    out.resize(1.5);
+
+    for (Track *trk : { &melody, &chords }) {
+        trk->transpose(2);
+    }
+    for (Track *trk : { &melody, &chords, &bass }) {
+        trk->modulate(Scale{C, MAJOR}, Scale{A, MINOR});
+        trk->resize(0.5);
+    }
+    MidiOutput expected{{melody, chords, bass}};
+    out.write("stream_write.mid");
+    expected.write("stream.mid");
+    if (readFile("stream_write.mid") != readFile("stream.mid")) {
+        std::cout << "\tError: pending transforms differ from "
+                  << "transformed Tracks\n";
+        return false;
+    }
+    return sameStream("transformed", out);
+}
+
+string readFile(const string &filename)
+{
+    std::ifstream input(filename, std::ios::binary);
+    return string(std::istreambuf_iterator<char>(input),
+        std::istreambuf_iterator<char>());
+}
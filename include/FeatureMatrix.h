@@ -0,0 +1,130 @@
+//
+// Creation Date: Tue Oct 20 17:12:40 PDT 2026
+// Filename:      midifile/include/FeatureMatrix.h
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Convert a MIDI file into a matrix of event features, as
+//                used by mid2mat.  Each row describes one note, controller,
+//                instrument, tempo, meter or key signature event, and the
+//                rows are sorted by time.  The matrix is stored as a flat
+//                row-major array which can be written as raw little-endian
+//                numbers or as a NumPy .npy file.  Lists of files can be
+//                converted in parallel, with the matrices delivered in
+//                the order of the files.
+//
+
+#ifndef _FEATUREMATRIX_H_INCLUDED
+#define _FEATUREMATRIX_H_INCLUDED
+
+#include "MidiFile.h"
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <functional>
+
+// Number of values in each row of the matrix:
+//    column 1 = time of event
+//    column 2 = opcode (type of event)
+//    columns 3-5 = event parameters (see FeatureMatrix::Opcode)
+//    column 6 = MIDI channel
+//    column 7 = track number
+#define FEATURE_COLUMNS 7
+
+// Number of files per thread which can be converted ahead of the
+// file currently being delivered in FeatureMatrix::processFiles().
+#define FEATURE_FILES_AHEAD 4
+
+namespace smf {
+
+class FeatureMatrix {
+	public:
+		enum Opcode {
+			Note         = 1000,  // duration, key, velocity
+			Control      = 2000,  // controller number, value
+			Instrument   = 3000,  // instrument number
+			Tempo        = 4000,  // beats per minute
+			Meter        = 5000,  // numerator, denominator
+			KeySignature = 6000   // sharps/flats, mode
+		};
+
+		enum TimeUnit {
+			Ticks = 0,
+			Beats,
+			Seconds,
+			Milliseconds
+		};
+
+		enum Format {
+			Raw = 0,              // little-endian numbers only
+			Npy                   // NumPy array file
+		};
+
+		                FeatureMatrix           (void);
+		               ~FeatureMatrix           ();
+
+		void            setTimeUnit             (TimeUnit unit);
+		TimeUnit        getTimeUnit             (void) const;
+		void            setUnused               (double value);
+		double          getUnused               (void) const;
+		void            setSinglePrecision      (bool state);
+		void            excludeChannel          (int channel);
+
+		bool            load                    (const std::string& filename);
+		bool            load                    (MidiFile& midifile);
+		void            clear                   (void);
+
+		int             getRowCount             (void) const;
+		int             getColumnCount          (void) const;
+		const double*   getData                 (void) const;
+		const double*   getRow                  (int row) const;
+		double          getValue                (int row, int column) const;
+		int             getTicksPerQuarterNote  (void) const;
+		int             getTPQ                  (void) const;
+		const std::string& getFilename          (void) const;
+
+		bool            write                   (std::ostream& output,
+		                                         Format format) const;
+
+		static bool     processFiles            (const std::vector<std::string>& filenames,
+		                                         const FeatureMatrix& settings,
+		                                         const std::function<void(int,
+		                                         const FeatureMatrix&, bool)>& callback);
+		static bool     writeFiles              (const std::vector<std::string>& filenames,
+		                                         const FeatureMatrix& settings,
+		                                         std::ostream& output, Format format);
+
+	protected:
+		// m_data == the matrix, stored one row after another.
+		std::vector<double> m_data;
+
+		// m_rows == unsorted rows while loading a file.
+		std::vector<double> m_rows;
+
+		// m_order == time order of the unsorted rows.
+		std::vector<int>    m_order;
+
+		TimeUnit          m_unit     = Beats;
+		double            m_unused   = -1000.0;
+		bool              m_floatQ   = false;
+		int               m_excluded = 0;
+		int               m_tpq      = 0;
+
+		// m_filename == name of the MIDI file (without directory).
+		std::string       m_filename;
+
+	private:
+		double  getTime                 (MidiFile& midifile, int tick) const;
+		void    writeRows               (std::ostream& output, int fileindex) const;
+		static void writeNpyHeader      (std::ostream& output, long long rows,
+		                                 int columns, bool floatQ);
+};
+
+} // end of namespace smf
+
+#endif /* _FEATUREMATRIX_H_INCLUDED */
+
+
+
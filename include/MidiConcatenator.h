@@ -0,0 +1,121 @@
+//
+// Creation Date: Mon Oct 19 09:12:44 PDT 2026
+// Filename:      midifile/include/MidiConcatenator.h
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Streaming concatenation of multiple MIDI files into a
+//                single type-0 MIDI file.  Input files are read one at a
+//                time and their ticks are rescaled to a common
+//                ticks-per-quarter-note value, so only a single input
+//                file is held in memory at any time.  This requires a
+//                seekable output stream: on a stream which cannot seek
+//                (such as a pipe or std::cout) the output track is kept
+//                in memory until close(), because the size of the track
+//                has to be written before its data.
+//
+
+#ifndef _MIDICONCATENATOR_H_INCLUDED
+#define _MIDICONCATENATOR_H_INCLUDED
+
+#include "MidiFile.h"
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <fstream>
+
+namespace smf {
+
+class MidiConcatenator {
+	public:
+		                MidiConcatenator        (void);
+		                MidiConcatenator        (int tpq);
+		               ~MidiConcatenator        ();
+
+		// output configuration (must be set before the first append; the
+		// ticks per quarter note must be in the range 1 to 0x7fff):
+		void            setTicksPerQuarterNote  (int tpq);
+		void            setTPQ                  (int tpq);
+		int             getTicksPerQuarterNote  (void) const;
+		int             getTPQ                  (void) const;
+
+		// silence inserted between consecutive input files:
+		void            setGap                  (double seconds);
+		double          getGap                  (void) const;
+
+		// output stream handling:
+		bool            open                    (const std::string& filename);
+		bool            open                    (std::ostream& out);
+		bool            close                   (void);
+
+		// input handling:
+		bool            append                  (const std::string& filename);
+		bool            append                  (MidiFile& infile);
+		int             getInputCount           (void) const;
+		bool            status                  (void) const;
+
+	protected:
+		// m_out == the output stream being written to.
+		std::ostream*      m_out = NULL;
+
+		// m_file == output file stream when opened by filename.
+		std::fstream       m_file;
+
+		// m_seekable == true if the MTrk chunk length can be back-patched
+		// in the output stream.  Otherwise track data is held in m_trackdata
+		// until close() is called.
+		bool               m_seekable = false;
+
+		// m_lengthpos == position of the MTrk chunk length in the output.
+		std::streampos     m_lengthpos;
+
+		// m_trackdata == track bytes which have not been written yet.
+		std::vector<uchar> m_trackdata;
+
+		// m_trackbytes == total size of the track data (written + pending).
+		ulong              m_trackbytes = 0;
+
+		// m_headerQ == true if the MThd/MTrk headers have been written.
+		bool               m_headerQ = false;
+
+		// m_ticksPerQuarterNote == output ticks per quarter note.  A value
+		// of 0 means to use the value found in the first input file.
+		int                m_ticksPerQuarterNote = 0;
+
+		// m_gap == seconds of silence between consecutive input files.
+		double             m_gap = 0.0;
+
+		// m_inputCount == number of files appended to the output.
+		int                m_inputCount = 0;
+
+		// m_pendingTicks == delta ticks to add to the next written event.
+		long               m_pendingTicks = 0;
+
+		// m_tempo == microseconds per quarter note currently in effect
+		// at the end of the output data.
+		int                m_tempo = 500000;
+
+		// m_infile == storage for the input file currently being appended
+		// (reused for each input).
+		MidiFile           m_infile;
+
+		// m_rwstatus == false if there was a problem reading or writing.
+		bool               m_rwstatus = true;
+
+	private:
+		void       writeHeader              (void);
+		void       writeEvent               (long deltatick,
+		                                     const MidiEvent& event);
+		void       writeVLValue             (long aValue);
+		void       writeTempo               (long deltatick, int microseconds);
+		void       flush                    (void);
+};
+
+} // end of namespace smf
+
+#endif /* _MIDICONCATENATOR_H_INCLUDED */
+
+
+
@@ -18,6 +18,8 @@
 
 namespace smf {
 
+class NoteLinker;
+
 class MidiEventList {
 	public:
 		                 MidiEventList      (void);
@@ -41,9 +43,15 @@ class MidiEventList {
 		int              getEventCount      (void) const;
 		int              getSize            (void) const;
 		int              size               (void) const;
+		int              lowerBound         (int tick) const;
+		int              upperBound         (int tick) const;
+		bool             isSorted           (void) const;
+		bool             checkSorted        (void);
 		void             removeEmpties      (void);
 		int              linkNotePairs      (void);
+		int              linkNotePairs      (NoteLinker& linker);
 		int              linkEventPairs     (void);
+		int              getSustainedNoteEnds (std::vector<const MidiEvent*>& ends) const;
 		void             clearLinks         (void);
 		void             clearSequence      (void);
 		int              markSequence       (int sequence = 1);
@@ -62,6 +70,11 @@ class MidiEventList {
 	protected:
 		std::vector<MidiEvent*> list;
 
+		// m_sortedQ == true if the ticks of the events are known to be in
+		// non-decreasing order, so that lowerBound() and upperBound() can
+		// use a binary search.  Kept up to date by append() and sort().
+		bool             m_sortedQ = true;
+
 	private:
 		void             sort                (void);
 
@@ -70,7 +83,11 @@ class MidiEventList {
 };
 
 
-int eventcompare(const void* a, const void* b);
+// Ordering of events in a sorted track (see MidiEventList.cpp).
+int eventcompare       (const void* a, const void* b);
+int eventcompare       (const MidiEvent& a, const MidiEvent& b);
+int eventcompareAtTick (const MidiEvent& a, const MidiEvent& b);
+int eventrank          (const MidiEvent& event);
 
 } // end of namespace smf
 
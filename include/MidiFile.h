@@ -20,6 +20,8 @@
 #include <string>
 #include <istream>
 #include <fstream>
+#include <functional>
+#include <utility>
 
 #define TIME_STATE_DELTA       0
 #define TIME_STATE_ABSOLUTE    1
@@ -29,6 +31,9 @@
 
 namespace smf {
 
+class NoteIndex;
+class NoteLinker;
+
 class _TickTime {
 	public:
 		int    tick;
@@ -114,19 +119,35 @@ class MidiFile {
 		void             setTicksPerQuarterNote    (int ticks);
 		void             setTPQ                    (int ticks);
 
+		// tick-scaling functions:
+		void             rescaleTicks              (int newtpq);
+		void             stretch                   (double factor,
+		                                            bool preserveTime = false);
+		void             stretchTempo              (double factor);
+
 		// physical-time analysis functions:
 		void             doTimeAnalysis            (void);
 		double           getTimeInSeconds          (int aTrack, int anIndex);
+		double           getTimeInSeconds          (int aTrack, int anIndex) const;
 		double           getTimeInSeconds          (int tickvalue);
+		double           getTimeInSeconds          (int tickvalue) const;
 		double           getAbsoluteTickTime       (double starttime);
-		int              getFileDurationInTicks    (void);
-		double           getFileDurationInQuarters (void);
+		double           getAbsoluteTickTime       (double starttime) const;
+		int              getFileDurationInTicks    (void) const;
+		double           getFileDurationInQuarters (void) const;
 		double           getFileDurationInSeconds  (void);
+		double           getFileDurationInSeconds  (void) const;
+
+		// read-only (frozen) state for sharing between threads:
+		void             freeze                    (void);
+		bool             isFrozen                  (void) const;
 
 		// note-analysis functions:
 		int              linkNotePairs             (void);
+		int              linkNotePairs             (NoteLinker& linker);
 		int              linkEventPairs            (void);
 		void             clearLinks                (void);
+		const NoteIndex& getNoteIndex              (void);
 
 		// filename functions:
 		void             setFilename               (const std::string& aname);
@@ -137,10 +158,14 @@ class MidiFile {
 		                                            std::vector<uchar>& midiData);
 		MidiEvent*       addEvent                  (MidiEvent& mfevent);
 		MidiEvent*       addEvent                  (int aTrack, MidiEvent& mfevent);
+		void             addEvents_no_copy         (int aTrack,
+		                                            std::vector<MidiEvent*>& events);
 		MidiEvent&       getEvent                  (int aTrack, int anIndex);
 		const MidiEvent& getEvent                  (int aTrack, int anIndex) const;
 		int              getEventCount             (int aTrack) const;
 		int              getNumEvents              (int aTrack) const;
+		std::pair<int, int> eventsInRange          (int aTrack, int starttick,
+		                                            int endtick) const;
 		void             allocateEvents            (int track, int aSize);
 		void             erase                     (void);
 		void             clear                     (void);
@@ -279,6 +304,13 @@ class MidiFile {
 		// m_linkedEventQ == True if link analysis has been done.
 		bool m_linkedEventsQ = false;
 
+		// m_frozenQ == True if freeze() has been called (see isFrozen()).
+		bool m_frozenQ = false;
+
+		// m_noteindex == Cached index of the linked notes returned by
+		// getNoteIndex(), or NULL if it has to be built again.
+		NoteIndex* m_noteindex = NULL;
+
 	private:
 		int        extractMidiData                 (std::istream& inputfile,
 		                                            std::vector<uchar>& array,
@@ -293,10 +325,17 @@ class MidiFile {
 		static int ticksearch                      (const void* A, const void* B);
 		static int secondsearch                    (const void* A, const void* B);
 		void       buildTimeMap                    (void);
-		double     linearTickInterpolationAtSecond (double seconds);
-		double     linearSecondInterpolationAtTick (int ticktime);
+		void       clearNoteIndex                  (void);
+		void       scaleTicks                      (long long numerator,
+		                                            long long denominator);
+		double     linearTickInterpolationAtSecond (double seconds) const;
+		double     linearSecondInterpolationAtTick (int ticktime) const;
 };
 
+
+void parallelFor(int count, int workload,
+		const std::function<void(int)>& function);
+
 } // end of namespace smf
 
 std::ostream& operator<<(std::ostream& out, smf::MidiFile& aMidiFile);
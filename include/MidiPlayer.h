@@ -0,0 +1,115 @@
+//
+// Creation Date: Mon Oct 19 16:20:31 PDT 2026
+// Filename:      midifile/include/MidiPlayer.h
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Real-time playback of a MidiFile.  The time in seconds
+//                of every event is calculated in advance from the tempo
+//                map, and a timing thread waits for the absolute
+//                deadline of each event (so timing errors do not
+//                accumulate).  Events are passed through a lock-free
+//                single-producer/single-consumer queue to a second
+//                thread which sends them to a MidiSink, so slow output
+//                does not delay the timing thread.
+//
+
+#ifndef _MIDIPLAYER_H_INCLUDED
+#define _MIDIPLAYER_H_INCLUDED
+
+#include "MidiFile.h"
+#include "MidiSink.h"
+
+#include <vector>
+#include <thread>
+#include <atomic>
+
+// Number of events which can wait in the queue between the timing thread
+// and the sink thread (must be a power of two).
+#define PLAYER_QUEUE_SIZE 1024
+
+namespace smf {
+
+class MidiPlayer {
+	public:
+		                MidiPlayer             (void);
+		                MidiPlayer             (MidiFile& midifile);
+		               ~MidiPlayer             ();
+
+		// event schedule:
+		void            load                   (MidiFile& midifile);
+		void            clear                  (void);
+		int             getEventCount          (void) const;
+		double          getDuration            (void) const;
+
+		// playback:
+		void            setSink                (MidiSink* sink);
+		void            setSpeed               (double factor);
+		double          getSpeed               (void) const;
+		bool            play                   (void);
+		bool            start                  (void);
+		void            stop                   (void);
+		void            wait                   (void);
+		bool            isPlaying              (void) const;
+
+		// timing statistics for the last playback (in seconds):
+		int             getJitterCount         (void) const;
+		double          getMeanJitter          (void) const;
+		double          getMinJitter           (void) const;
+		double          getMaxJitter           (void) const;
+		double          getJitterDeviation     (void) const;
+		int             getOverrunCount        (void) const;
+
+	protected:
+		// m_schedule == events from all tracks sorted by time in seconds.
+		std::vector<MidiEvent> m_schedule;
+
+		// m_sink == where events are sent to.
+		MidiSink*       m_sink = NULL;
+
+		// m_speed == playback speed (2.0 = twice as fast).
+		double          m_speed = 1.0;
+
+		// m_queue == indexes into m_schedule of events which are due,
+		// paired with the time they were dispatched.  m_head is only
+		// written by the timing thread, and m_tail only by the sink thread.
+		struct _QueueItem {
+			int    index;
+			double seconds;
+		};
+		std::vector<_QueueItem> m_queue;
+		std::atomic<unsigned>   m_head;
+		std::atomic<unsigned>   m_tail;
+
+		// m_doneQ == true when the timing thread has queued its last event.
+		std::atomic<bool>       m_doneQ;
+
+		// m_stopQ == true when playback should be stopped early.
+		std::atomic<bool>       m_stopQ;
+
+		// m_playingQ == true until the sink thread has sent its last event.
+		std::atomic<bool>       m_playingQ;
+
+		std::thread     m_timer;
+		std::thread     m_sender;
+
+		// timing thread statistics (in nanoseconds):
+		int             m_jitterCount = 0;
+		double          m_jitterSum   = 0.0;
+		double          m_jitterSum2  = 0.0;
+		long long       m_jitterMin   = 0;
+		long long       m_jitterMax   = 0;
+		int             m_overruns    = 0;
+
+	private:
+		void            runTimer               (long long startns);
+		void            runSender              (long long startns);
+};
+
+} // end of namespace smf
+
+#endif /* _MIDIPLAYER_H_INCLUDED */
+
+
+
@@ -0,0 +1,108 @@
+//
+// Creation Date: Tue Oct 20 10:05:47 PDT 2026
+// Filename:      midifile/include/MidiRecorder.h
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Record live MIDI input into a MidiFile.  A real-time
+//                input thread passes timestamped MIDI messages to
+//                record(), which copies them into a fixed-size ring
+//                buffer without locking or allocating memory.  A
+//                background thread converts the timestamps to ticks
+//                with the tempo map of the MidiFile and adds the events
+//                to its tracks in batches.
+//
+
+#ifndef _MIDIRECORDER_H_INCLUDED
+#define _MIDIRECORDER_H_INCLUDED
+
+#include "MidiFile.h"
+
+#include <vector>
+#include <thread>
+#include <atomic>
+
+// Number of MIDI data bytes stored in each ring buffer slot.  Longer
+// messages (such as system exclusive) use several consecutive slots.
+#define RECORDER_SLOT_BYTES 5
+
+namespace smf {
+
+class MidiRecorder {
+	public:
+		                MidiRecorder            (void);
+		               ~MidiRecorder            ();
+
+		// configuration (must be set before calling start()):
+		void            setCapacity             (int slots);
+		int             getCapacity             (void) const;
+		void            setTrack                (int track);
+		int             getTrack                (void) const;
+		void            setChannelTracks        (bool state);
+
+		// recording:
+		bool            start                   (MidiFile& midifile);
+		void            stop                    (void);
+		bool            isRecording             (void) const;
+		double          getTime                 (void) const;
+
+		// called from the input thread:
+		bool            record                  (const uchar* data, int size,
+		                                         double seconds);
+		bool            record                  (const uchar* data, int size);
+		bool            record                  (const MidiMessage& message,
+		                                         double seconds);
+
+		int             getRecordedCount        (void) const;
+		int             getDroppedCount         (void) const;
+
+	protected:
+		struct _RecorderSlot {
+			double  seconds;    // time of message since start of recording
+			ushort  size;       // number of bytes in data
+			uchar   more;       // 1 if the message continues in the next slot
+			uchar   data[RECORDER_SLOT_BYTES];
+		};
+
+		struct _TempoSegment {
+			double  seconds;    // start time of segment
+			int     tick;       // start tick of segment
+			double  rate;       // ticks per second in segment
+		};
+
+		// m_slots == the ring buffer (size is a power of two).  m_head is
+		// only written by the input thread, and m_tail only by the
+		// background thread.
+		std::vector<_RecorderSlot> m_slots;
+		std::atomic<unsigned>      m_head;
+		std::atomic<unsigned>      m_tail;
+		int                        m_capacity = 65536;
+
+		// m_tempos == tempo map of the MidiFile, used to convert seconds
+		// to ticks.
+		std::vector<_TempoSegment> m_tempos;
+
+		MidiFile*         m_midifile = NULL;
+		int               m_track = 0;
+		bool              m_channelTracksQ = false;
+		std::thread       m_thread;
+		std::atomic<bool> m_stopQ;
+		std::atomic<int>  m_recorded;
+		std::atomic<int>  m_dropped;
+
+		// m_startTime == steady clock time of start() in nanoseconds.
+		long long         m_startTime = 0;
+
+	private:
+		void     run                     (void);
+		void     buildTempoMap           (void);
+		int      getTick                 (double seconds, int& segment);
+};
+
+} // end of namespace smf
+
+#endif /* _MIDIRECORDER_H_INCLUDED */
+
+
+
@@ -0,0 +1,93 @@
+//
+// Creation Date: Mon Oct 19 16:20:31 PDT 2026
+// Filename:      midifile/include/MidiSink.h
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Destinations for MIDI events sent by MidiPlayer.
+//                MidiSink is the interface, MidiStreamSink writes raw
+//                MIDI bytes to a file, FIFO or device, and
+//                MidiRecorderSink stores the events in memory.
+//
+
+#ifndef _MIDISINK_H_INCLUDED
+#define _MIDISINK_H_INCLUDED
+
+#include "MidiEvent.h"
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <fstream>
+
+namespace smf {
+
+class MidiSink {
+	public:
+		virtual       ~MidiSink         ();
+
+		// send -- Called for each event at its playback time.  seconds is
+		// the actual time of the event since the start of playback.
+		virtual void   send             (const MidiEvent& event,
+		                                 double seconds) = 0;
+
+		// flush -- Called when there are no more events waiting.
+		virtual void   flush            (void);
+};
+
+
+class MidiStreamSink : public MidiSink {
+	public:
+		               MidiStreamSink   (void);
+		               MidiStreamSink   (std::ostream& out);
+		               MidiStreamSink   (const std::string& filename);
+		              ~MidiStreamSink   ();
+
+		bool           open             (const std::string& filename);
+		void           open             (std::ostream& out);
+		void           close            (void);
+		bool           status           (void) const;
+
+		virtual void   send             (const MidiEvent& event,
+		                                 double seconds);
+		virtual void   flush            (void);
+
+	protected:
+		// m_out == the stream being written to.
+		std::ostream*  m_out = NULL;
+
+		// m_file == output file stream when opened by filename.
+		std::ofstream  m_file;
+};
+
+
+class MidiRecorderSink : public MidiSink {
+	public:
+		               MidiRecorderSink (void);
+		              ~MidiRecorderSink ();
+
+		virtual void   send             (const MidiEvent& event,
+		                                 double seconds);
+
+		void           clear            (void);
+		int            getEventCount    (void) const;
+		const MidiEvent& getEvent       (int index) const;
+		double         getScheduledTime (int index) const;
+		double         getActualTime    (int index) const;
+
+	protected:
+		// m_events == copies of the events received.  The seconds value of
+		// each event is its scheduled time.
+		std::vector<MidiEvent> m_events;
+
+		// m_times == the actual time that each event was received.
+		std::vector<double>    m_times;
+};
+
+} // end of namespace smf
+
+#endif /* _MIDISINK_H_INCLUDED */
+
+
+
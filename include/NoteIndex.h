@@ -0,0 +1,76 @@
+//
+// Creation Date: Wed Oct 21 18:05:44 PDT 2026
+// Filename:      midifile/include/NoteIndex.h
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   An interval index of the linked notes in a MidiFile,
+//                for finding the notes which are sounding at a given
+//                time or during a given time range.  The notes are
+//                stored in order of their start times, and an implicit
+//                balanced search tree over that array keeps the latest
+//                end time of each subtree, so a query takes O(log n + k)
+//                time for k notes found.  Queries can be done in ticks
+//                or in seconds.  The index is not changed after it is
+//                built, so it can be shared between threads.
+//
+
+#ifndef _NOTEINDEX_H_INCLUDED
+#define _NOTEINDEX_H_INCLUDED
+
+#include "MidiFile.h"
+
+#include <vector>
+
+namespace smf {
+
+class NoteIndex {
+	public:
+		                 NoteIndex             (void);
+		                 NoteIndex             (const MidiFile& midifile);
+		                ~NoteIndex             ();
+
+		void             build                 (const MidiFile& midifile);
+		void             clear                 (void);
+		int              getNoteCount          (void) const;
+
+		int              getNotesAtTick        (int tick,
+		                                        std::vector<const MidiEvent*>& notes) const;
+		int              getNotesInTickRange   (int starttick, int endtick,
+		                                        std::vector<const MidiEvent*>& notes) const;
+		int              getNotesAtTime        (double seconds,
+		                                        std::vector<const MidiEvent*>& notes) const;
+		int              getNotesInTimeRange   (double starttime, double endtime,
+		                                        std::vector<const MidiEvent*>& notes) const;
+
+	protected:
+		class _Note {
+			public:
+				const MidiEvent* event;    // the note-on
+				int    start;              // absolute tick of the note-on
+				int    end;                // absolute tick of the note-off
+				int    maxend;             // latest end in the subtree
+				double startsec;           // start in seconds
+				double endsec;             // end in seconds
+				double maxendsec;          // latest endsec in the subtree
+		};
+
+		// m_notes == the notes sorted by start time.  The node for the
+		// range [lo, hi) of the array is at (lo + hi) / 2, with children
+		// for [lo, mid) and [mid + 1, hi).
+		std::vector<_Note> m_notes;
+
+	private:
+		void             buildTree             (int lo, int hi);
+		void             findNotes             (int lo, int hi, double start,
+		                                        double end, bool secondsQ,
+		                                        std::vector<const MidiEvent*>& notes) const;
+};
+
+} // end of namespace smf
+
+#endif /* _NOTEINDEX_H_INCLUDED */
+
+
+
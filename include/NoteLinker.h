@@ -0,0 +1,82 @@
+//
+// Creation Date: Wed Oct 21 15:48:30 PDT 2026
+// Filename:      midifile/include/NoteLinker.h
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Link note-ons to note-offs (and on/off switch
+//                controllers) in a MidiEventList, as done by
+//                MidiEventList::linkNotePairs().  The pairing of
+//                overlapping notes on the same key can be selected:
+//                the last note-on (LIFO), the first note-on (FIFO), or
+//                the note-on with the same velocity as the note-off.
+//                The open note-ons of each channel/key are kept in a
+//                fixed-size ring buffer inside the object, so linking
+//                does no memory allocation and each event is handled in
+//                constant time.  Note-ons and note-offs which could not
+//                be paired are reported.
+//
+
+#ifndef _NOTELINKER_H_INCLUDED
+#define _NOTELINKER_H_INCLUDED
+
+#include "MidiFile.h"
+
+#include <vector>
+
+// Number of overlapping note-ons that can be waiting for a note-off on
+// one channel/key.  When there are more, the oldest is left unmatched.
+#define NOTELINKER_DEPTH 8
+
+namespace smf {
+
+class NoteLinker {
+	public:
+		enum Policy {
+			LIFO = 0,     // note-off ends the last note-on (default)
+			FIFO,         // note-off ends the first note-on
+			Velocity      // note-off ends the first note-on with the same
+			              // velocity, or else the first note-on
+		};
+
+		                 NoteLinker             (void);
+		                 NoteLinker             (Policy policy);
+		                ~NoteLinker             ();
+
+		void             setPolicy              (Policy policy);
+		Policy           getPolicy              (void) const;
+
+		int              link                   (MidiEventList& events);
+		int              link                   (MidiFile& midifile);
+
+		int              getUnmatchedCount      (void) const;
+		const std::vector<MidiEvent*>& getUnmatchedNoteOns  (void) const;
+		const std::vector<MidiEvent*>& getUnmatchedNoteOffs (void) const;
+
+	protected:
+		Policy           m_policy = LIFO;
+
+		// m_slots == ring buffers of open note-on indexes for each
+		// channel/key (channel * 128 + key), oldest first from m_head.
+		int              m_slots[16 * 128][NOTELINKER_DEPTH];
+		uchar            m_head[16 * 128];
+		uchar            m_count[16 * 128];
+
+		// m_unmatchedOns/m_unmatchedOffs == notes which were not paired
+		// by the last call to link().
+		std::vector<MidiEvent*> m_unmatchedOns;
+		std::vector<MidiEvent*> m_unmatchedOffs;
+
+	private:
+		int              linkTrack              (MidiEventList& events);
+		int              popNoteOn              (int slot, MidiEventList& events,
+		                                         int velocity);
+};
+
+} // end of namespace smf
+
+#endif /* _NOTELINKER_H_INCLUDED */
+
+
+
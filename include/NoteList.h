@@ -0,0 +1,137 @@
+//
+// Creation Date: Tue Oct 20 14:31:08 PDT 2026
+// Filename:      midifile/include/NoteList.h
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Convert between MidiFiles and text notelists.  Two
+//                formats are handled: the "note start duration key
+//                velocity" lines (times in seconds) read by text2midi and
+//                written by midi2text, and the "Note on off key" lines
+//                (integer times in thousandths of a time unit) written by
+//                midi2notes.  Input files are memory mapped and parsed in
+//                place without iostreams, and the notes are collected
+//                into preallocated arrays which are sorted and merged
+//                once before being added to the MidiFile.  Output is
+//                formatted into a memory buffer which is written in
+//                large blocks.
+//
+
+#ifndef _NOTELIST_H_INCLUDED
+#define _NOTELIST_H_INCLUDED
+
+#include "MidiFile.h"
+
+#include <vector>
+#include <string>
+#include <ostream>
+
+// Size of the output buffer which is filled before writing to the stream.
+#define NOTELIST_BUFFER_SIZE 65536
+
+namespace smf {
+
+class NoteList {
+	public:
+		enum Format {
+			Text = 0,       // note  start-sec  duration-sec  key  velocity
+			Notes           // Note  on-time    off-time      key  [CH_n]
+		};
+
+		enum TimeUnit {
+			Ticks = 0,
+			Beats,
+			Seconds,
+			Milliseconds
+		};
+
+		                NoteList                (void);
+		               ~NoteList                ();
+
+		void            setFormat               (Format format);
+		Format          getFormat               (void) const;
+		void            setTimeUnit             (TimeUnit unit);
+		TimeUnit        getTimeUnit             (void) const;
+		void            setTempo                (double tempo);
+		double          getTempo                (void) const;
+
+		// reading options:
+		void            setTicksPerQuarterNote  (int tpq);
+		void            setTPQ                  (int tpq);
+		void            setTrack                (int track);
+		void            setChannel              (int channel);
+		void            setVelocity             (int velocity);
+
+		// writing options:
+		void            excludeChannel          (int channel);
+		void            setChannelColumn        (bool state);
+
+		bool            read                    (const std::string& filename,
+		                                         MidiFile& midifile);
+		bool            read                    (const char* data, size_t size,
+		                                         MidiFile& midifile);
+		bool            write                   (const std::string& filename,
+		                                         MidiFile& midifile);
+		bool            write                   (std::ostream& output,
+		                                         MidiFile& midifile);
+
+		int             getLineCount            (void) const;
+		int             getNoteCount            (void) const;
+		const std::vector<int>& getErrorLines   (void) const;
+
+		static double   parseDouble             (const char*& ptr,
+		                                         const char* end);
+		static int      parseInteger            (const char*& ptr,
+		                                         const char* end);
+		static char*    writeDouble             (char* output, double value);
+		static char*    writeInteger            (char* output, int value);
+
+	protected:
+		struct _NoteEvent {
+			int    tick;
+			uchar  command;
+			uchar  key;
+			uchar  velocity;
+		};
+
+		// m_ons/m_offs == note-ons and note-offs (including note-ons with
+		// zero velocity) in the order that they were read.
+		std::vector<_NoteEvent> m_ons;
+		std::vector<_NoteEvent> m_offs;
+
+		// m_errors == line numbers of notes which could not be parsed.
+		std::vector<int>  m_errors;
+
+		Format            m_format       = Text;
+		TimeUnit          m_unit         = Seconds;
+		double            m_tempo        = 120.0;
+		int               m_tpq          = 480;
+		int               m_track        = 0;
+		int               m_channel      = 0;
+		int               m_velocity     = 64;
+		int               m_excluded     = 0;
+		bool              m_channelQ     = false;
+		int               m_lineCount    = 0;
+		int               m_noteCount    = 0;
+
+	private:
+		void    parse                   (const char* data, size_t size);
+		int     parseLine               (const char* ptr, const char* end,
+		                                 double& on, double& off, int& key,
+		                                 int& velocity, int& channel);
+		void    addEvents               (MidiFile& midifile);
+		double  getTime                 (int tick, double tempo, int tpq) const;
+		void    makeEvents              (const std::vector<_NoteEvent>& notes,
+		                                 std::vector<MidiEvent*>& events);
+
+		static bool readFile            (const std::string& filename,
+		                                 std::string& contents);
+};
+
+} // end of namespace smf
+
+#endif /* _NOTELIST_H_INCLUDED */
+
+
+
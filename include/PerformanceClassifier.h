@@ -0,0 +1,113 @@
+//
+// Creation Date: Mon Oct 19 15:02:18 PDT 2026
+// Filename:      midifile/include/PerformanceClassifier.h
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Determine if a MIDI file is a live performance or if it
+//                was entered in step-time (quantized), based on a
+//                histogram of the inter-onset intervals (IOIs) between
+//                successive note-ons in the file.  Standard MIDI files
+//                are scanned directly without creating MidiEvents, and
+//                lists of files can be classified in parallel.
+//
+
+#ifndef _PERFORMANCECLASSIFIER_H_INCLUDED
+#define _PERFORMANCECLASSIFIER_H_INCLUDED
+
+#include "MidiFile.h"
+
+#include <vector>
+#include <string>
+#include <istream>
+
+// Number of IOI values (in ticks) counted individually in the histogram.
+// Longer IOIs are counted together in an overflow bin.
+#define PERFORMANCE_HISTOGRAM_SIZE 1024
+
+namespace smf {
+
+class PerformanceClassifier {
+	public:
+		enum Type {
+			Unknown = 0,
+			Empty,
+			Quantized,
+			Performance
+		};
+
+		// Result == classification of one file in classifyFiles().
+		struct Result {
+			Type   type;
+			double confidence;
+			int    noteCount;
+			bool   status;
+		};
+
+		                PerformanceClassifier   (void);
+		               ~PerformanceClassifier   ();
+
+		// IOIs of this length (in ticks) or longer are ignored:
+		void            setCutoff               (int ticks);
+		int             getCutoff               (void) const;
+
+		bool            classify                (const std::string& filename);
+		bool            classify                (std::istream& input);
+		bool            classify                (const MidiFile& midifile);
+		bool            classify                (const uchar* data, size_t size);
+		void            clear                   (void);
+
+		Type            getType                 (void) const;
+		const char*     getTypeName             (void) const;
+		double          getConfidence           (void) const;
+		int             getNoteCount            (void) const;
+		int             getIoiCount             (int ticks) const;
+		int             getOverflowCount        (void) const;
+
+		static const char* getTypeName          (Type type);
+		static void     classifyFiles           (const std::vector<std::string>& filenames,
+		                                         std::vector<Result>& results,
+		                                         int cutoff = 1000000);
+
+	protected:
+		// m_histogram == number of IOIs of each length (in ticks) below
+		// PERFORMANCE_HISTOGRAM_SIZE.
+		std::vector<int>  m_histogram;
+
+		// m_overflow == number of IOIs from PERFORMANCE_HISTOGRAM_SIZE up
+		// to the cutoff.
+		int               m_overflow = 0;
+
+		// m_longIois/m_longCounts == the smallest distinct IOIs which did
+		// not fit in the histogram, and their counts (only needed when the
+		// histogram contains only a few distinct IOIs).
+		std::vector<int>  m_longIois;
+		std::vector<int>  m_longCounts;
+
+		// m_ticks == absolute tick times of the note-ons in each track,
+		// stored one track after another.
+		std::vector<int>  m_ticks;
+
+		// m_trackStarts == index into m_ticks for the start of each track.
+		std::vector<int>  m_trackStarts;
+
+		int               m_cutoff     = 1000000;
+		int               m_noteCount  = 0;
+		Type              m_type       = Unknown;
+		double            m_confidence = 0.0;
+
+	private:
+		void    startTrack              (void);
+		void    analyze                 (void);
+		void    addIoi                  (int ticks);
+		int     getDistinctIois         (std::vector<int>& iois,
+		                                 std::vector<int>& counts, int max);
+};
+
+} // end of namespace smf
+
+#endif /* _PERFORMANCECLASSIFIER_H_INCLUDED */
+
+
+
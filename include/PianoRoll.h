@@ -0,0 +1,116 @@
+//
+// Creation Date: Mon Oct 19 13:40:02 PDT 2026
+// Filename:      midifile/include/PianoRoll.h
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Piano-roll rendering of a MidiFile.  Note geometry is
+//                extracted from linked note-on/note-off pairs for each
+//                track (in parallel for large files), and can be written
+//                as an SVG image or as a PGM/PPM raster image for
+//                thumbnails.  Dense files can be simplified by merging
+//                nearby notes in each pitch row (level of detail).
+//
+
+#ifndef _PIANOROLL_H_INCLUDED
+#define _PIANOROLL_H_INCLUDED
+
+#include "MidiFile.h"
+
+#include <vector>
+#include <string>
+#include <ostream>
+
+namespace smf {
+
+class PianoRollNote {
+	public:
+		double start;     // start time of note in seconds
+		double duration;  // duration of note in seconds
+		int    key;       // MIDI key number
+		int    velocity;  // attack velocity of note
+		int    channel;   // MIDI channel (0-offset)
+		int    track;     // track of note in MIDI file
+};
+
+
+class PianoRoll {
+	public:
+		                   PianoRoll        (void);
+		                   PianoRoll        (MidiFile& midifile);
+		                  ~PianoRoll        ();
+
+		// rendering options:
+		void               setScale         (double scale);
+		void               setAspectRatio   (double ratio);
+		void               setBorder        (double border);
+		void               setDrums         (bool state);
+		void               setSustain       (bool state);
+		void               setLevelOfDetail (double pixels);
+		double             getLevelOfDetail (void) const;
+
+		// note table:
+		int                load             (MidiFile& midifile);
+		void               clear            (void);
+		int                getTrackCount    (void) const;
+		int                getNoteCount     (void) const;
+		const std::vector<PianoRollNote>& getTrackNotes (int track) const;
+		int                getMinPitch      (void) const;
+		int                getMaxPitch      (void) const;
+		double             getDuration      (void) const;
+		double             getTrackHue      (int track) const;
+
+		// output:
+		bool               writeSvg         (std::ostream& out);
+		bool               writePgm         (std::ostream& out, int width,
+		                                     int height);
+		bool               writePpm         (std::ostream& out, int width,
+		                                     int height);
+
+		static char*       writeNumber      (char* buffer, double value,
+		                                     int decimals = 3);
+		static void        mergeNotes       (std::vector<PianoRollNote>& spans,
+		                                     const std::vector<PianoRollNote>& notes,
+		                                     double gap);
+		static void        writeSvgPath     (std::string& output,
+		                                     const std::vector<PianoRollNote>& spans);
+
+	protected:
+		// m_notes == list of notes for each track, sorted by start time.
+		std::vector<std::vector<PianoRollNote>> m_notes;
+
+		// m_hues == the color hue for each track (-1 if no notes in track).
+		std::vector<double> m_hues;
+
+		int    m_noteCount   = 0;
+		int    m_minPitch    = -1;
+		int    m_maxPitch    = -1;
+		double m_duration    = 0.0;
+
+		double m_scale       = 1.0;
+		double m_aspectRatio = 2.5;
+		double m_border      = 1.0;
+		bool   m_drumQ       = false;
+
+		// m_sustainQ == extend note durations while the sustain pedal is down.
+		bool   m_sustainQ    = false;
+
+		// m_detail == notes in a pitch row which are closer together than
+		// this many pixels are merged into a single span, and each track
+		// is drawn as a single SVG path (0 = draw each note separately).
+		double m_detail      = 0.0;
+
+	private:
+		void   writeSvgTrack    (std::string& output, int track);
+		bool   writeRaster      (std::ostream& out, int width, int height,
+		                         bool colorQ);
+		static void hueToRgb    (double hue, uchar* rgb);
+};
+
+} // end of namespace smf
+
+#endif /* _PIANOROLL_H_INCLUDED */
+
+
+
@@ -0,0 +1,100 @@
+//
+// Creation Date: Wed Oct 21 09:26:15 PDT 2026
+// Filename:      midifile/include/TrackMerger.h
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Iterate over the events of all tracks in a MidiFile in
+//                the order that joinTracks() would place them, without
+//                modifying the MidiFile.  A cursor is kept for each
+//                track, and a tournament tree of the cursors selects the
+//                next event, so each step takes O(log tracks) time.  The
+//                MidiFile may be in delta or absolute tick mode, and is
+//                only accessed through const functions, so several
+//                TrackMergers can read the same file concurrently.
+//
+
+#ifndef _TRACKMERGER_H_INCLUDED
+#define _TRACKMERGER_H_INCLUDED
+
+#include "MidiFile.h"
+
+#include <vector>
+
+// Number of tracks which can be merged without allocating memory.
+#define TRACKMERGER_TRACKS 64
+
+namespace smf {
+
+class TrackMerger {
+	public:
+		                 TrackMerger        (void);
+		                 TrackMerger        (const MidiFile& midifile);
+		                ~TrackMerger        ();
+
+		void             setFile            (const MidiFile& midifile);
+		void             reset              (void);
+		bool             next               (void);
+
+		int              getTrack           (void) const;
+		int              getIndex           (void) const;
+		int              getTick            (void) const;
+		int              getPosition        (void) const;
+		const MidiEvent& getEvent           (void) const;
+
+	protected:
+		// m_file == the MidiFile being iterated over.
+		const MidiFile*  m_file = NULL;
+
+		// m_trackCount == number of tracks in m_file.
+		int              m_trackCount = 0;
+
+		// m_leaves == number of leaves in the tournament tree (a power of
+		// two which is at least 2 and at least m_trackCount).
+		int              m_leaves = 2;
+
+		// m_deltaQ == true if m_file is in delta tick mode.
+		bool             m_deltaQ = false;
+
+		// m_current == track of the current event (-1 before the first
+		// call to next() and after the last event).
+		int              m_current = -1;
+
+		// m_position == index of the current event in the merged order.
+		int              m_position = -1;
+
+		// m_index == cursor (event index) for each track.
+		int*             m_index;
+
+		// m_tick == absolute tick of the event at each cursor.
+		int*             m_tick;
+
+		// m_tree == track of the earliest event below each internal node
+		// of the tournament tree (node 1 is the root, and the children
+		// of node n are 2n and 2n+1), or -1 if all tracks below the node
+		// have ended.
+		int*             m_tree;
+
+		// Storage for m_index, m_tick and m_tree.  The vectors are only
+		// used for files with more than TRACKMERGER_TRACKS tracks.
+		int              m_indexBuffer[TRACKMERGER_TRACKS];
+		int              m_tickBuffer[TRACKMERGER_TRACKS];
+		int              m_treeBuffer[TRACKMERGER_TRACKS];
+		std::vector<int> m_storage;
+
+	private:
+		int              getLeaf            (int leaf) const;
+		int              getWinner          (int node) const;
+		bool             isBefore           (int track1, int track2) const;
+
+		                 TrackMerger        (const TrackMerger& other) = delete;
+		TrackMerger&     operator=          (const TrackMerger& other) = delete;
+};
+
+} // end of namespace smf
+
+#endif /* _TRACKMERGER_H_INCLUDED */
+
+
+
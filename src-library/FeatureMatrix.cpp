@@ -0,0 +1,604 @@
+//
+// Creation Date: Tue Oct 20 17:12:40 PDT 2026
+// Filename:      midifile/src-library/FeatureMatrix.cpp
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Convert a MIDI file into a matrix of event features, as
+//                used by mid2mat.  Each row describes one note, controller,
+//                instrument, tempo, meter or key signature event, and the
+//                rows are sorted by time.  The matrix is stored as a flat
+//                row-major array which can be written as raw little-endian
+//                numbers or as a NumPy .npy file.  Lists of files can be
+//                converted in parallel, with the matrices delivered in
+//                the order of the files.
+//
+
+#include "FeatureMatrix.h"
+
+#include <string.h>
+#include <math.h>
+#include <iostream>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+
+namespace smf {
+
+// Size of the NumPy header (including the magic string), which is the
+// same for all matrix sizes so that it can be rewritten in place.
+#define NPY_HEADER_SIZE 128
+
+//////////////////////////////
+//
+// FeatureMatrix::FeatureMatrix -- Constructor.
+//
+
+FeatureMatrix::FeatureMatrix(void) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// FeatureMatrix::~FeatureMatrix -- Deconstructor.
+//
+
+FeatureMatrix::~FeatureMatrix() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// FeatureMatrix::setTimeUnit -- Set the unit of the times in the first
+//     column (and of note durations).  Default value is
+//     FeatureMatrix::Beats.
+//
+
+void FeatureMatrix::setTimeUnit(FeatureMatrix::TimeUnit unit) {
+	m_unit = unit;
+}
+
+
+
+//////////////////////////////
+//
+// FeatureMatrix::getTimeUnit -- Return the unit of the times in the
+//     matrix.
+//
+
+FeatureMatrix::TimeUnit FeatureMatrix::getTimeUnit(void) const {
+	return m_unit;
+}
+
+
+
+//////////////////////////////
+//
+// FeatureMatrix::setUnused -- Set the value stored in columns which are
+//     not used by an event.  Default value is -1000.0.
+//
+
+void FeatureMatrix::setUnused(double value) {
+	m_unused = value;
+}
+
+
+
+//////////////////////////////
+//
+// FeatureMatrix::getUnused -- Return the value of unused columns.
+//
+
+double FeatureMatrix::getUnused(void) const {
+	return m_unused;
+}
+
+
+
+//////////////////////////////
+//
+// FeatureMatrix::setSinglePrecision -- Write 32-bit floats instead of
+//     64-bit doubles.
+//
+
+void FeatureMatrix::setSinglePrecision(bool state) {
+	m_floatQ = state;
+}
+
+
+
+//////////////////////////////
+//
+// FeatureMatrix::excludeChannel -- Ignore channel messages on the given
+//     MIDI channel (offset from 0).
+//
+
+void FeatureMatrix::excludeChannel(int channel) {
+	if ((channel >= 0) && (channel < 16)) {
+		m_excluded |= 1 << channel;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// FeatureMatrix::load -- Fill the matrix with the events of a MIDI file.
+//     The MidiFile is converted to absolute ticks with joined tracks.
+//     Note rows are added at their note-offs, using the last note-on time
+//     and velocity of the same key number (-1 if there was none).  The
+//     rows are then sorted by time (keeping the order of rows at the same
+//     time).  Returns false if the file could not be read.
+//
+
+bool FeatureMatrix::load(const std::string& filename) {
+	MidiFile midifile;
+	if (!midifile.read(filename)) {
+		clear();
+		return false;
+	}
+	return load(midifile);
+}
+
+
+bool FeatureMatrix::load(MidiFile& midifile) {
+	clear();
+	midifile.absoluteTicks();
+	midifile.joinTracks();
+	m_tpq = midifile.getTicksPerQuarterNote();
+	m_filename = midifile.getFilename();
+
+	double ontimes[128];
+	int velocities[128];
+	std::fill(ontimes, ontimes + 128, -1.0);
+	std::fill(velocities, velocities + 128, -1);
+
+	MidiEventList& events = midifile[0];
+	m_rows.reserve((size_t)events.size() * FEATURE_COLUMNS);
+	double row[FEATURE_COLUMNS];
+
+	for (int i=0; i<events.size(); i++) {
+		MidiEvent& event = events[i];
+		int size = (int)event.size();
+		if (size == 0) {
+			continue;
+		}
+		int command = event[0] & 0xf0;
+		if (command == 0xf0) {
+			command = event[0];
+		} else if (m_excluded & (1 << (event[0] & 0x0f))) {
+			continue;
+		}
+		std::fill(row, row + FEATURE_COLUMNS, m_unused);
+
+		if ((command == 0x90) && (size >= 3) && (event[2] != 0)) {
+			// store note-on velocity and time
+			ontimes[event[1] & 0x7f] = getTime(midifile, event.tick);
+			velocities[event[1] & 0x7f] = event[2];
+			continue;
+		} else if (((command == 0x90) || (command == 0x80)) && (size >= 3)) {
+			int key = event[1] & 0x7f;
+			row[0] = ontimes[key];
+			row[1] = Note;
+			row[2] = getTime(midifile, event.tick) - ontimes[key];
+			row[3] = key;
+			row[4] = velocities[key];
+			row[5] = event[0] & 0x0f;
+			row[6] = event.track;
+		} else if ((command == 0xb0) && (size >= 3)) {
+			row[0] = getTime(midifile, event.tick);
+			row[1] = Control;
+			row[2] = event[1];
+			row[3] = event[2];
+			row[5] = event[0] & 0x0f;
+			row[6] = event.track;
+		} else if ((command == 0xc0) && (size >= 2)) {
+			row[0] = getTime(midifile, event.tick);
+			row[1] = Instrument;
+			row[2] = event[1];
+			row[5] = event[0] & 0x0f;
+			row[6] = event.track;
+		} else if ((command == 0xff) && (size >= 2) && (event[1] == 0x51)) {
+			row[0] = getTime(midifile, event.tick);
+			row[1] = Tempo;
+			row[2] = event.getTempoBPM();
+		} else if ((command == 0xff) && (size >= 4) && (event[1] == 0x58)) {
+			// 58 04 nn dd cc bb
+			row[0] = getTime(midifile, event.tick);
+			row[1] = Meter;
+			row[2] = event[2];
+			row[3] = pow(2.0, event[3]);
+		} else if ((command == 0xff) && (size >= 4) && (event[1] == 0x59)) {
+			// 59 02 sf mi
+			row[0] = getTime(midifile, event.tick);
+			row[1] = KeySignature;
+			row[2] = event[2];
+			row[3] = event[3];
+		} else {
+			continue;
+		}
+		m_rows.insert(m_rows.end(), row, row + FEATURE_COLUMNS);
+	}
+
+	// Note rows are out of order, since they are stored at their note-offs:
+	int rowcount = (int)(m_rows.size() / FEATURE_COLUMNS);
+	m_order.resize(rowcount);
+	for (int i=0; i<rowcount; i++) {
+		m_order[i] = i;
+	}
+	const double* rows = m_rows.data();
+	auto timeless = [rows](int a, int b) {
+		return rows[a * FEATURE_COLUMNS] < rows[b * FEATURE_COLUMNS];
+	};
+	if (!std::is_sorted(m_order.begin(), m_order.end(), timeless)) {
+		std::stable_sort(m_order.begin(), m_order.end(), timeless);
+	}
+	m_data.resize(m_rows.size());
+	double* output = m_data.data();
+	for (int i=0; i<rowcount; i++) {
+		const double* input = rows + (size_t)m_order[i] * FEATURE_COLUMNS;
+		output = std::copy(input, input + FEATURE_COLUMNS, output);
+	}
+	m_rows.clear();
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// FeatureMatrix::clear -- Remove all rows from the matrix (keeping the
+//     allocated storage for the next file).
+//
+
+void FeatureMatrix::clear(void) {
+	m_data.clear();
+	m_rows.clear();
+	m_order.clear();
+	m_tpq = 0;
+	m_filename.clear();
+}
+
+
+
+//////////////////////////////
+//
+// FeatureMatrix::getRowCount -- Return the number of events in the matrix.
+//
+
+int FeatureMatrix::getRowCount(void) const {
+	return (int)(m_data.size() / FEATURE_COLUMNS);
+}
+
+
+
+//////////////////////////////
+//
+// FeatureMatrix::getColumnCount -- Return the number of values in each
+//     row.
+//
+
+int FeatureMatrix::getColumnCount(void) const {
+	return FEATURE_COLUMNS;
+}
+
+
+
+//////////////////////////////
+//
+// FeatureMatrix::getData -- Return the matrix values, stored one row
+//     after another.
+//
+
+const double* FeatureMatrix::getData(void) const {
+	return m_data.data();
+}
+
+
+
+//////////////////////////////
+//
+// FeatureMatrix::getRow -- Return the values of one row.
+//
+
+const double* FeatureMatrix::getRow(int row) const {
+	return m_data.data() + (size_t)row * FEATURE_COLUMNS;
+}
+
+
+
+//////////////////////////////
+//
+// FeatureMatrix::getValue -- Return the value at the given row and
+//     column (both offset from 0).
+//
+
+double FeatureMatrix::getValue(int row, int column) const {
+	return m_data[(size_t)row * FEATURE_COLUMNS + column];
+}
+
+
+
+//////////////////////////////
+//
+// FeatureMatrix::getTicksPerQuarterNote -- Return the ticks per quarter
+//     note of the last MIDI file loaded.
+//
+
+int FeatureMatrix::getTicksPerQuarterNote(void) const {
+	return m_tpq;
+}
+
+
+int FeatureMatrix::getTPQ(void) const {
+	return m_tpq;
+}
+
+
+
+//////////////////////////////
+//
+// FeatureMatrix::getFilename -- Return the name of the last MIDI file
+//     loaded (without its directory), or an empty string if it was not
+//     read from a file.
+//
+
+const std::string& FeatureMatrix::getFilename(void) const {
+	return m_filename;
+}
+
+
+
+//////////////////////////////
+//
+// FeatureMatrix::write -- Write the matrix as raw little-endian numbers
+//     or as a NumPy .npy file.  Returns false if there was a problem
+//     writing the output.
+//
+
+bool FeatureMatrix::write(std::ostream& output, FeatureMatrix::Format format) const {
+	if (format == Npy) {
+		writeNpyHeader(output, getRowCount(), FEATURE_COLUMNS, m_floatQ);
+	}
+	writeRows(output, -1);
+	return !output.fail();
+}
+
+
+
+//////////////////////////////
+//
+// FeatureMatrix::processFiles -- Load a list of MIDI files in parallel,
+//     using the settings (time unit, unused value, etc.) of the given
+//     matrix.  The callback function is given the index of each file, its
+//     matrix and the read status, in the order of the filenames and
+//     always from the calling thread.  Only a few files per thread are
+//     loaded ahead of the callback, so memory use does not depend on the
+//     number of files.  Returns false if any file could not be read.
+//
+
+bool FeatureMatrix::processFiles(const std::vector<std::string>& filenames,
+		const FeatureMatrix& settings,
+		const std::function<void(int, const FeatureMatrix&, bool)>& callback) {
+	int count = (int)filenames.size();
+	int threadcount = std::min((int)std::thread::hardware_concurrency(), count);
+	bool status = true;
+
+	if (threadcount < 2) {
+		FeatureMatrix matrix(settings);
+		for (int i=0; i<count; i++) {
+			bool loadQ = matrix.load(filenames[i]);
+			status &= loadQ;
+			callback(i, matrix, loadQ);
+		}
+		return status;
+	}
+
+	// Each slot holds the matrix of file index % window.  A file is only
+	// started after the file window places before it has been delivered.
+	int window = threadcount * FEATURE_FILES_AHEAD;
+	std::vector<FeatureMatrix> slots(window, settings);
+	std::vector<int> states(window, 0);   // 0=empty, 1=loaded, 2=failed
+	std::mutex mutex;
+	std::condition_variable condition;
+	int next = 0;
+	int delivered = 0;
+
+	std::vector<std::thread> threads;
+	threads.reserve(threadcount);
+	for (int t=0; t<threadcount; t++) {
+		threads.emplace_back([&]() {
+			while (true) {
+				int index;
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					condition.wait(lock, [&]() {
+						return (next >= count) || (next < delivered + window);
+					});
+					if (next >= count) {
+						return;
+					}
+					index = next++;
+				}
+				bool loadQ = slots[index % window].load(filenames[index]);
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					states[index % window] = loadQ ? 1 : 2;
+				}
+				condition.notify_all();
+			}
+		});
+	}
+
+	for (int i=0; i<count; i++) {
+		int slot = i % window;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			condition.wait(lock, [&]() { return states[slot] != 0; });
+		}
+		bool loadQ = states[slot] == 1;
+		status &= loadQ;
+		callback(i, slots[slot], loadQ);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			states[slot] = 0;
+			delivered++;
+		}
+		condition.notify_all();
+	}
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	return status;
+}
+
+
+
+//////////////////////////////
+//
+// FeatureMatrix::writeFiles -- Convert a list of MIDI files in parallel
+//     and write all of their rows to a single output, in the order of the
+//     filenames.  An extra (eighth) column contains the index of the file
+//     for each row.  NumPy output must be written to a file (or other
+//     seekable stream), since the number of rows is filled in at the end.
+//     Files which cannot be read are reported and skipped.
+//
+
+bool FeatureMatrix::writeFiles(const std::vector<std::string>& filenames,
+		const FeatureMatrix& settings, std::ostream& output,
+		FeatureMatrix::Format format) {
+	std::streampos start = output.tellp();
+	if (format == Npy) {
+		if (start == std::streampos(-1)) {
+			std::cerr << "Error: NumPy output must be written to a file." << std::endl;
+			return false;
+		}
+		writeNpyHeader(output, 0, FEATURE_COLUMNS + 1, settings.m_floatQ);
+	}
+
+	long long rows = 0;
+	bool status = processFiles(filenames, settings, [&](int index,
+			const FeatureMatrix& matrix, bool loadQ) {
+		if (!loadQ) {
+			std::cerr << "Warning: cannot read " << filenames[index] << std::endl;
+			return;
+		}
+		matrix.writeRows(output, index);
+		rows += matrix.getRowCount();
+	});
+
+	if (format == Npy) {
+		std::streampos end = output.tellp();
+		output.seekp(start);
+		writeNpyHeader(output, rows, FEATURE_COLUMNS + 1, settings.m_floatQ);
+		output.seekp(end);
+	}
+	output.flush();
+	return status && !output.fail();
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//
+// private functions
+//
+
+//////////////////////////////
+//
+// FeatureMatrix::getTime -- Convert ticks into the time unit.
+//
+
+double FeatureMatrix::getTime(MidiFile& midifile, int tick) const {
+	switch (m_unit) {
+		case Ticks:        return tick;
+		case Beats:        return (double)tick / m_tpq;
+		case Seconds:      return midifile.getTimeInSeconds(tick);
+		case Milliseconds: return 1000 * midifile.getTimeInSeconds(tick);
+	}
+	return 0.0;
+}
+
+
+
+//////////////////////////////
+//
+// FeatureMatrix::writeRows -- Write the matrix values as little-endian
+//     doubles (or floats).  If the file index is not negative, it is
+//     added as an extra column.
+//
+
+void FeatureMatrix::writeRows(std::ostream& output, int fileindex) const {
+	const unsigned short one = 1;
+	bool swapQ = *((const unsigned char*)&one) != 1;
+	int width = m_floatQ ? 4 : 8;
+	int columns = FEATURE_COLUMNS + (fileindex >= 0 ? 1 : 0);
+	int rowbytes = columns * width;
+
+	std::vector<char> buffer(65536 / rowbytes * rowbytes);
+	char* out = buffer.data();
+	char* limit = out + buffer.size();
+	double row[FEATURE_COLUMNS + 1];
+	row[FEATURE_COLUMNS] = fileindex;
+
+	for (int i=0; i<getRowCount(); i++) {
+		std::copy(getRow(i), getRow(i) + FEATURE_COLUMNS, row);
+		for (int j=0; j<columns; j++) {
+			char bytes[8];
+			if (m_floatQ) {
+				float value = (float)row[j];
+				memcpy(bytes, &value, 4);
+			} else {
+				memcpy(bytes, &row[j], 8);
+			}
+			if (swapQ) {
+				std::reverse(bytes, bytes + width);
+			}
+			out = std::copy(bytes, bytes + width, out);
+		}
+		if (out == limit) {
+			output.write(buffer.data(), out - buffer.data());
+			out = buffer.data();
+		}
+	}
+	output.write(buffer.data(), out - buffer.data());
+}
+
+
+
+//////////////////////////////
+//
+// FeatureMatrix::writeNpyHeader -- Write the header of a version 1.0
+//     NumPy array file for a matrix of little-endian doubles (or floats).
+//     The header is always NPY_HEADER_SIZE bytes long.
+//
+
+void FeatureMatrix::writeNpyHeader(std::ostream& output, long long rows,
+		int columns, bool floatQ) {
+	std::string header = "{'descr': '";
+	header += floatQ ? "<f4" : "<f8";
+	header += "', 'fortran_order': False, 'shape': (";
+	header += std::to_string(rows) + ", " + std::to_string(columns) + "), }";
+	header.resize(NPY_HEADER_SIZE - 11, ' ');
+	header += '\n';
+
+	char magic[10] = {'\x93', 'N', 'U', 'M', 'P', 'Y', 1, 0, 0, 0};
+	magic[8] = (char)(header.size() & 0xff);
+	magic[9] = (char)((header.size() >> 8) & 0xff);
+	output.write(magic, 10);
+	output.write(header.data(), header.size());
+}
+
+
+} // end namespace smf
+
+
+
@@ -0,0 +1,480 @@
+//
+// Creation Date: Mon Oct 19 09:12:44 PDT 2026
+// Filename:      midifile/src-library/MidiConcatenator.cpp
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Streaming concatenation of multiple MIDI files into a
+//                single type-0 MIDI file.  Input files are read one at a
+//                time and their ticks are rescaled to a common
+//                ticks-per-quarter-note value, so only a single input
+//                file is held in memory at any time.
+//
+
+#include "MidiConcatenator.h"
+
+#include <iostream>
+
+
+namespace smf {
+
+// Number of pending track bytes to collect before writing them to a
+// seekable output stream.
+#define CONCAT_FLUSH_SIZE 65536
+
+//////////////////////////////
+//
+// MidiConcatenator::MidiConcatenator -- Constructor.  The default output
+//     ticks-per-quarter-note value of 0 means to use the value from the
+//     first input file.
+//
+
+MidiConcatenator::MidiConcatenator(void) {
+	// do nothing
+}
+
+
+MidiConcatenator::MidiConcatenator(int tpq) {
+	setTicksPerQuarterNote(tpq);
+}
+
+
+
+//////////////////////////////
+//
+// MidiConcatenator::~MidiConcatenator -- Deconstructor.  Finish writing
+//     the output if close() has not been called.
+//
+
+MidiConcatenator::~MidiConcatenator() {
+	if (m_out != NULL) {
+		close();
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiConcatenator::setTicksPerQuarterNote -- Set the ticks per quarter
+//     note of the output file.  All input files will be rescaled to this
+//     value.  This must be set before the first input file is appended.
+//     Values outside of the range 1 to 0x7fff (the largest value which
+//     the MThd chunk can store) are ignored.
+//
+
+void MidiConcatenator::setTicksPerQuarterNote(int tpq) {
+	if (m_headerQ) {
+		std::cerr << "Warning: cannot change TPQ after output has started." << std::endl;
+		return;
+	}
+	if ((tpq <= 0) || (tpq > 0x7fff)) {
+		std::cerr << "Warning: invalid ticks per quarter note: " << tpq << std::endl;
+		return;
+	}
+	m_ticksPerQuarterNote = tpq;
+}
+
+//
+// MidiConcatenator::setTPQ -- Alias for setTicksPerQuarterNote().
+//
+
+void MidiConcatenator::setTPQ(int tpq) {
+	setTicksPerQuarterNote(tpq);
+}
+
+
+
+//////////////////////////////
+//
+// MidiConcatenator::getTicksPerQuarterNote -- Return the ticks per quarter
+//     note of the output file (0 if not yet known).
+//
+
+int MidiConcatenator::getTicksPerQuarterNote(void) const {
+	return m_ticksPerQuarterNote;
+}
+
+//
+// MidiConcatenator::getTPQ -- Alias for getTicksPerQuarterNote().
+//
+
+int MidiConcatenator::getTPQ(void) const {
+	return getTicksPerQuarterNote();
+}
+
+
+
+//////////////////////////////
+//
+// MidiConcatenator::setGap -- Set the duration of silence in seconds
+//     to insert between consecutive input files.  The gap is measured
+//     using the tempo in effect at the end of the previous file.
+//
+
+void MidiConcatenator::setGap(double seconds) {
+	m_gap = seconds < 0.0 ? 0.0 : seconds;
+}
+
+
+
+//////////////////////////////
+//
+// MidiConcatenator::getGap -- Return the duration of silence between
+//     input files.
+//
+
+double MidiConcatenator::getGap(void) const {
+	return m_gap;
+}
+
+
+
+//////////////////////////////
+//
+// MidiConcatenator::open -- Start a new output.  If the output stream is
+//     seekable, track data is written incrementally and the track chunk
+//     size is filled in by close().  Otherwise (for example when writing
+//     to a pipe) the whole track has to be kept in memory until close()
+//     is called, since the track chunk size comes before the track data.
+//
+
+bool MidiConcatenator::open(const std::string& filename) {
+	if (m_out != NULL) {
+		close();
+	}
+	m_file.open(filename.c_str(), std::ios::binary | std::ios::out |
+			std::ios::trunc);
+	if (!m_file.is_open()) {
+		std::cerr << "Error: could not write: " << filename << std::endl;
+		m_rwstatus = false;
+		return m_rwstatus;
+	}
+	return open(m_file);
+}
+
+
+bool MidiConcatenator::open(std::ostream& out) {
+	if ((m_out != NULL) && (m_out != &out)) {
+		close();
+	}
+	m_out          = &out;
+	m_seekable     = out.tellp() != std::streampos(-1);
+	m_headerQ      = false;
+	m_trackbytes   = 0;
+	m_inputCount   = 0;
+	m_pendingTicks = 0;
+	m_tempo        = 500000;
+	m_rwstatus     = true;
+	m_trackdata.clear();
+	m_trackdata.reserve(CONCAT_FLUSH_SIZE + 1024);
+	return m_rwstatus;
+}
+
+
+
+//////////////////////////////
+//
+// MidiConcatenator::close -- Write the end-of-track message, and finish
+//     the track chunk.  Returns false if there was a problem with the
+//     output.
+//
+
+bool MidiConcatenator::close(void) {
+	if (m_out == NULL) {
+		return false;
+	}
+	if (!m_headerQ) {
+		writeHeader();
+	}
+
+	// end-of-track meta message
+	writeVLValue(m_pendingTicks);
+	m_pendingTicks = 0;
+	m_trackdata.push_back(0xff);
+	m_trackdata.push_back(0x2f);
+	m_trackdata.push_back(0x00);
+
+	if (m_seekable) {
+		flush();
+		std::streampos endpos = m_out->tellp();
+		m_out->seekp(m_lengthpos);
+		MidiFile::writeBigEndianULong(*m_out, m_trackbytes);
+		m_out->seekp(endpos);
+	} else {
+		*m_out << 'M' << 'T' << 'r' << 'k';
+		MidiFile::writeBigEndianULong(*m_out, (ulong)m_trackdata.size());
+		m_out->write((char*)m_trackdata.data(), m_trackdata.size());
+		m_trackdata.clear();
+	}
+
+	m_out->flush();
+	if (m_out->fail()) {
+		m_rwstatus = false;
+	}
+	if (m_file.is_open()) {
+		m_file.close();
+	}
+	m_out = NULL;
+	m_headerQ = false;
+	return m_rwstatus;
+}
+
+
+
+//////////////////////////////
+//
+// MidiConcatenator::append -- Add a MIDI file to the end of the output.
+//     Tempo changes in the input are preserved, and if the input does not
+//     start with a tempo message, the default tempo of 120 bpm is restored
+//     so that the tempo at the end of the previous input does not carry
+//     over.  The end-of-track time of the input is used as its duration.
+//     When a MidiFile is given as input, its track and tick states are
+//     restored after its contents have been appended.
+//
+
+bool MidiConcatenator::append(const std::string& filename) {
+	if (!m_infile.read(filename)) {
+		std::cerr << "Error: could not read: " << filename << std::endl;
+		m_rwstatus = false;
+		return m_rwstatus;
+	}
+	bool output = append(m_infile);
+	m_infile.clear();
+	return output;
+}
+
+
+bool MidiConcatenator::append(MidiFile& infile) {
+	if (m_out == NULL) {
+		std::cerr << "Error: output must be opened before appending." << std::endl;
+		m_rwstatus = false;
+		return m_rwstatus;
+	}
+
+	int intpq = infile.getTicksPerQuarterNote();
+	if ((intpq <= 0) || ((m_ticksPerQuarterNote <= 0) && (intpq > 0x7fff))) {
+		std::cerr << "Error: invalid ticks per quarter note: " << intpq << std::endl;
+		m_rwstatus = false;
+		return m_rwstatus;
+	}
+	if (m_ticksPerQuarterNote <= 0) {
+		m_ticksPerQuarterNote = intpq;
+	}
+	if (!m_headerQ) {
+		writeHeader();
+	}
+	long long outtpq = m_ticksPerQuarterNote;
+
+	int trackstate = infile.getTrackState();
+	int timestate  = infile.getTickState();
+	infile.joinTracks();
+	infile.makeAbsoluteTicks();
+	MidiEventList& events = infile[0];
+
+	// silence between files, at the tempo of the end of the last file:
+	if ((m_inputCount > 0) && (m_gap > 0.0)) {
+		m_pendingTicks += (long)(m_gap * 1000000.0 / m_tempo * outtpq + 0.5);
+	}
+
+	// reset to the default tempo if the input does not set its own:
+	bool initialTempo = false;
+	for (int i=0; i<events.size(); i++) {
+		if (events[i].tick > 0) {
+			break;
+		}
+		if (events[i].isTempo()) {
+			initialTempo = true;
+			break;
+		}
+	}
+	if (!initialTempo && (m_tempo != 500000)) {
+		writeTempo(m_pendingTicks, 500000);
+		m_pendingTicks = 0;
+	}
+
+	// Ticks are rescaled from their absolute positions in the input, so
+	// rounding errors do not accumulate over the length of the file.
+	long lasttick = 0;
+	long endtick  = 0;
+	long scaled;
+	for (int i=0; i<events.size(); i++) {
+		const MidiEvent& event = events[i];
+		scaled = (long)(((long long)event.tick * outtpq * 2 + intpq) /
+				(2 * (long long)intpq));
+		if (scaled > endtick) {
+			endtick = scaled;
+		}
+		if (event.empty() || event.isEndOfTrack()) {
+			continue;
+		}
+		writeEvent(m_pendingTicks + scaled - lasttick, event);
+		m_pendingTicks = 0;
+		lasttick = scaled;
+		if (event.isTempo()) {
+			m_tempo = event.getTempoMicroseconds();
+		}
+	}
+	m_pendingTicks += endtick - lasttick;
+
+	if (timestate == TIME_STATE_DELTA) {
+		infile.makeDeltaTicks();
+	}
+	if (trackstate == TRACK_STATE_SPLIT) {
+		infile.splitTracks();
+	}
+
+	m_inputCount++;
+	if (m_seekable && (m_trackdata.size() >= CONCAT_FLUSH_SIZE)) {
+		flush();
+	}
+	return m_rwstatus;
+}
+
+
+
+//////////////////////////////
+//
+// MidiConcatenator::getInputCount -- Return the number of files which have
+//     been appended to the current output.
+//
+
+int MidiConcatenator::getInputCount(void) const {
+	return m_inputCount;
+}
+
+
+
+//////////////////////////////
+//
+// MidiConcatenator::status -- Returns false if there was a problem
+//     reading an input file or writing the output.
+//
+
+bool MidiConcatenator::status(void) const {
+	return m_rwstatus;
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//
+// private functions
+//
+
+//////////////////////////////
+//
+// MidiConcatenator::writeHeader -- Write the MThd chunk and the start of
+//     the single MTrk chunk of the output.
+//
+
+void MidiConcatenator::writeHeader(void) {
+	if (m_ticksPerQuarterNote <= 0) {
+		m_ticksPerQuarterNote = 120;
+	}
+	std::ostream& out = *m_out;
+	out << 'M' << 'T' << 'h' << 'd';
+	MidiFile::writeBigEndianULong(out, 6);
+	MidiFile::writeBigEndianUShort(out, 0);  // type-0 file
+	MidiFile::writeBigEndianUShort(out, 1);  // one track
+	MidiFile::writeBigEndianUShort(out, (ushort)m_ticksPerQuarterNote);
+	if (m_seekable) {
+		out << 'M' << 'T' << 'r' << 'k';
+		m_lengthpos = out.tellp();
+		// track size is filled in by close():
+		MidiFile::writeBigEndianULong(out, 0);
+	}
+	m_headerQ = true;
+}
+
+
+
+//////////////////////////////
+//
+// MidiConcatenator::writeEvent -- Store a MIDI message with the given
+//     delta time in the pending track data.  System exclusive messages
+//     have their VLV size inserted in the same manner as MidiFile::write().
+//
+
+void MidiConcatenator::writeEvent(long deltatick, const MidiEvent& event) {
+	writeVLValue(deltatick);
+	int command = event.getCommandByte();
+	if ((command == 0xf0) || (command == 0xf7)) {
+		m_trackdata.push_back(event[0]);
+		writeVLValue(((long)event.size())-1);
+		m_trackdata.insert(m_trackdata.end(), event.begin() + 1, event.end());
+	} else {
+		m_trackdata.insert(m_trackdata.end(), event.begin(), event.end());
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiConcatenator::writeTempo -- Store a tempo meta message in the
+//     pending track data.
+//
+
+void MidiConcatenator::writeTempo(long deltatick, int microseconds) {
+	writeVLValue(deltatick);
+	m_trackdata.push_back(0xff);
+	m_trackdata.push_back(0x51);
+	m_trackdata.push_back(0x03);
+	m_trackdata.push_back((uchar)((microseconds >> 16) & 0xff));
+	m_trackdata.push_back((uchar)((microseconds >>  8) & 0xff));
+	m_trackdata.push_back((uchar)((microseconds >>  0) & 0xff));
+	m_tempo = microseconds;
+}
+
+
+
+//////////////////////////////
+//
+// MidiConcatenator::writeVLValue -- Store a number as a variable length
+//     value in the pending track data.  Maximum size of input is 0x0FFFffff.
+//
+
+void MidiConcatenator::writeVLValue(long aValue) {
+	if ((unsigned long)aValue >= (1 << 28)) {
+		std::cerr << "Error: number too large to convert to VLV" << std::endl;
+		aValue = 0x0FFFffff;
+	}
+	uchar bytes[4];
+	bytes[0] = (uchar)(((ulong)aValue >> 21) & 0x7f);
+	bytes[1] = (uchar)(((ulong)aValue >> 14) & 0x7f);
+	bytes[2] = (uchar)(((ulong)aValue >> 7)  & 0x7f);
+	bytes[3] = (uchar)(((ulong)aValue)       & 0x7f);
+
+	int start = 0;
+	while ((start<3) && (bytes[start] == 0)) {
+		start++;
+	}
+	for (int i=start; i<3; i++) {
+		m_trackdata.push_back(bytes[i] | 0x80);
+	}
+	m_trackdata.push_back(bytes[3]);
+}
+
+
+
+//////////////////////////////
+//
+// MidiConcatenator::flush -- Write pending track data to a seekable
+//     output stream.
+//
+
+void MidiConcatenator::flush(void) {
+	if (m_trackdata.empty()) {
+		return;
+	}
+	m_out->write((char*)m_trackdata.data(), m_trackdata.size());
+	m_trackbytes += (ulong)m_trackdata.size();
+	m_trackdata.clear();
+}
+
+
+} // end namespace smf
+
+
+
@@ -12,6 +12,7 @@
 
 
 #include "MidiEventList.h"
+#include "NoteLinker.h"
 
 #include <vector>
 #include <algorithm>
@@ -39,6 +40,7 @@ MidiEventList::MidiEventList(void) {
 //
 
 MidiEventList::MidiEventList(const MidiEventList& other) {
+	m_sortedQ = other.m_sortedQ;
 	list.reserve(other.list.size());
 	auto it = other.list.begin();
 	std::generate_n(std::back_inserter(list), other.list.size(), [&]() -> MidiEvent* {
@@ -55,7 +57,9 @@ MidiEventList::MidiEventList(const MidiEventList& other) {
 
 MidiEventList::MidiEventList(MidiEventList&& other) {
    list = std::move(other.list);
+   m_sortedQ = other.m_sortedQ;
    other.list.clear();
+   other.m_sortedQ = true;
 }
 
 
@@ -148,6 +152,7 @@ void MidiEventList::clear(void) {
 		}
 	}
 	list.resize(0);
+	m_sortedQ = true;
 }
 
 
@@ -156,7 +161,8 @@ void MidiEventList::clear(void) {
 //
 // MidiEventList::data -- Return the low-level array of MidiMessage
 //     pointers.  This is useful for applying your own sorting
-//     function to the list.
+//     function to the list.  Call checkSorted() after reordering the
+//     events.
 //
 
 MidiEvent** MidiEventList::data(void) {
@@ -206,6 +212,94 @@ int MidiEventList::getEventCount(void) const {
 
 
 
+//////////////////////////////
+//
+// MidiEventList::lowerBound -- Return the index of the first event with a
+//     tick value at or after the given tick, or size() if there is none.
+//     The ticks are compared as stored, so the list should be in absolute
+//     tick mode.  A binary search is used if the list is sorted (see
+//     isSorted()), otherwise the events are searched in order.
+//
+
+int MidiEventList::lowerBound(int tick) const {
+	if (m_sortedQ) {
+		auto it = std::lower_bound(list.begin(), list.end(), tick,
+				[](const MidiEvent* event, int value) {
+					return event->tick < value;
+				});
+		return (int)(it - list.begin());
+	}
+	int count = (int)list.size();
+	for (int i=0; i<count; i++) {
+		if (list[i]->tick >= tick) {
+			return i;
+		}
+	}
+	return count;
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventList::upperBound -- Return the index of the first event with a
+//     tick value after the given tick, or size() if there is none.  See
+//     lowerBound().
+//
+
+int MidiEventList::upperBound(int tick) const {
+	if (m_sortedQ) {
+		auto it = std::upper_bound(list.begin(), list.end(), tick,
+				[](int value, const MidiEvent* event) {
+					return value < event->tick;
+				});
+		return (int)(it - list.begin());
+	}
+	int count = (int)list.size();
+	for (int i=0; i<count; i++) {
+		if (list[i]->tick > tick) {
+			return i;
+		}
+	}
+	return count;
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventList::isSorted -- Return true if the events are known to be in
+//     non-decreasing tick order.  The flag is set by sorting, and cleared
+//     when an event is appended before the last event.  Changing the tick
+//     of an event directly does not update the flag: call checkSorted()
+//     (or MidiFile::sortTracks()) afterwards.
+//
+
+bool MidiEventList::isSorted(void) const {
+	return m_sortedQ;
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventList::checkSorted -- Check the tick order of the events and
+//     update the sorted flag.  Returns the new value of the flag.
+//
+
+bool MidiEventList::checkSorted(void) {
+	m_sortedQ = true;
+	for (int i=1; i<(int)list.size(); i++) {
+		if (list[i]->tick < list[i-1]->tick) {
+			m_sortedQ = false;
+			break;
+		}
+	}
+	return m_sortedQ;
+}
+
+
+
 //////////////////////////////
 //
 // MidiEventList::append -- add a MidiEvent at the end of the list.  Returns
@@ -214,6 +308,9 @@ int MidiEventList::getEventCount(void) const {
 
 int MidiEventList::append(MidiEvent& event) {
 	MidiEvent* ptr = new MidiEvent(event);
+	if (!list.empty() && (ptr->tick < list.back()->tick)) {
+		m_sortedQ = false;
+	}
 	list.push_back(ptr);
 	return (int)list.size()-1;
 }
@@ -272,11 +369,12 @@ void MidiEventList::removeEmpties(void) {
 // MidiEventList::linkNotePairs -- Match note-ones and note-offs together
 //   There are two models that can be done if two notes are overlapping
 //   on the same pitch: the first note-off affects the last note-on,
-//   or the first note-off affects the first note-on.  Currently  the
-//   first note-off affects the last note-on, but both methods could
-//   be implemented with user selectability.  The current state of the
-//   track is assumed to be in time-sorted order.  Returns the number
-//   of linked notes (note-on/note-off pairs).
+//   or the first note-off affects the first note-on.  By default the
+//   first note-off affects the last note-on; give a NoteLinker to
+//   select another method (see NoteLinker::setPolicy()).  The current
+//   state of the track is assumed to be in time-sorted order.  Returns
+//   the number of linked notes (note-on/note-off pairs).  On/off switch
+//   controllers such as the sustain pedal are also linked.
 //
 
 int MidiEventList::linkEventPairs(void) {
@@ -285,132 +383,94 @@ int MidiEventList::linkEventPairs(void) {
 
 
 int MidiEventList::linkNotePairs(void) {
+	NoteLinker linker;
+	return linker.link(*this);
+}
 
-	// Note-on states:
-	// dimension 1: MIDI channel (0-15)
-	// dimension 2: MIDI key     (0-127)  (but 0 not used for note-ons)
-	// dimension 3: List of active note-ons or note-offs.
-	std::vector<std::vector<std::vector<MidiEvent*>>> noteons;
-	noteons.resize(16);
-	int i;
-	for (i=0; i<(int)noteons.size(); i++) {
-		noteons[i].resize(128);
-	}
 
-	// Controller linking: The following General MIDI controller numbers are
-	// also monitored for linking within the track (but not between tracks).
-	// hex dec  name                                    range
-	// 40  64   Hold pedal (Sustain) on/off             0..63=off  64..127=on
-	// 41  65   Portamento on/off                       0..63=off  64..127=on
-	// 42  66   Sustenuto Pedal on/off                  0..63=off  64..127=on
-	// 43  67   Soft Pedal on/off                       0..63=off  64..127=on
-	// 44  68   Legato Pedal on/off                     0..63=off  64..127=on
-	// 45  69   Hold Pedal 2 on/off                     0..63=off  64..127=on
-	// 50  80   General Purpose Button                  0..63=off  64..127=on
-	// 51  81   General Purpose Button                  0..63=off  64..127=on
-	// 52  82   General Purpose Button                  0..63=off  64..127=on
-	// 53  83   General Purpose Button                  0..63=off  64..127=on
-	// 54  84   Undefined on/off                        0..63=off  64..127=on
-	// 55  85   Undefined on/off                        0..63=off  64..127=on
-	// 56  86   Undefined on/off                        0..63=off  64..127=on
-	// 57  87   Undefined on/off                        0..63=off  64..127=on
-	// 58  88   Undefined on/off                        0..63=off  64..127=on
-	// 59  89   Undefined on/off                        0..63=off  64..127=on
-	// 5A  90   Undefined on/off                        0..63=off  64..127=on
-	// 7A 122   Local Keyboard On/Off                   0..63=off  64..127=on
-
-	// first keep track of whether the controller is an on/off switch:
-	std::vector<std::pair<int, int>> contmap;
-	contmap.resize(128);
-	std::pair<int, int> zero(0, 0);
-	std::fill(contmap.begin(), contmap.end(), zero);
-	contmap[64].first  = 1;   contmap[64].second = 0;
-	contmap[65].first  = 1;   contmap[65].second = 1;
-	contmap[66].first  = 1;   contmap[66].second = 2;
-	contmap[67].first  = 1;   contmap[67].second = 3;
-	contmap[68].first  = 1;   contmap[68].second = 4;
-	contmap[69].first  = 1;   contmap[69].second = 5;
-	contmap[80].first  = 1;   contmap[80].second = 6;
-	contmap[81].first  = 1;   contmap[81].second = 7;
-	contmap[82].first  = 1;   contmap[82].second = 8;
-	contmap[83].first  = 1;   contmap[83].second = 9;
-	contmap[84].first  = 1;   contmap[84].second = 10;
-	contmap[85].first  = 1;   contmap[85].second = 11;
-	contmap[86].first  = 1;   contmap[86].second = 12;
-	contmap[87].first  = 1;   contmap[87].second = 13;
-	contmap[88].first  = 1;   contmap[88].second = 14;
-	contmap[89].first  = 1;   contmap[89].second = 15;
-	contmap[90].first  = 1;   contmap[90].second = 16;
-	contmap[122].first = 1;   contmap[122].second = 17;
-
-	// dimensions:
-	// 1: mapped controller (0 to 17)
-	// 2: channel (0 to 15)
-	std::vector<std::vector<MidiEvent*>> contevents;
-	contevents.resize(18);
-	std::vector<std::vector<int>> oldstates;
-	oldstates.resize(18);
-	for (int i=0; i<18; i++) {
-		contevents[i].resize(16);
-		std::fill(contevents[i].begin(), contevents[i].end(), nullptr);
-		oldstates[i].resize(16);
-		std::fill(oldstates[i].begin(), oldstates[i].end(), -1);
+int MidiEventList::linkNotePairs(NoteLinker& linker) {
+	return linker.link(*this);
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventList::getSustainedNoteEnds -- Find the event which ends the
+//   sound of each note when the sustain pedal (controller 64) is taken
+//   into account.  A note released while the pedal is down keeps
+//   sounding until the pedal is released (using the controller links
+//   from linkNotePairs()), or until the same key is struck again on the
+//   same channel.  ends[i] is set to the note-off, pedal-off or
+//   re-striking note-on for each linked note-on at index i (the note-off
+//   if the pedal was up), or NULL for other events.  If the pedal is
+//   never released, the note sounds until the last event in the list.
+//   The pedal state is followed in a single pass over the list, so
+//   linkNotePairs() must have been called on the list (in absolute tick
+//   mode) first.  Returns the number of notes extended by the pedal.
+//
+
+int MidiEventList::getSustainedNoteEnds(std::vector<const MidiEvent*>& ends) const {
+	int count = getEventCount();
+	ends.assign(count, NULL);
+	if (count == 0) {
+		return 0;
 	}
 
-	// Now iterate through the MidiEventList keeping track of note and
-	// select controller states and linking notes/controllers as needed.
-	int channel;
-	int key;
-	int contnum;
-	int contval;
-	int conti;
-	int contstate;
+	// pedaloff == the pedal-off event for each channel while the pedal
+	// is down (or NULL if the pedal is up).
+	const MidiEvent* pedaloff[16] = {NULL};
+
+	// Note-ons waiting for their note-off are chained in stacks for each
+	// channel/key (open = top of stack, -1 if empty; chain = next index
+	// in the stack).  sustained == the last note-on of each key which was
+	// released while the pedal was down (-1 if none).
+	std::vector<int> open(16 * 128, -1);
+	std::vector<int> sustained(16 * 128, -1);
+	std::vector<int> chain(count, -1);
+
 	int counter = 0;
-	MidiEvent* mev;
-	MidiEvent* noteon;
-	for (i=0; i<getSize(); i++) {
-		mev = &getEvent(i);
-		mev->unlinkEvent();
-		if (mev->isNoteOn()) {
-			// store the note-on to pair later with a note-off message.
-			key = mev->getKeyNumber();
-			channel = mev->getChannel();
-			noteons[channel][key].push_back(mev);
-		} else if (mev->isNoteOff()) {
-			key = mev->getKeyNumber();
-			channel = mev->getChannel();
-			if (noteons[channel][key].size() > 0) {
-				noteon = noteons[channel][key].back();
-				noteons[channel][key].pop_back();
-				noteon->linkEvent(mev);
+	for (int i=0; i<count; i++) {
+		const MidiEvent& event = getEvent(i);
+		if (event.isNoteOn()) {
+			if (!event.isLinked()) {
+				continue;
+			}
+			int slot = event.getChannel() * 128 + event.getKeyNumber();
+			int last = sustained[slot];
+			if ((last >= 0) && (ends[last]->tick > event.tick)) {
+				// striking the key again stops the sustained note
+				ends[last] = &event;
+			}
+			sustained[slot] = -1;
+			ends[i] = event.getLinkedEvent();
+			chain[i] = open[slot];
+			open[slot] = i;
+		} else if (event.isNoteOff()) {
+			int channel = event.getChannel();
+			int slot = channel * 128 + event.getKeyNumber();
+			const MidiEvent* noteon = event.getLinkedEvent();
+			int* link = &open[slot];
+			while ((*link >= 0) && (&getEvent(*link) != noteon)) {
+				link = &chain[*link];
+			}
+			if (*link < 0) {
+				continue;
+			}
+			int index = *link;
+			*link = chain[index];
+			if (pedaloff[channel] != NULL) {
+				ends[index] = pedaloff[channel];
+				sustained[slot] = index;
 				counter++;
 			}
-		} else if (mev->isController()) {
-			contnum = mev->getP1();
-			if (contmap[contnum].first) {
-				conti     = contmap[contnum].second;
-				channel   = mev->getChannel();
-				contval   = mev->getP2();
-				contstate = contval < 64 ? 0 : 1;
-				if ((oldstates[conti][channel] == -1) && contstate) {
-					// a newly initialized onstate was detected, so store for
-					// later linking to an off state.
-					contevents[conti][channel] = mev;
-					oldstates[conti][channel] = contstate;
-				} else if (oldstates[conti][channel] == contstate) {
-					// the controller state is redundant and will be ignored.
-				} else if ((oldstates[conti][channel] == 0) && contstate) {
-					// controller is currently off, so store on-state for next link
-					contevents[conti][channel] = mev;
-					oldstates[conti][channel] = contstate;
-				} else if ((oldstates[conti][channel] == 1) && (contstate == 0)) {
-					// controller has just been turned off, so link to
-					// stored on-message.
-					contevents[conti][channel]->linkEvent(mev);
-					oldstates[conti][channel] = contstate;
-					// not necessary, but maybe use for something later:
-					contevents[conti][channel] = mev;
-				}
+		} else if (event.isController() && (event.getP1() == 64)) {
+			int channel = event.getChannel();
+			if (event.getP2() < 64) {
+				pedaloff[channel] = NULL;
+			} else if (pedaloff[channel] == NULL) {
+				const MidiEvent* off = event.getLinkedEvent();
+				pedaloff[channel] = off != NULL ? off : &getEvent(count - 1);
 			}
 		}
 	}
@@ -486,6 +546,7 @@ int MidiEventList::markSequence(int sequence) {
 
 void MidiEventList::detach(void) {
 	list.resize(0);
+	m_sortedQ = true;
 }
 
 
@@ -498,6 +559,9 @@ void MidiEventList::detach(void) {
 //
 
 int MidiEventList::push_back_no_copy(MidiEvent* event) {
+	if (!list.empty() && (event->tick < list.back()->tick)) {
+		m_sortedQ = false;
+	}
 	list.push_back(event);
 	return (int)list.size()-1;
 }
@@ -511,6 +575,7 @@ int MidiEventList::push_back_no_copy(MidiEvent* event) {
 
 MidiEventList& MidiEventList::operator=(MidiEventList& other) {
 	list.swap(other.list);
+	std::swap(m_sortedQ, other.m_sortedQ);
 	return *this;
 }
 
@@ -526,10 +591,16 @@ MidiEventList& MidiEventList::operator=(MidiEventList& other) {
 //    track of delta versus absolute tick states of the MidiEventList,
 //    and sorting is only allowed in absolute tick state (The MidiEventList
 //    does not know about delta/absolute tick states of its contents).
+//    The sort is stable, so events which eventcompare() cannot order
+//    stay in the order that they were added.
 //
 
 void MidiEventList::sort(void) {
-	qsort(data(), getEventCount(), sizeof(MidiEvent*), eventcompare);
+	std::stable_sort(list.begin(), list.end(),
+			[](const MidiEvent* a, const MidiEvent* b) {
+				return eventcompare(*a, *b) < 0;
+			});
+	m_sortedQ = true;
 }
 
 
@@ -541,81 +612,104 @@ void MidiEventList::sort(void) {
 
 //////////////////////////////
 //
-// eventcompare -- Event comparison function for sorting tracks.
+// eventrank -- Return the position of an event among events at the same
+//    tick: meta messages (0), other messages (1), note-offs (2), note-ons
+//    (3) and end-of-track (4).
+//
+
+int eventrank(const MidiEvent& event) {
+	int p0 = event.getP0();
+	if (p0 == 0xff) {
+		return event.getP1() == 0x2f ? 4 : 0;
+	}
+	int command = p0 & 0xf0;
+	if ((command == 0x90) && (event.getP2() != 0)) {
+		return 3;
+	} else if ((command == 0x90) || (command == 0x80)) {
+		return 2;
+	}
+	return 1;
+}
+
+
+
+//////////////////////////////
+//
+// eventcompare -- Event comparison function for sorting tracks.  Returns
+//    a negative value if event a comes before event b, a positive value
+//    if it comes after, and 0 if they cannot be ordered.
 //
 // Sorting rules:
 //    (1) sort by (absolute) tick value; otherwise, if tick values are the same:
-//    (2) end-of-track meta message is always last.
-//    (3) other meta-messages come before regular MIDI messages.
-//    (4) note-offs come after all other regular MIDI messages except note-ons.
-//    (5) note-ons come after all other regular MIDI messages.
-//
+//    (2) events with sequence numbers are sorted by them (see
+//        MidiEventList::markSequence()).
+//    (3) end-of-track meta message is always last.
+//    (4) other meta-messages come before regular MIDI messages.
+//    (5) note-offs come after all other regular MIDI messages except note-ons.
+//    (6) note-ons come after all other regular MIDI messages.
+//    (7) continuous controllers are sorted by controller number and then
+//        by value.
+//    (8) note-ons (or note-offs) are sorted by key number and then by
+//        channel.
+// Rules (2) to (8) are given by eventcompareAtTick(), which can be used
+// for events whose ticks are known to be the same (such as by TrackMerger,
+// which may iterate over delta ticks).  Events which are still equal are
+// left in their original order by MidiEventList::sort().
+//
+
+int eventcompare(const MidiEvent& a, const MidiEvent& b) {
+	if (a.tick != b.tick) {
+		return a.tick > b.tick ? +1 : -1;
+	}
+	return eventcompareAtTick(a, b);
+}
+
 
 int eventcompare(const void* a, const void* b) {
-	MidiEvent& aevent = **((MidiEvent**)a);
-	MidiEvent& bevent = **((MidiEvent**)b);
-
-	if (aevent.tick > bevent.tick) {
-		// aevent occurs after bevent
-		return +1;
-	} else if (aevent.tick < bevent.tick) {
-		// aevent occurs before bevent
-		return -1;
-	} else if ((aevent.seq != 0) && (bevent.seq != 0) && (aevent.seq > bevent.seq)) {
-		// aevent sequencing state occurs after bevent
-		// see MidiEventList::markSequence()
-		return +1;
-	} else if ((aevent.seq != 0) && (bevent.seq != 0) && (aevent.seq < bevent.seq)) {
-		// aevent sequencing state occurs before bevent
-		// see MidiEventList::markSequence()
-		return -1;
-	} else if (aevent.getP0() == 0xff && aevent.getP1() == 0x2f) {
-		// end-of-track meta-message should always be last (but won't really
-		// matter since the writing function ignores all end-of-track messages
-		// and writes its own.
-		return +1;
-	} else if (bevent.getP0() == 0xff && bevent.getP1() == 0x2f) {
-		// end-of-track meta-message should always be last (but won't really
-		// matter since the writing function ignores all end-of-track messages
-		// and writes its own.
-		return -1;
-	} else if (aevent.getP0() == 0xff && bevent.getP0() != 0xff) {
-		// other meta-messages are placed before real MIDI messages
-		return -1;
-	} else if (aevent.getP0() != 0xff && bevent.getP0() == 0xff) {
-		// other meta-messages are placed before real MIDI messages
-		return +1;
-	} else if (((aevent.getP0() & 0xf0) == 0x90) && (aevent.getP2() != 0)) {
-		// note-ons come after all other types of MIDI messages
-		return +1;
-	} else if (((bevent.getP0() & 0xf0) == 0x90) && (bevent.getP2() != 0)) {
-		// note-ons come after all other types of MIDI messages
-		return -1;
-	} else if (((aevent.getP0() & 0xf0) == 0x90) || ((aevent.getP0() & 0xf0) == 0x80)) {
-		// note-offs come after all other MIDI messages (except note-ons)
-		return +1;
-	} else if (((bevent.getP0() & 0xf0) == 0x90) || ((bevent.getP0() & 0xf0) == 0x80)) {
-		// note-offs come after all other MIDI messages (except note-ons)
-		return -1;
-	} else if (((aevent.getP0() & 0xf0) == 0xb0) && ((bevent.getP0() & 0xf0) == 0xb0)) {
-		// both events are continuous controllers.  Sort them by controller number
-		if (aevent.getP1() > bevent.getP1()) {
-			return +1;
-		} if (aevent.getP1() < bevent.getP1()) {
-			return -1;
-		} else {
-			// same controller number, so sort by data value
-			if (aevent.getP2() > bevent.getP2()) {
-				return +1;
-			} if (aevent.getP2() < bevent.getP2()) {
-				return -1;
-			} else {
-				return 0;
-			}
+	return eventcompare(**((const MidiEvent* const*)a),
+			**((const MidiEvent* const*)b));
+}
+
+
+
+//////////////////////////////
+//
+// eventcompareAtTick -- Compare two events which occur at the same tick,
+//    following rules (2) to (8) of eventcompare().
+//
+
+int eventcompareAtTick(const MidiEvent& a, const MidiEvent& b) {
+	if ((a.seq != 0) && (b.seq != 0) && (a.seq != b.seq)) {
+		return a.seq > b.seq ? +1 : -1;
+	}
+
+	int arank = eventrank(a);
+	int brank = eventrank(b);
+	if (arank != brank) {
+		return arank > brank ? +1 : -1;
+	}
+
+	if ((arank == 1) && ((a.getP0() & 0xf0) == 0xb0) &&
+			((b.getP0() & 0xf0) == 0xb0)) {
+		// both events are continuous controllers.  Sort them by controller
+		// number, and then by data value
+		if (a.getP1() != b.getP1()) {
+			return a.getP1() > b.getP1() ? +1 : -1;
+		}
+		if (a.getP2() != b.getP2()) {
+			return a.getP2() > b.getP2() ? +1 : -1;
+		}
+	} else if ((arank == 2) || (arank == 3)) {
+		// both events are note-ons or note-offs.  Sort them by key number,
+		// and then by channel
+		if (a.getP1() != b.getP1()) {
+			return a.getP1() > b.getP1() ? +1 : -1;
+		}
+		if (a.getChannel() != b.getChannel()) {
+			return a.getChannel() > b.getChannel() ? +1 : -1;
 		}
-	} else {
-		return 0;
 	}
+	return 0;
 }
 
 
@@ -14,6 +14,9 @@
 
 #include "MidiFile.h"
 #include "Binasc.h"
+#include "TrackMerger.h"
+#include "NoteIndex.h"
+#include "NoteLinker.h"
 
 #include <string>
 #include <vector>
@@ -23,6 +26,8 @@
 #include <sstream>
 #include <iterator>
 #include <algorithm>
+#include <thread>
+#include <atomic>
 
 
 namespace smf {
@@ -87,6 +92,7 @@ MidiFile::~MidiFile() {
 	m_rwstatus = false;
 	m_timemap.clear();
 	m_timemapvalid = 0;
+	clearNoteIndex();
 }
 
 
@@ -115,6 +121,8 @@ MidiFile& MidiFile::operator=(const MidiFile& other) {
 	m_timemapvalid        = other.m_timemapvalid;
 	m_timemap             = other.m_timemap;
 	m_rwstatus            = other.m_rwstatus;
+	m_frozenQ             = other.m_frozenQ;
+	clearNoteIndex();
 	if (other.m_linkedEventsQ) {
 		linkEventPairs();
 	}
@@ -136,6 +144,10 @@ MidiFile& MidiFile::operator=(MidiFile&& other) {
 	m_timemapvalid        = other.m_timemapvalid;
 	m_timemap             = other.m_timemap;
 	m_rwstatus            = other.m_rwstatus;
+	m_frozenQ             = other.m_frozenQ;
+	clearNoteIndex();
+	m_noteindex = other.m_noteindex;
+	other.m_noteindex = NULL;
 	return *this;
 }
 
@@ -786,6 +798,7 @@ int MidiFile::size(void) const {
 //
 
 void MidiFile::removeEmpties(void) {
+	clearNoteIndex();
 	for (int i=0; i<(int)m_events.size(); i++) {
 		m_events[i]->removeEmpties();
 	}
@@ -1137,6 +1150,7 @@ void MidiFile::makeDeltaTicks(void) {
 			(*m_events[i])[j].tick = deltatick;
 			timedata[i] = temp;
 		}
+		m_events[i]->checkSorted();
 	}
 	m_theTimeState = TIME_STATE_DELTA;
 	delete [] timedata;
@@ -1180,6 +1194,7 @@ void MidiFile::makeAbsoluteTicks(void) {
 			timedata[i] += (*m_events[i])[j].tick;
 			(*m_events[i])[j].tick = timedata[i];
 		}
+		m_events[i]->checkSorted();
 	}
 	m_theTimeState = TIME_STATE_ABSOLUTE;
 	delete [] timedata;
@@ -1238,25 +1253,28 @@ bool MidiFile::isAbsoluteTicks(void) const {
 //    before calling this function, since this function
 //    assumes that the last MidiEvent in the track has the
 //    highest tick timestamp.  The file state can be in delta
-//    ticks since this function will temporarily go to absolute
-//    tick mode for the calculation of the max tick.
+//    ticks, in which case the delta ticks of each track are
+//    added together (the MidiFile is not modified).
 //
 
-int MidiFile::getFileDurationInTicks(void) {
-	bool revertToDelta = false;
-	if (isDeltaTicks()) {
-		makeAbsoluteTicks();
-		revertToDelta = true;
-	}
+int MidiFile::getFileDurationInTicks(void) const {
 	const MidiFile& mf = *this;
 	int output = 0;
 	for (int i=0; i<mf.getTrackCount(); i++) {
-		if (mf[i].back().tick > output) {
-			output = mf[i].back().tick;
+		if (mf[i].size() == 0) {
+			continue;
+		}
+		int duration = 0;
+		if (isDeltaTicks()) {
+			for (int j=0; j<mf[i].size(); j++) {
+				duration += mf[i][j].tick;
+			}
+		} else {
+			duration = mf[i].back().tick;
+		}
+		if (duration > output) {
+			output = duration;
 		}
-	}
-	if (revertToDelta) {
-		deltaTicks();
 	}
 	return output;
 }
@@ -1266,13 +1284,12 @@ int MidiFile::getFileDurationInTicks(void) {
 ///////////////////////////////
 //
 // MidiFile::getFileDurationInQuarters -- Returns the Duration of the MidiFile
-//    in units of quarter notes.  If the MidiFile is in delta tick mode,
-//    then temporarily got into absolute tick mode to do the calculations.
-//    Note that this is expensive, so you should normally call this function
-//    while in aboslute tick (default) mode.
+//    in units of quarter notes.  Note that this is more expensive in
+//    delta tick mode, so you should normally call this function while
+//    in aboslute tick (default) mode.
 //
 
-double MidiFile::getFileDurationInQuarters(void) {
+double MidiFile::getFileDurationInQuarters(void) const {
 	return (double)getFileDurationInTicks() / (double)getTicksPerQuarterNote();
 }
 
@@ -1284,9 +1301,10 @@ double MidiFile::getFileDurationInQuarters(void) {
 //    logest track in the file.  The tracks must be sorted before
 //    calling this function, since this function assumes that the
 //    last MidiEvent in the track has the highest timestamp.
-//    The file state can be in delta ticks since this function
-//    will temporarily go to absolute tick mode for the calculation
-//    of the max time.
+//    The file state can be in delta ticks.  The const version
+//    returns -1.0 if the time analysis has not been done (see
+//    freeze() and doTimeAnalysis()).
+//
 
 double MidiFile::getFileDurationInSeconds(void) {
 	if (m_timemapvalid == 0) {
@@ -1295,25 +1313,69 @@ double MidiFile::getFileDurationInSeconds(void) {
 			return -1.0;    // something went wrong
 		}
 	}
-	bool revertToDelta = false;
-	if (isDeltaTicks()) {
-		makeAbsoluteTicks();
-		revertToDelta = true;
+	const MidiFile& mf = *this;
+	return mf.getFileDurationInSeconds();
+}
+
+
+double MidiFile::getFileDurationInSeconds(void) const {
+	if (m_timemapvalid == 0) {
+		return -1.0;
 	}
 	const MidiFile& mf = *this;
 	double output = 0.0;
 	for (int i=0; i<mf.getTrackCount(); i++) {
-		if (mf[i].back().tick > output) {
+		if (mf[i].size() == 0) {
+			continue;
+		}
+		if (mf[i].back().seconds > output) {
 			output = mf[i].back().seconds;
 		}
 	}
-	if (revertToDelta) {
-		deltaTicks();
-	}
 	return output;
 }
 
 
+
+//////////////////////////////
+//
+// MidiFile::freeze -- Prepare the MidiFile for read-only use by several
+//    threads at the same time: the file is converted to absolute ticks,
+//    the time in seconds of every event is calculated, note pairs
+//    are linked and the note index is built.  After this, the const
+//    query functions (such as getTimeInSeconds(), getAbsoluteTickTime()
+//    and the getFileDuration*() functions) and the NoteIndex returned
+//    by getNoteIndex() only read data, so they can be
+//    called on a const reference to the MidiFile from any number of
+//    threads without locking.  The MidiFile must not be modified while
+//    it is being shared.
+//
+
+void MidiFile::freeze(void) {
+	makeAbsoluteTicks();
+	buildTimeMap();
+	if (!m_linkedEventsQ) {
+		linkNotePairs();
+	}
+	getNoteIndex();
+	m_frozenQ = true;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::isFrozen -- Returns true if freeze() has been called and the
+//    MidiFile has not been changed since in a way that requires the
+//    analysis to be done again (such as adding events or switching to
+//    delta ticks).
+//
+
+bool MidiFile::isFrozen(void) const {
+	return m_frozenQ && m_timemapvalid && m_linkedEventsQ && isAbsoluteTicks();
+}
+
+
 ///////////////////////////////////////////////////////////////////////////
 //
 // physical-time analysis functions --
@@ -1335,7 +1397,9 @@ void MidiFile::doTimeAnalysis(void) {
 //////////////////////////////
 //
 // MidiFile::getTimeInSeconds -- return the time in seconds for
-//     the current message.
+//     the current message.  The const versions return -1.0 if the
+//     time analysis has not been done (see freeze() and
+//     doTimeAnalysis()).
 //
 
 double MidiFile::getTimeInSeconds(int aTrack, int anIndex) {
@@ -1343,6 +1407,11 @@ double MidiFile::getTimeInSeconds(int aTrack, int anIndex) {
 }
 
 
+double MidiFile::getTimeInSeconds(int aTrack, int anIndex) const {
+	return getTimeInSeconds(getEvent(aTrack, anIndex).tick);
+}
+
+
 double MidiFile::getTimeInSeconds(int tickvalue) {
 	if (m_timemapvalid == 0) {
 		buildTimeMap();
@@ -1350,6 +1419,15 @@ double MidiFile::getTimeInSeconds(int tickvalue) {
 			return -1.0;    // something went wrong
 		}
 	}
+	const MidiFile& mf = *this;
+	return mf.getTimeInSeconds(tickvalue);
+}
+
+
+double MidiFile::getTimeInSeconds(int tickvalue) const {
+	if (m_timemapvalid == 0) {
+		return -1.0;
+	}
 
 	_TickTime key;
 	key.tick    = tickvalue;
@@ -1364,7 +1442,6 @@ double MidiFile::getTimeInSeconds(int tickvalue) {
 		// after the tick value, and do a linear interpolation of
 		// the time in seconds values to figure out the final
 		// time in seconds.
-		// Since the code is not yet written, kill the program at this point:
 		return linearSecondInterpolationAtTick(tickvalue);
 	} else {
 		return ((_TickTime*)ptr)->seconds;
@@ -1378,17 +1455,26 @@ double MidiFile::getTimeInSeconds(int tickvalue) {
 // MidiFile::getAbsoluteTickTime -- return the tick value represented
 //    by the input time in seconds.  If there is not tick entry at
 //    the given time in seconds, then interpolate between two values.
+//    The const version returns -1.0 if the time analysis has not been
+//    done.
 //
 
 double MidiFile::getAbsoluteTickTime(double starttime) {
 	if (m_timemapvalid == 0) {
 		buildTimeMap();
 		if (m_timemapvalid == 0) {
-			if (m_timemapvalid == 0) {
-				return -1.0;    // something went wrong
-			}
+			return -1.0;    // something went wrong
 		}
 	}
+	const MidiFile& mf = *this;
+	return mf.getAbsoluteTickTime(starttime);
+}
+
+
+double MidiFile::getAbsoluteTickTime(double starttime) const {
+	if (m_timemapvalid == 0) {
+		return -1.0;
+	}
 
 	_TickTime key;
 	key.tick    = -1;
@@ -1401,7 +1487,7 @@ double MidiFile::getAbsoluteTickTime(double starttime) {
 		// The specific seconds value was not found, so do a linear
 		// search for the two time values which occur before and
 		// after the given time value, and do a linear interpolation of
-		// the time in tick values to figure out the final time in ticks.
+		// the time in ticks values to figure out the final time in ticks.
 		return linearTickInterpolationAtSecond(starttime);
 	} else {
 		return ((_TickTime*)ptr)->tick;
@@ -1420,18 +1506,20 @@ double MidiFile::getAbsoluteTickTime(double starttime) {
 //
 // MidiFile::linkNotePairs --  Link note-ons to note-offs separately
 //     for each track.  Returns the total number of note message pairs
-//     that were linked.
+//     that were linked.  A NoteLinker can be given to select how
+//     overlapping notes on the same key are paired, and to find the
+//     notes which could not be paired (see NoteLinker).
 //
 
 int MidiFile::linkNotePairs(void) {
-	int i;
-	int sum = 0;
-	for (i=0; i<getTrackCount(); i++) {
-		if (m_events[i] == NULL) {
-			continue;
-		}
-		sum += m_events[i]->linkNotePairs();
-	}
+	NoteLinker linker;
+	return linkNotePairs(linker);
+}
+
+
+int MidiFile::linkNotePairs(NoteLinker& linker) {
+	clearNoteIndex();
+	int sum = linker.link(*this);
 	m_linkedEventsQ = true;
 	return sum;
 }
@@ -1530,6 +1618,28 @@ MidiEvent* MidiFile::addEvent(int aTrack, MidiEvent& mfevent) {
 
 
 
+//////////////////////////////
+//
+// MidiFile::addEvents_no_copy -- Append a batch of events, which were
+//    allocated with new, to a track.  The MidiFile takes ownership of the
+//    events, and the events vector is cleared.
+//
+
+void MidiFile::addEvents_no_copy(int aTrack, std::vector<MidiEvent*>& events) {
+	if (events.empty()) {
+		return;
+	}
+	m_timemapvalid = 0;
+	MidiEventList& list = *m_events.at(aTrack);
+	for (MidiEvent* event : events) {
+		event->track = aTrack;
+		list.push_back_no_copy(event);
+	}
+	events.clear();
+}
+
+
+
 ///////////////////////////////
 //
 // MidiFile::addMetaEvent --
@@ -2061,6 +2171,7 @@ void MidiFile::allocateEvents(int track, int aSize) {
 //
 
 void MidiFile::deleteTrack(int aTrack) {
+	clearNoteIndex();
 	int length = getNumTracks();
 	if (aTrack < 0 || aTrack >= length) {
 		return;
@@ -2095,6 +2206,7 @@ void MidiFile::clear(void) {
 	m_events[0] = new MidiEventList;
 	m_timemapvalid=0;
 	m_timemap.clear();
+	clearNoteIndex();
 	m_theTrackState = TRACK_STATE_SPLIT;
 	m_theTimeState = TIME_STATE_ABSOLUTE;
 }
@@ -2168,6 +2280,44 @@ int MidiFile::getNumEvents(int aTrack) const {
 
 
 
+//////////////////////////////
+//
+// MidiFile::eventsInRange -- Return the index range of the events in a
+//     track with a tick time at or after starttick and before endtick.
+//     The first index of the returned pair is the first event in the
+//     range, and the second index is one past the last event (the two are
+//     equal if there are no events in the range).  In absolute tick mode
+//     the range is found with a binary search if the track is sorted (see
+//     MidiEventList::isSorted()).  In delta tick mode the absolute times
+//     are summed from the start of the track.
+//
+
+std::pair<int, int> MidiFile::eventsInRange(int aTrack, int starttick,
+		int endtick) const {
+	const MidiEventList& events = *m_events[aTrack];
+	if (isAbsoluteTicks()) {
+		int first = events.lowerBound(starttick);
+		int last  = std::max(first, events.lowerBound(endtick));
+		return std::make_pair(first, last);
+	}
+
+	int count = events.size();
+	int first = count;
+	int tick = 0;
+	for (int i=0; i<count; i++) {
+		tick += events[i].tick;
+		if ((first == count) && (tick >= starttick)) {
+			first = i;
+		}
+		if (tick >= endtick) {
+			return std::make_pair(first, std::max(first, i));
+		}
+	}
+	return std::make_pair(first, count);
+}
+
+
+
 //////////////////////////////
 //
 // MidiFile::mergeTracks -- combine the data from two
@@ -2179,6 +2329,7 @@ int MidiFile::getNumEvents(int aTrack) const {
 //
 
 void MidiFile::mergeTracks(int aTrack1, int aTrack2) {
+	clearNoteIndex();
 	MidiEventList* mergedTrack;
 	mergedTrack = new MidiEventList;
 	int oldTimeState = getTickState();
@@ -2256,6 +2407,123 @@ void MidiFile::setMillisecondTicks(void) {
 
 
 
+//////////////////////////////
+//
+// MidiFile::rescaleTicks -- Change the ticks per quarter note of the file
+//    and adjust all timestamps so that the timing of events (in quarter
+//    notes and seconds) stays the same.  Timestamps are rounded to the
+//    nearest new tick, and note-offs are kept after their note-ons.
+//
+
+void MidiFile::rescaleTicks(int newtpq) {
+	int tpq = getTicksPerQuarterNote();
+	if ((newtpq <= 0) || (tpq <= 0)) {
+		std::cerr << "Warning: invalid TPQ for rescaling: " << newtpq << std::endl;
+		return;
+	}
+	if (newtpq != tpq) {
+		scaleTicks(newtpq, tpq);
+	}
+	setTicksPerQuarterNote(newtpq);
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::stretch -- Multiply all timestamps by the given factor.  If
+//    preserveTime is false, then the duration of the file in seconds is
+//    scaled by the factor.  If preserveTime is true, then tempo messages
+//    are adjusted by the inverse factor so that events occur at the same
+//    time in seconds as before (only their positions in beats change).
+//    The factor is rounded to six decimal places.
+//    default value: preserveTime = false
+//
+
+void MidiFile::stretch(double factor, bool preserveTime) {
+	if (factor <= 0.0) {
+		std::cerr << "Warning: invalid stretch factor: " << factor << std::endl;
+		return;
+	}
+	long long denominator = 1000000;
+	long long numerator   = (long long)(factor * denominator + 0.5);
+	if (numerator <= 0) {
+		numerator = 1;
+	}
+	if (numerator != denominator) {
+		scaleTicks(numerator, denominator);
+	}
+	if (preserveTime) {
+		stretchTempo((double)denominator / (double)numerator);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::stretchTempo -- Multiply the duration of all tempo messages
+//    (microseconds per quarter note) by the given factor, which scales
+//    the duration of the file in seconds without changing any timestamps.
+//    If the file does not start with a tempo message, one is added to
+//    the first track for the default tempo of 120 bpm.
+//
+
+void MidiFile::stretchTempo(double factor) {
+	if (factor <= 0.0) {
+		std::cerr << "Warning: invalid tempo stretch factor: " << factor << std::endl;
+		return;
+	}
+	clearNoteIndex();
+	int oldTimeState = getTickState();
+	if (oldTimeState == TIME_STATE_DELTA) {
+		makeAbsoluteTicks();
+	}
+
+	bool initialTempo = false;
+	for (int i=0; i<getTrackCount(); i++) {
+		MidiEventList& list = *m_events[i];
+		for (int j=0; j<list.size(); j++) {
+			MidiEvent& event = list[j];
+			if (!event.isTempo()) {
+				continue;
+			}
+			if (event.tick == 0) {
+				initialTempo = true;
+			}
+			double microseconds = event.getTempoMicroseconds() * factor + 0.5;
+			if (microseconds > 0xffffff) {
+				microseconds = 0xffffff;
+			} else if (microseconds < 1) {
+				microseconds = 1;
+			}
+			event.setTempoMicroseconds((int)microseconds);
+		}
+	}
+
+	if (!initialTempo) {
+		double microseconds = 500000 * factor + 0.5;
+		if (microseconds > 0xffffff) {
+			microseconds = 0xffffff;
+		} else if (microseconds < 1) {
+			microseconds = 1;
+		}
+		MidiEvent* me = new MidiEvent;
+		me->setTempoMicroseconds((int)microseconds);
+		me->tick = 0;
+		me->track = 0;
+		m_events[0]->push_back_no_copy(me);
+		m_events[0]->sort();
+	}
+
+	if (oldTimeState == TIME_STATE_DELTA) {
+		makeDeltaTicks();
+	}
+	m_timemapvalid = 0;
+}
+
+
+
 //////////////////////////////
 //
 // MidiFile::sortTrack -- Sort the specified track in tick order.
@@ -2330,6 +2598,35 @@ void MidiFile::clearLinks(void) {
 		m_events[i]->clearLinks();
 	}
 	m_linkedEventsQ = false;
+	clearNoteIndex();
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::getNoteIndex -- Return an index of the linked notes in the
+//     file, for finding the notes which are sounding at a given time
+//     (see NoteIndex).  The index is built the first time it is needed,
+//     linking the note pairs and doing the time analysis if they have
+//     not been done, and is kept until the links, timing or events of
+//     the file are changed by the MidiFile.  The index refers to the
+//     events in the file, so it must not be used after the file is
+//     changed.  freeze() builds the index, so that it can be read by
+//     several threads.
+//
+
+const NoteIndex& MidiFile::getNoteIndex(void) {
+	if (m_noteindex == NULL) {
+		if (!m_linkedEventsQ) {
+			linkNotePairs();
+		}
+		if (m_timemapvalid == 0) {
+			doTimeAnalysis();
+		}
+		m_noteindex = new NoteIndex(*this);
+	}
+	return *m_noteindex;
 }
 
 
@@ -2345,12 +2642,9 @@ void MidiFile::clearLinks(void) {
 //    given input time.
 //
 
-double MidiFile::linearTickInterpolationAtSecond(double seconds) {
+double MidiFile::linearTickInterpolationAtSecond(double seconds) const {
 	if (m_timemapvalid == 0) {
-		buildTimeMap();
-		if (m_timemapvalid == 0) {
-			return -1.0;    // something went wrong
-		}
+		return -1.0;
 	}
 
 	int i;
@@ -2413,12 +2707,9 @@ double MidiFile::linearTickInterpolationAtSecond(double seconds) {
 //    value at the given input tick time. (Ticks input could be made double).
 //
 
-double MidiFile::linearSecondInterpolationAtTick(int ticktime) {
+double MidiFile::linearSecondInterpolationAtTick(int ticktime) const {
 	if (m_timemapvalid == 0) {
-		buildTimeMap();
-		if (m_timemapvalid == 0) {
-			return -1.0;    // something went wrong
-		}
+		return -1.0;
 	}
 
 	int i;
@@ -2490,22 +2781,40 @@ double MidiFile::linearSecondInterpolationAtTick(int ticktime) {
 //      a time map for SMPTE ticks, and just calculate the time in
 //      seconds from the tick value (1000 ticks per second SMPTE
 //      is the only mode tested (25 frames per second and 40 subframes
-//      per frame).
+//      per frame).  Tracks are visited in time order with a TrackMerger,
+//      so the MidiFile is only joined and sorted (and then restored to
+//      its previous state) if a track is out of time order.
 //
 
 void MidiFile::buildTimeMap(void) {
+	clearNoteIndex();
 
-	// convert the MIDI file to absolute time representation
-	// in single track mode (and undo if the MIDI file was not
-	// in that state when this function was called.
-	//
 	int trackstate = getTrackState();
 	int timestate  = getTickState();
 
-	makeAbsoluteTicks();
-	joinTracks();
+	bool sortedQ = true;
+	for (int i=0; (i<getTrackCount()) && sortedQ; i++) {
+		MidiEventList& events = operator[](i);
+		for (int j=1; j<events.size(); j++) {
+			if ((timestate == TIME_STATE_DELTA) ? (events[j].tick < 0) :
+					(events[j].tick < events[j-1].tick)) {
+				sortedQ = false;
+				break;
+			}
+		}
+	}
+	if (!sortedQ) {
+		// convert the MIDI file to absolute time representation
+		// in single track mode (and undo if the MIDI file was not
+		// in that state when this function was called.
+		makeAbsoluteTicks();
+		joinTracks();
+	}
 
-	int allocsize = getNumEvents(0);
+	int allocsize = 0;
+	for (int i=0; i<getTrackCount(); i++) {
+		allocsize += getNumEvents(i);
+	}
 	m_timemap.reserve(allocsize+10);
 	m_timemap.clear();
 
@@ -2514,7 +2823,6 @@ void MidiFile::buildTimeMap(void) {
 	int lasttick = 0;
 	int tickinit = 0;
 
-	int i;
 	int tpq = getTicksPerQuarterNote();
 	double defaultTempo = 120.0;
 	double secondsPerTick = 60.0 / (defaultTempo * tpq);
@@ -2522,15 +2830,17 @@ void MidiFile::buildTimeMap(void) {
 	double lastsec = 0.0;
 	double cursec = 0.0;
 
-	for (i=0; i<getNumEvents(0); i++) {
-		int curtick = getEvent(0, i).tick;
-		getEvent(0, i).seconds = cursec;
+	TrackMerger merger(*this);
+	while (merger.next()) {
+		MidiEvent& event = operator[](merger.getTrack())[merger.getIndex()];
+		int curtick = merger.getTick();
+		event.seconds = cursec;
 		if ((curtick > lasttick) || !tickinit) {
 			tickinit = 1;
 
 			// calculate the current time in seconds:
 			cursec = lastsec + (curtick - lasttick) * secondsPerTick;
-			getEvent(0, i).seconds = cursec;
+			event.seconds = cursec;
 
 			// store the new tick to second mapping
 			value.tick = curtick;
@@ -2541,17 +2851,19 @@ void MidiFile::buildTimeMap(void) {
 		}
 
 		// update the tempo if needed:
-		if (getEvent(0,i).isTempo()) {
-			secondsPerTick = getEvent(0,i).getTempoSPT(getTicksPerQuarterNote());
+		if (event.isTempo()) {
+			secondsPerTick = event.getTempoSPT(getTicksPerQuarterNote());
 		}
 	}
 
 	// reset the states of the tracks or time values if necessary here:
-	if (timestate == TIME_STATE_DELTA) {
-		deltaTicks();
-	}
-	if (trackstate == TRACK_STATE_SPLIT) {
-		splitTracks();
+	if (!sortedQ) {
+		if (timestate == TIME_STATE_DELTA) {
+			deltaTicks();
+		}
+		if (trackstate == TRACK_STATE_SPLIT) {
+			splitTracks();
+		}
 	}
 
 	m_timemapvalid = 1;
@@ -2560,6 +2872,105 @@ void MidiFile::buildTimeMap(void) {
 
 
 
+//////////////////////////////
+//
+// MidiFile::clearNoteIndex -- Delete the cached note index, so that
+//     getNoteIndex() builds it again.
+//
+
+void MidiFile::clearNoteIndex(void) {
+	if (m_noteindex != NULL) {
+		delete m_noteindex;
+		m_noteindex = NULL;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::scaleTicks -- Multiply all absolute timestamps by the ratio
+//    numerator/denominator, rounding to the nearest integer tick.  The
+//    rounding is done from absolute tick positions in integer arithmetic,
+//    so there is no accumulated drift, and the ordering of events in
+//    each track is unchanged.  If a note-off would be rounded onto the
+//    tick of its note-on, it is moved one tick later so that the note
+//    keeps a non-zero duration.  Note pairs are linked if that has not
+//    already been done.  Tracks are processed in parallel for large files.
+//
+
+void MidiFile::scaleTicks(long long numerator, long long denominator) {
+	clearNoteIndex();
+	int oldTimeState = getTickState();
+	if (oldTimeState == TIME_STATE_DELTA) {
+		makeAbsoluteTicks();
+	}
+
+	int eventcount = 0;
+	for (int i=0; i<getTrackCount(); i++) {
+		eventcount += m_events[i]->size();
+	}
+
+	bool linkQ = !m_linkedEventsQ;
+	long long num2 = numerator * 2;
+	long long den2 = denominator * 2;
+
+	parallelFor(getTrackCount(), eventcount, [&](int track) {
+		MidiEventList& list = *m_events[track];
+		int count = list.size();
+		if (linkQ) {
+			list.linkNotePairs();
+		}
+
+		// gather the timestamps into contiguous storage so that the
+		// scaling loop can be vectorized:
+		std::vector<long long> ticks(count);
+		for (int i=0; i<count; i++) {
+			ticks[i] = list[i].tick;
+		}
+		for (int i=0; i<count; i++) {
+			ticks[i] = (ticks[i] * num2 + denominator) / den2;
+		}
+
+		// keep linked note-offs after their note-ons:
+		std::vector<std::pair<MidiEvent*, int>> adjustments;
+		for (int i=0; i<count; i++) {
+			MidiEvent& event = list[i];
+			if (!event.isNoteOn()) {
+				continue;
+			}
+			MidiEvent* noteoff = event.getLinkedEvent();
+			if ((noteoff == NULL) || (noteoff->tick <= event.tick)) {
+				continue;
+			}
+			long long offtick = (noteoff->tick * num2 + denominator) / den2;
+			if (offtick <= ticks[i]) {
+				adjustments.emplace_back(noteoff, (int)ticks[i] + 1);
+			}
+		}
+
+		for (int i=0; i<count; i++) {
+			list[i].tick = (int)ticks[i];
+		}
+		if (!adjustments.empty()) {
+			for (auto& item : adjustments) {
+				item.first->tick = item.second;
+			}
+			list.sort();
+		}
+	});
+
+	if (linkQ) {
+		m_linkedEventsQ = true;
+	}
+	if (oldTimeState == TIME_STATE_DELTA) {
+		makeDeltaTicks();
+	}
+	m_timemapvalid = 0;
+}
+
+
+
 //////////////////////////////
 //
 // MidiFile::extractMidiData -- Extract MIDI data from input
@@ -3172,3 +3583,43 @@ std::ostream& operator<<(std::ostream& out, smf::MidiFile& aMidiFile) {
 
 
 
+//////////////////////////////
+//
+// parallelFor -- Call the given function once for each index from 0 to
+//    count-1.  When the workload (such as the number of MIDI events to
+//    process) is large enough to make it worthwhile, the indexes are
+//    distributed over multiple threads.  The function must only modify
+//    data belonging to the index that it is given.
+//
+
+void smf::parallelFor(int count, int workload,
+		const std::function<void(int)>& function) {
+	int threadcount = (int)std::thread::hardware_concurrency();
+	if (threadcount > count) {
+		threadcount = count;
+	}
+	if ((threadcount < 2) || (workload < 100000)) {
+		for (int i=0; i<count; i++) {
+			function(i);
+		}
+		return;
+	}
+
+	std::atomic<int> next(0);
+	std::vector<std::thread> threads;
+	threads.reserve(threadcount);
+	for (int i=0; i<threadcount; i++) {
+		threads.emplace_back([&]() {
+			int index;
+			while ((index = next++) < count) {
+				function(index);
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+}
+
+
+
@@ -0,0 +1,512 @@
+//
+// Creation Date: Mon Oct 19 16:20:31 PDT 2026
+// Filename:      midifile/src-library/MidiPlayer.cpp
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Real-time playback of a MidiFile.  The time in seconds
+//                of every event is calculated in advance from the tempo
+//                map, and a timing thread waits for the absolute
+//                deadline of each event (so timing errors do not
+//                accumulate).  Events are passed through a lock-free
+//                single-producer/single-consumer queue to a second
+//                thread which sends them to a MidiSink, so slow output
+//                does not delay the timing thread.
+//
+
+#include "MidiPlayer.h"
+#include "TrackMerger.h"
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#ifdef __linux__
+	#include <time.h>
+	#include <errno.h>
+	#include <pthread.h>
+#endif
+
+
+namespace smf {
+
+// Longest time to sleep before checking if playback has been stopped.
+#define PLAYER_STOP_CHECK 50000000LL
+
+//////////////////////////////
+//
+// getNanoseconds -- Return the current time of a monotonic clock.
+//
+
+static long long getNanoseconds(void) {
+#ifdef __linux__
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#else
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+
+
+//////////////////////////////
+//
+// sleepUntil -- Wait until the monotonic clock reaches the given time.
+//     Sleeping to an absolute time rather than for a duration means that
+//     wake-up delays do not add up over the course of playback.
+//
+
+static void sleepUntil(long long nanoseconds) {
+#ifdef __linux__
+	struct timespec ts;
+	ts.tv_sec  = (time_t)(nanoseconds / 1000000000LL);
+	ts.tv_nsec = (long)(nanoseconds % 1000000000LL);
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+		// interrupted by a signal: keep waiting
+	}
+#else
+	std::this_thread::sleep_until(std::chrono::steady_clock::time_point(
+			std::chrono::nanoseconds(nanoseconds)));
+#endif
+}
+
+
+
+//////////////////////////////
+//
+// MidiPlayer::MidiPlayer -- Constructor.
+//
+
+MidiPlayer::MidiPlayer(void) : m_head(0), m_tail(0), m_doneQ(false),
+		m_stopQ(false), m_playingQ(false) {
+	m_queue.resize(PLAYER_QUEUE_SIZE);
+}
+
+
+MidiPlayer::MidiPlayer(MidiFile& midifile) : m_head(0), m_tail(0),
+		m_doneQ(false), m_stopQ(false), m_playingQ(false) {
+	m_queue.resize(PLAYER_QUEUE_SIZE);
+	load(midifile);
+}
+
+
+
+//////////////////////////////
+//
+// MidiPlayer::~MidiPlayer -- Deconstructor.  Playback is stopped if
+//     it is still running.
+//
+
+MidiPlayer::~MidiPlayer() {
+	stop();
+}
+
+
+
+//////////////////////////////
+//
+// MidiPlayer::load -- Calculate the playback schedule for a MIDI file:
+//     the time in seconds of every event in all tracks is calculated from
+//     the tempo map, and the events are merged into a single list in time
+//     order (the order of joinTracks(), without modifying the tracks).
+//     Meta messages are not included.  The MidiFile is not needed after
+//     this function is called.
+//
+
+void MidiPlayer::load(MidiFile& midifile) {
+	clear();
+	midifile.doTimeAnalysis();
+
+	int count = 0;
+	for (int i=0; i<midifile.getTrackCount(); i++) {
+		count += midifile[i].size();
+	}
+	m_schedule.reserve(count);
+	TrackMerger merger(midifile);
+	while (merger.next()) {
+		const MidiEvent& event = merger.getEvent();
+		if (event.empty() || event.isMetaMessage()) {
+			continue;
+		}
+		m_schedule.push_back(event);
+		m_schedule.back().track = merger.getTrack();
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiPlayer::clear -- Remove the playback schedule (stopping playback
+//     if necessary).
+//
+
+void MidiPlayer::clear(void) {
+	stop();
+	m_schedule.clear();
+}
+
+
+
+//////////////////////////////
+//
+// MidiPlayer::getEventCount -- Return the number of events to be played.
+//
+
+int MidiPlayer::getEventCount(void) const {
+	return (int)m_schedule.size();
+}
+
+
+
+//////////////////////////////
+//
+// MidiPlayer::getDuration -- Return the time in seconds of the last event
+//     at normal speed.
+//
+
+double MidiPlayer::getDuration(void) const {
+	if (m_schedule.empty()) {
+		return 0.0;
+	}
+	return m_schedule.back().seconds;
+}
+
+
+
+//////////////////////////////
+//
+// MidiPlayer::setSink -- Set where events are sent to.  The sink is
+//     not owned by the player, and must not be changed during playback.
+//
+
+void MidiPlayer::setSink(MidiSink* sink) {
+	if (isPlaying()) {
+		std::cerr << "Warning: cannot change sink during playback." << std::endl;
+		return;
+	}
+	m_sink = sink;
+}
+
+
+
+//////////////////////////////
+//
+// MidiPlayer::setSpeed -- Set the playback speed, where 1.0 is normal
+//     speed and 2.0 is twice as fast.  Must be set before playback starts.
+//
+
+void MidiPlayer::setSpeed(double factor) {
+	if (factor > 0.0) {
+		m_speed = factor;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiPlayer::getSpeed -- Return the playback speed.
+//
+
+double MidiPlayer::getSpeed(void) const {
+	return m_speed;
+}
+
+
+
+//////////////////////////////
+//
+// MidiPlayer::play -- Play all events and return when finished (or
+//     when stopped from another thread).
+//
+
+bool MidiPlayer::play(void) {
+	if (!start()) {
+		return false;
+	}
+	wait();
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// MidiPlayer::start -- Start playback in the background.  Returns false
+//     if there is no sink or if playback is already running.
+//
+
+bool MidiPlayer::start(void) {
+	if (m_sink == NULL) {
+		std::cerr << "Error: no sink for MIDI playback." << std::endl;
+		return false;
+	}
+	if (m_timer.joinable() || m_sender.joinable()) {
+		std::cerr << "Error: playback has already been started." << std::endl;
+		return false;
+	}
+
+	m_head = 0;
+	m_tail = 0;
+	m_doneQ = false;
+	m_stopQ = false;
+	m_playingQ = true;
+	m_jitterCount = 0;
+	m_jitterSum   = 0.0;
+	m_jitterSum2  = 0.0;
+	m_jitterMin   = 0;
+	m_jitterMax   = 0;
+	m_overruns    = 0;
+
+	// leave a little time to start the threads before the first event:
+	long long startns = getNanoseconds() + 1000000LL;
+	m_timer  = std::thread(&MidiPlayer::runTimer, this, startns);
+	m_sender = std::thread(&MidiPlayer::runSender, this, startns);
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// MidiPlayer::stop -- Stop playback and wait for the threads to finish.
+//     Events which are already in the queue are still sent to the sink.
+//
+
+void MidiPlayer::stop(void) {
+	m_stopQ = true;
+	wait();
+}
+
+
+
+//////////////////////////////
+//
+// MidiPlayer::wait -- Wait for playback to finish.
+//
+
+void MidiPlayer::wait(void) {
+	if (m_timer.joinable()) {
+		m_timer.join();
+	}
+	if (m_sender.joinable()) {
+		m_sender.join();
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiPlayer::isPlaying -- Returns true if events are still being sent.
+//
+
+bool MidiPlayer::isPlaying(void) const {
+	return m_playingQ;
+}
+
+
+
+//////////////////////////////
+//
+// MidiPlayer::getJitterCount -- Return the number of events timed in the
+//     last playback.  The jitter statistics are only valid once playback
+//     has finished.
+//
+
+int MidiPlayer::getJitterCount(void) const {
+	return m_jitterCount;
+}
+
+
+
+//////////////////////////////
+//
+// MidiPlayer::getMeanJitter -- Return the average time in seconds
+//     between the deadline of an event and when it was dispatched.
+//
+
+double MidiPlayer::getMeanJitter(void) const {
+	if (m_jitterCount == 0) {
+		return 0.0;
+	}
+	return m_jitterSum / m_jitterCount / 1.0e9;
+}
+
+
+
+//////////////////////////////
+//
+// MidiPlayer::getMinJitter -- Return the smallest dispatch delay in
+//     seconds.
+//
+
+double MidiPlayer::getMinJitter(void) const {
+	return m_jitterMin / 1.0e9;
+}
+
+
+
+//////////////////////////////
+//
+// MidiPlayer::getMaxJitter -- Return the largest dispatch delay in seconds.
+//
+
+double MidiPlayer::getMaxJitter(void) const {
+	return m_jitterMax / 1.0e9;
+}
+
+
+
+//////////////////////////////
+//
+// MidiPlayer::getJitterDeviation -- Return the standard deviation of the
+//     dispatch delays in seconds.
+//
+
+double MidiPlayer::getJitterDeviation(void) const {
+	if (m_jitterCount == 0) {
+		return 0.0;
+	}
+	double mean = m_jitterSum / m_jitterCount;
+	double variance = m_jitterSum2 / m_jitterCount - mean * mean;
+	if (variance < 0.0) {
+		variance = 0.0;
+	}
+	return std::sqrt(variance) / 1.0e9;
+}
+
+
+
+//////////////////////////////
+//
+// MidiPlayer::getOverrunCount -- Return the number of times that the
+//     timing thread had to wait for space in the queue because the sink
+//     was too slow.
+//
+
+int MidiPlayer::getOverrunCount(void) const {
+	return m_overruns;
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//
+// private functions
+//
+
+//////////////////////////////
+//
+// MidiPlayer::runTimer -- Timing thread: wait for the deadline of each
+//    event and then add it to the queue.
+//
+
+void MidiPlayer::runTimer(long long startns) {
+#ifdef __linux__
+	// Use real-time scheduling if permitted (ignored otherwise).
+	struct sched_param param;
+	param.sched_priority = sched_get_priority_max(SCHED_FIFO);
+	pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+#endif
+
+	const unsigned mask = PLAYER_QUEUE_SIZE - 1;
+	int count = (int)m_schedule.size();
+	for (int i=0; i<count; i++) {
+		long long deadline = startns +
+				(long long)std::llround(m_schedule[i].seconds / m_speed * 1.0e9);
+		long long now = getNanoseconds();
+		while ((now < deadline) && !m_stopQ) {
+			sleepUntil(std::min(deadline, now + PLAYER_STOP_CHECK));
+			now = getNanoseconds();
+		}
+		if (m_stopQ) {
+			break;
+		}
+
+		long long jitter = now - deadline;
+		if ((m_jitterCount == 0) || (jitter < m_jitterMin)) {
+			m_jitterMin = jitter;
+		}
+		if ((m_jitterCount == 0) || (jitter > m_jitterMax)) {
+			m_jitterMax = jitter;
+		}
+		m_jitterSum  += (double)jitter;
+		m_jitterSum2 += (double)jitter * (double)jitter;
+		m_jitterCount++;
+
+		unsigned head = m_head.load(std::memory_order_relaxed);
+		if (head - m_tail.load(std::memory_order_acquire) >= PLAYER_QUEUE_SIZE) {
+			m_overruns++;
+			while ((head - m_tail.load(std::memory_order_acquire)
+					>= PLAYER_QUEUE_SIZE) && !m_stopQ) {
+				std::this_thread::yield();
+			}
+			if (m_stopQ) {
+				// The slot at head has not been sent yet.
+				break;
+			}
+		}
+		m_queue[head & mask].index   = i;
+		m_queue[head & mask].seconds = (now - startns) / 1.0e9;
+		m_head.store(head + 1, std::memory_order_release);
+	}
+	m_doneQ.store(true, std::memory_order_release);
+}
+
+
+
+//////////////////////////////
+//
+// MidiPlayer::runSender -- Sink thread: send queued events to the sink.
+//    Since the schedule is known, the thread sleeps until the next event
+//    is due instead of polling the queue.
+//
+
+void MidiPlayer::runSender(long long startns) {
+	const unsigned mask = PLAYER_QUEUE_SIZE - 1;
+	int next = 0;
+	int count = (int)m_schedule.size();
+	bool flushQ = false;
+	while (true) {
+		unsigned tail = m_tail.load(std::memory_order_relaxed);
+		if (tail == m_head.load(std::memory_order_acquire)) {
+			if (flushQ) {
+				m_sink->flush();
+				flushQ = false;
+			}
+			if (m_doneQ.load(std::memory_order_acquire)) {
+				if (tail == m_head.load(std::memory_order_acquire)) {
+					break;
+				}
+				continue;
+			}
+			long long now = getNanoseconds();
+			long long deadline = next < count ? startns +
+					(long long)std::llround(m_schedule[next].seconds / m_speed * 1.0e9)
+					: now;
+			if (deadline > now) {
+				sleepUntil(std::min(deadline, now + PLAYER_STOP_CHECK));
+			} else {
+				std::this_thread::yield();
+			}
+			continue;
+		}
+		const _QueueItem& item = m_queue[tail & mask];
+		m_sink->send(m_schedule[item.index], item.seconds);
+		next = item.index + 1;
+		flushQ = true;
+		m_tail.store(tail + 1, std::memory_order_release);
+	}
+	m_playingQ = false;
+}
+
+
+} // end namespace smf
+
+
+
@@ -0,0 +1,450 @@
+//
+// Creation Date: Tue Oct 20 10:05:47 PDT 2026
+// Filename:      midifile/src-library/MidiRecorder.cpp
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Record live MIDI input into a MidiFile.  A real-time
+//                input thread passes timestamped MIDI messages to
+//                record(), which copies them into a fixed-size ring
+//                buffer without locking or allocating memory.  A
+//                background thread converts the timestamps to ticks
+//                with the tempo map of the MidiFile and adds the events
+//                to its tracks in batches.
+//
+
+#include "MidiRecorder.h"
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+
+namespace smf {
+
+// Time for the background thread to wait when there is nothing to record.
+#define RECORDER_WAIT_MICROSECONDS 1000
+
+//////////////////////////////
+//
+// getNanoseconds -- Return the current time of the steady clock.
+//
+
+static long long getNanoseconds(void) {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+
+//////////////////////////////
+//
+// MidiRecorder::MidiRecorder -- Constructor.
+//
+
+MidiRecorder::MidiRecorder(void) : m_head(0), m_tail(0), m_stopQ(false),
+		m_recorded(0), m_dropped(0) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// MidiRecorder::~MidiRecorder -- Deconstructor.  Recording is stopped
+//     if it is still running.
+//
+
+MidiRecorder::~MidiRecorder() {
+	stop();
+}
+
+
+
+//////////////////////////////
+//
+// MidiRecorder::setCapacity -- Set the number of slots in the ring buffer
+//     (rounded up to a power of two).  Each slot holds a message of up to
+//     RECORDER_SLOT_BYTES bytes.  Default value is 65536.
+//
+
+void MidiRecorder::setCapacity(int slots) {
+	if (isRecording()) {
+		std::cerr << "Warning: cannot change capacity while recording." << std::endl;
+		return;
+	}
+	int capacity = 16;
+	while ((capacity < slots) && (capacity < (1 << 30))) {
+		capacity *= 2;
+	}
+	m_capacity = capacity;
+}
+
+
+
+//////////////////////////////
+//
+// MidiRecorder::getCapacity -- Return the number of slots in the ring
+//     buffer.
+//
+
+int MidiRecorder::getCapacity(void) const {
+	return m_capacity;
+}
+
+
+
+//////////////////////////////
+//
+// MidiRecorder::setTrack -- Set the track which recorded events are added
+//     to.  Default value is 0.
+//
+
+void MidiRecorder::setTrack(int track) {
+	m_track = track < 0 ? 0 : track;
+}
+
+
+
+//////////////////////////////
+//
+// MidiRecorder::getTrack -- Return the track for recorded events.
+//
+
+int MidiRecorder::getTrack(void) const {
+	return m_track;
+}
+
+
+
+//////////////////////////////
+//
+// MidiRecorder::setChannelTracks -- Add channel messages to track
+//     channel+1 (tracks 1-16) rather than to a single track.  Other
+//     messages are still added to the track given by setTrack().
+//
+
+void MidiRecorder::setChannelTracks(bool state) {
+	m_channelTracksQ = state;
+}
+
+
+
+//////////////////////////////
+//
+// MidiRecorder::start -- Start recording into a MidiFile.  The tempo map
+//     of the file at this point is used to convert times to ticks.  The
+//     MidiFile must not be accessed until stop() is called.  Returns
+//     false if recording has already been started.
+//
+
+bool MidiRecorder::start(MidiFile& midifile) {
+	if (isRecording()) {
+		std::cerr << "Error: recording has already been started." << std::endl;
+		return false;
+	}
+
+	m_midifile = &midifile;
+	if (midifile.getTrackState() == TRACK_STATE_JOINED) {
+		midifile.splitTracks();
+	}
+	midifile.absoluteTicks();
+	int tracks = std::max(m_track + 1, m_channelTracksQ ? 17 : 0);
+	if (midifile.getTrackCount() < tracks) {
+		midifile.addTracks(tracks - midifile.getTrackCount());
+	}
+	buildTempoMap();
+
+	m_slots.resize(m_capacity);
+	m_head = 0;
+	m_tail = 0;
+	m_recorded = 0;
+	m_dropped = 0;
+	m_stopQ = false;
+	m_startTime = getNanoseconds();
+	m_thread = std::thread(&MidiRecorder::run, this);
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// MidiRecorder::stop -- Stop recording.  Messages which are already in the
+//     ring buffer are added to the MidiFile first.  The tracks are then
+//     sorted if the messages were not recorded in time order.
+//
+
+void MidiRecorder::stop(void) {
+	if (!m_thread.joinable()) {
+		return;
+	}
+	m_stopQ = true;
+	m_thread.join();
+}
+
+
+
+//////////////////////////////
+//
+// MidiRecorder::isRecording -- Returns true between start() and stop().
+//
+
+bool MidiRecorder::isRecording(void) const {
+	return m_thread.joinable();
+}
+
+
+
+//////////////////////////////
+//
+// MidiRecorder::getTime -- Return the time in seconds since start() was
+//     called.
+//
+
+double MidiRecorder::getTime(void) const {
+	return (getNanoseconds() - m_startTime) / 1.0e9;
+}
+
+
+
+//////////////////////////////
+//
+// MidiRecorder::record -- Add a complete MIDI message (no running status)
+//     to the recording, with its time in seconds since start() was called.
+//     If no time is given, the current time is used.  This function does
+//     not wait or allocate memory, so it can be called from a real-time
+//     input thread (but only from one thread at a time).  Returns false
+//     if the message was dropped because the ring buffer is full.
+//
+
+bool MidiRecorder::record(const uchar* data, int size, double seconds) {
+	if ((size <= 0) || (m_slots.empty())) {
+		return false;
+	}
+	unsigned need = (unsigned)((size + RECORDER_SLOT_BYTES - 1) /
+			RECORDER_SLOT_BYTES);
+	unsigned head = m_head.load(std::memory_order_relaxed);
+	unsigned used = head - m_tail.load(std::memory_order_acquire);
+	if ((unsigned)m_capacity - used < need) {
+		m_dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	const unsigned mask = (unsigned)m_capacity - 1;
+	for (unsigned i=0; i<need; i++) {
+		_RecorderSlot& slot = m_slots[(head + i) & mask];
+		int count = std::min(size, RECORDER_SLOT_BYTES);
+		slot.seconds = seconds;
+		slot.size = (ushort)count;
+		slot.more = (i < need - 1) ? 1 : 0;
+		for (int j=0; j<count; j++) {
+			slot.data[j] = data[j];
+		}
+		data += count;
+		size -= count;
+	}
+	m_head.store(head + need, std::memory_order_release);
+	return true;
+}
+
+
+bool MidiRecorder::record(const uchar* data, int size) {
+	return record(data, size, getTime());
+}
+
+
+bool MidiRecorder::record(const MidiMessage& message, double seconds) {
+	return record(message.data(), (int)message.size(), seconds);
+}
+
+
+
+//////////////////////////////
+//
+// MidiRecorder::getRecordedCount -- Return the number of messages which
+//     have been added to the MidiFile.
+//
+
+int MidiRecorder::getRecordedCount(void) const {
+	return m_recorded;
+}
+
+
+
+//////////////////////////////
+//
+// MidiRecorder::getDroppedCount -- Return the number of messages which
+//     were lost because the ring buffer was full.
+//
+
+int MidiRecorder::getDroppedCount(void) const {
+	return m_dropped;
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//
+// private functions
+//
+
+//////////////////////////////
+//
+// MidiRecorder::run -- Background thread: move all waiting messages from
+//    the ring buffer into a local batch for each track, free their slots
+//    for the input thread, and then append each batch to its track in
+//    one call.  Then wait a short time for more messages.
+//
+
+void MidiRecorder::run(void) {
+	const unsigned mask = (unsigned)m_capacity - 1;
+	std::vector<std::vector<MidiEvent*>> batches(m_midifile->getTrackCount());
+	double lastseconds = 0.0;
+	int segment = 0;
+	bool sortQ = false;
+	bool doneQ = false;
+
+	// Recorded events which occur before existing events in the file
+	// (such as tempo changes) will require the tracks to be sorted.
+	int lasttick = 0;
+	for (int i=0; i<m_midifile->getTrackCount(); i++) {
+		MidiEventList& list = (*m_midifile)[i];
+		for (int j=0; j<list.size(); j++) {
+			lasttick = std::max(lasttick, list[j].tick);
+		}
+	}
+
+	while (!doneQ) {
+		// Check the stop flag before reading the head so that messages
+		// recorded before stop() are not missed.
+		doneQ = m_stopQ.load(std::memory_order_acquire);
+		unsigned head = m_head.load(std::memory_order_acquire);
+		unsigned tail = m_tail.load(std::memory_order_relaxed);
+		if (tail == head) {
+			if (!doneQ) {
+				std::this_thread::sleep_for(
+						std::chrono::microseconds(RECORDER_WAIT_MICROSECONDS));
+			}
+			continue;
+		}
+
+		int count = 0;
+		while (tail != head) {
+			MidiEvent* event = new MidiEvent;
+			double seconds = m_slots[tail & mask].seconds;
+			bool moreQ;
+			do {
+				const _RecorderSlot& slot = m_slots[tail & mask];
+				event->insert(event->end(), slot.data, slot.data + slot.size);
+				moreQ = slot.more != 0;
+				tail++;
+			} while (moreQ);
+
+			event->tick = getTick(seconds, segment);
+			if ((seconds < lastseconds) || (event->tick < lasttick)) {
+				sortQ = true;
+			}
+			lastseconds = seconds;
+			int track = m_track;
+			uchar status = (*event)[0];
+			if (m_channelTracksQ && (status >= 0x80) && (status < 0xf0)) {
+				track = (status & 0x0f) + 1;
+			}
+			batches[track].push_back(event);
+			count++;
+		}
+		// free the slots for the input thread before adding the events:
+		m_tail.store(tail, std::memory_order_release);
+		for (int i=0; i<(int)batches.size(); i++) {
+			m_midifile->addEvents_no_copy(i, batches[i]);
+		}
+		m_recorded.fetch_add(count, std::memory_order_relaxed);
+	}
+
+	if (sortQ) {
+		m_midifile->sortTracks();
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiRecorder::buildTempoMap -- Store the time in seconds and the tick
+//    of each tempo change in the MidiFile, along with the number of ticks
+//    per second until the next tempo change.  The default tempo is 120
+//    quarter notes per minute.
+//
+
+void MidiRecorder::buildTempoMap(void) {
+	MidiFile& midifile = *m_midifile;
+	double tpq = midifile.getTicksPerQuarterNote();
+
+	std::vector<std::pair<int, int>> tempos;
+	for (int i=0; i<midifile.getTrackCount(); i++) {
+		for (int j=0; j<midifile[i].size(); j++) {
+			if (midifile[i][j].isTempo()) {
+				tempos.emplace_back(midifile[i][j].tick,
+						midifile[i][j].getTempoMicroseconds());
+			}
+		}
+	}
+	std::stable_sort(tempos.begin(), tempos.end(),
+			[](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+				return a.first < b.first;
+			});
+
+	m_tempos.clear();
+	_TempoSegment segment;
+	segment.seconds = 0.0;
+	segment.tick = 0;
+	segment.rate = tpq * 1000000.0 / 500000.0;
+	m_tempos.push_back(segment);
+	for (auto& tempo : tempos) {
+		if (tempo.second <= 0) {
+			continue;
+		}
+		_TempoSegment& last = m_tempos.back();
+		segment.seconds = last.seconds + (tempo.first - last.tick) / last.rate;
+		segment.tick = tempo.first;
+		segment.rate = tpq * 1000000.0 / tempo.second;
+		if (segment.tick == last.tick) {
+			last = segment;
+		} else {
+			m_tempos.push_back(segment);
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiRecorder::getTick -- Convert a time in seconds into ticks.  The
+//    segment parameter is the tempo segment used for the previous
+//    conversion, so that conversions of increasing times take constant
+//    time.
+//
+
+int MidiRecorder::getTick(double seconds, int& segment) {
+	if (seconds < 0.0) {
+		seconds = 0.0;
+	}
+	int count = (int)m_tempos.size();
+	if ((segment >= count) || (seconds < m_tempos[segment].seconds)) {
+		segment = 0;
+	}
+	while ((segment + 1 < count) && (m_tempos[segment + 1].seconds <= seconds)) {
+		segment++;
+	}
+	const _TempoSegment& tempo = m_tempos[segment];
+	return tempo.tick + (int)std::llround((seconds - tempo.seconds) * tempo.rate);
+}
+
+
+} // end namespace smf
+
+
+
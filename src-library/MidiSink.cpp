@@ -0,0 +1,265 @@
+//
+// Creation Date: Mon Oct 19 16:20:31 PDT 2026
+// Filename:      midifile/src-library/MidiSink.cpp
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Destinations for MIDI events sent by MidiPlayer.
+//                MidiSink is the interface, MidiStreamSink writes raw
+//                MIDI bytes to a file, FIFO or device, and
+//                MidiRecorderSink stores the events in memory.
+//
+
+#include "MidiSink.h"
+
+#include <iostream>
+
+
+namespace smf {
+
+//////////////////////////////
+//
+// MidiSink::~MidiSink -- Deconstructor.
+//
+
+MidiSink::~MidiSink() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// MidiSink::flush -- Default behavior is to do nothing.
+//
+
+void MidiSink::flush(void) {
+	// do nothing
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//
+// MidiStreamSink
+//
+
+//////////////////////////////
+//
+// MidiStreamSink::MidiStreamSink -- Constructor.
+//
+
+MidiStreamSink::MidiStreamSink(void) {
+	// do nothing
+}
+
+
+MidiStreamSink::MidiStreamSink(std::ostream& out) {
+	open(out);
+}
+
+
+MidiStreamSink::MidiStreamSink(const std::string& filename) {
+	open(filename);
+}
+
+
+
+//////////////////////////////
+//
+// MidiStreamSink::~MidiStreamSink -- Deconstructor.
+//
+
+MidiStreamSink::~MidiStreamSink() {
+	close();
+}
+
+
+
+//////////////////////////////
+//
+// MidiStreamSink::open -- Write to a file (which can also be a named pipe
+//     or a raw MIDI device such as /dev/snd/midiC1D0), or to an already
+//     open stream.  Returns false if the file could not be opened.
+//
+
+bool MidiStreamSink::open(const std::string& filename) {
+	close();
+	m_file.open(filename.c_str(), std::ios::binary | std::ios::out);
+	if (!m_file.is_open()) {
+		std::cerr << "Error: could not open " << filename << " for writing"
+		          << std::endl;
+		return false;
+	}
+	m_out = &m_file;
+	return true;
+}
+
+
+void MidiStreamSink::open(std::ostream& out) {
+	close();
+	m_out = &out;
+}
+
+
+
+//////////////////////////////
+//
+// MidiStreamSink::close -- Stop writing to the output stream.
+//
+
+void MidiStreamSink::close(void) {
+	if (m_out != NULL) {
+		m_out->flush();
+	}
+	if (m_file.is_open()) {
+		m_file.close();
+	}
+	m_out = NULL;
+}
+
+
+
+//////////////////////////////
+//
+// MidiStreamSink::status -- Returns true if the output stream is open
+//     and there have been no write errors.
+//
+
+bool MidiStreamSink::status(void) const {
+	return (m_out != NULL) && !m_out->fail();
+}
+
+
+
+//////////////////////////////
+//
+// MidiStreamSink::send -- Write the raw MIDI bytes of an event.  Meta
+//     messages are not sent, and the 0xf7 marker at the start of raw
+//     system exclusive data is removed (as when writing a MIDI file).
+//
+
+void MidiStreamSink::send(const MidiEvent& event, double /*seconds*/) {
+	if ((m_out == NULL) || event.empty() || event.isMetaMessage()) {
+		return;
+	}
+	int start = (event[0] == 0xf7) ? 1 : 0;
+	m_out->write((const char*)event.data() + start, event.size() - start);
+}
+
+
+
+//////////////////////////////
+//
+// MidiStreamSink::flush -- Flush the output stream so that waiting
+//     events reach a FIFO or device immediately.
+//
+
+void MidiStreamSink::flush(void) {
+	if (m_out != NULL) {
+		m_out->flush();
+	}
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//
+// MidiRecorderSink
+//
+
+//////////////////////////////
+//
+// MidiRecorderSink::MidiRecorderSink -- Constructor.
+//
+
+MidiRecorderSink::MidiRecorderSink(void) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// MidiRecorderSink::~MidiRecorderSink -- Deconstructor.
+//
+
+MidiRecorderSink::~MidiRecorderSink() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// MidiRecorderSink::send -- Store a copy of the event and the time that
+//     it was received.
+//
+
+void MidiRecorderSink::send(const MidiEvent& event, double seconds) {
+	m_events.push_back(event);
+	m_times.push_back(seconds);
+}
+
+
+
+//////////////////////////////
+//
+// MidiRecorderSink::clear -- Remove all recorded events.
+//
+
+void MidiRecorderSink::clear(void) {
+	m_events.clear();
+	m_times.clear();
+}
+
+
+
+//////////////////////////////
+//
+// MidiRecorderSink::getEventCount -- Return the number of recorded events.
+//
+
+int MidiRecorderSink::getEventCount(void) const {
+	return (int)m_events.size();
+}
+
+
+
+//////////////////////////////
+//
+// MidiRecorderSink::getEvent -- Return a recorded event.
+//
+
+const MidiEvent& MidiRecorderSink::getEvent(int index) const {
+	return m_events.at(index);
+}
+
+
+
+//////////////////////////////
+//
+// MidiRecorderSink::getScheduledTime -- Return the time in seconds at
+//     which an event was supposed to be played.
+//
+
+double MidiRecorderSink::getScheduledTime(int index) const {
+	return m_events.at(index).seconds;
+}
+
+
+
+//////////////////////////////
+//
+// MidiRecorderSink::getActualTime -- Return the time in seconds at which
+//     an event was dispatched by the player.
+//
+
+double MidiRecorderSink::getActualTime(int index) const {
+	return m_times.at(index);
+}
+
+
+} // end namespace smf
+
+
+
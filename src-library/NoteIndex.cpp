@@ -0,0 +1,279 @@
+//
+// Creation Date: Wed Oct 21 18:05:44 PDT 2026
+// Filename:      midifile/src-library/NoteIndex.cpp
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   An interval index of the linked notes in a MidiFile,
+//                for finding the notes which are sounding at a given
+//                time or during a given time range.  The notes are
+//                stored in order of their start times, and an implicit
+//                balanced search tree over that array keeps the latest
+//                end time of each subtree, so a query takes O(log n + k)
+//                time for k notes found.  Queries can be done in ticks
+//                or in seconds.  The index is not changed after it is
+//                built, so it can be shared between threads.
+//
+
+#include "NoteIndex.h"
+#include "TrackMerger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+
+namespace smf {
+
+//////////////////////////////
+//
+// NoteIndex::NoteIndex -- Constructor.
+//
+
+NoteIndex::NoteIndex(void) {
+	// do nothing
+}
+
+
+NoteIndex::NoteIndex(const MidiFile& midifile) {
+	build(midifile);
+}
+
+
+
+//////////////////////////////
+//
+// NoteIndex::~NoteIndex -- Deconstructor.
+//
+
+NoteIndex::~NoteIndex() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// NoteIndex::build -- Index the notes of a MidiFile.  The note pairs must
+//     already be linked (see MidiFile::linkNotePairs()), and for queries
+//     in seconds, MidiFile::doTimeAnalysis() must have been done.  Notes
+//     without a note-off, or which end at the same tick as they start,
+//     are never sounding and are not indexed.  The MidiFile can be in
+//     delta or absolute tick mode, and must not be modified while the
+//     index is in use.  See MidiFile::getNoteIndex() for an index which
+//     is kept up to date by the MidiFile.
+//
+
+void NoteIndex::build(const MidiFile& midifile) {
+	m_notes.clear();
+
+	// note-offs waiting for their end tick (only needed in delta mode):
+	bool deltaQ = midifile.isDeltaTicks();
+	std::unordered_map<const MidiEvent*, int> noteoffs;
+
+	// visit the events in time order, so the notes are sorted by start:
+	TrackMerger merger(midifile);
+	while (merger.next()) {
+		const MidiEvent& event = merger.getEvent();
+		if (event.isNoteOff()) {
+			if (deltaQ && !noteoffs.empty()) {
+				auto it = noteoffs.find(&event);
+				if (it != noteoffs.end()) {
+					m_notes[it->second].end = merger.getTick();
+					noteoffs.erase(it);
+				}
+			}
+			continue;
+		}
+		if (!event.isNoteOn()) {
+			continue;
+		}
+		const MidiEvent* noteoff = event.getLinkedEvent();
+		if (noteoff == NULL) {
+			continue;
+		}
+		_Note note;
+		note.event    = &event;
+		note.start    = merger.getTick();
+		note.end      = deltaQ ? note.start : noteoff->tick;
+		note.startsec = event.seconds;
+		note.endsec   = noteoff->seconds;
+		if (deltaQ) {
+			noteoffs[noteoff] = (int)m_notes.size();
+		} else if (note.end <= note.start) {
+			continue;
+		}
+		m_notes.push_back(note);
+	}
+
+	if (deltaQ) {
+		// remove the zero-length notes
+		auto last = std::remove_if(m_notes.begin(), m_notes.end(),
+				[](const _Note& note) { return note.end <= note.start; });
+		m_notes.erase(last, m_notes.end());
+	}
+
+	buildTree(0, (int)m_notes.size());
+}
+
+
+
+//////////////////////////////
+//
+// NoteIndex::clear -- Remove all notes from the index.
+//
+
+void NoteIndex::clear(void) {
+	m_notes.clear();
+}
+
+
+
+//////////////////////////////
+//
+// NoteIndex::getNoteCount -- Return the number of notes in the index.
+//
+
+int NoteIndex::getNoteCount(void) const {
+	return (int)m_notes.size();
+}
+
+
+
+//////////////////////////////
+//
+// NoteIndex::getNotesAtTick -- Fill the list with the note-ons of the
+//     notes which are sounding at the given tick (starting at or before
+//     the tick, and ending after it), in order of start time.  Returns the
+//     number of notes found.
+//
+
+int NoteIndex::getNotesAtTick(int tick,
+		std::vector<const MidiEvent*>& notes) const {
+	notes.clear();
+	findNotes(0, (int)m_notes.size(), tick, tick + 1.0, false, notes);
+	return (int)notes.size();
+}
+
+
+
+//////////////////////////////
+//
+// NoteIndex::getNotesInTickRange -- Fill the list with the note-ons of the
+//     notes which are sounding at some time from starttick up to (but not
+//     including) endtick, in order of start time.  Returns the number of
+//     notes found.
+//
+
+int NoteIndex::getNotesInTickRange(int starttick, int endtick,
+		std::vector<const MidiEvent*>& notes) const {
+	notes.clear();
+	findNotes(0, (int)m_notes.size(), starttick, endtick, false, notes);
+	return (int)notes.size();
+}
+
+
+
+//////////////////////////////
+//
+// NoteIndex::getNotesAtTime -- Fill the list with the note-ons of the
+//     notes which are sounding at the given time in seconds, in order
+//     of start time.  Returns the number of notes found.
+//
+
+int NoteIndex::getNotesAtTime(double seconds,
+		std::vector<const MidiEvent*>& notes) const {
+	notes.clear();
+	double next = std::nextafter(seconds, std::numeric_limits<double>::infinity());
+	findNotes(0, (int)m_notes.size(), seconds, next, true, notes);
+	return (int)notes.size();
+}
+
+
+
+//////////////////////////////
+//
+// NoteIndex::getNotesInTimeRange -- Fill the list with the note-ons of
+//     the notes which are sounding at some time from starttime up to (but
+//     not including) endtime, in order of start time.  Returns the number
+//     of notes found.
+//
+
+int NoteIndex::getNotesInTimeRange(double starttime, double endtime,
+		std::vector<const MidiEvent*>& notes) const {
+	notes.clear();
+	findNotes(0, (int)m_notes.size(), starttime, endtime, true, notes);
+	return (int)notes.size();
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//
+// private functions
+//
+
+//////////////////////////////
+//
+// NoteIndex::buildTree -- Calculate the latest end time of each subtree
+//     for the range [lo, hi) of the notes.
+//
+
+void NoteIndex::buildTree(int lo, int hi) {
+	if (lo >= hi) {
+		return;
+	}
+	int mid = (lo + hi) / 2;
+	buildTree(lo, mid);
+	buildTree(mid + 1, hi);
+	_Note& node = m_notes[mid];
+	node.maxend    = node.end;
+	node.maxendsec = node.endsec;
+	if (lo < mid) {
+		const _Note& left = m_notes[(lo + mid) / 2];
+		node.maxend    = std::max(node.maxend, left.maxend);
+		node.maxendsec = std::max(node.maxendsec, left.maxendsec);
+	}
+	if (mid + 1 < hi) {
+		const _Note& right = m_notes[(mid + 1 + hi) / 2];
+		node.maxend    = std::max(node.maxend, right.maxend);
+		node.maxendsec = std::max(node.maxendsec, right.maxendsec);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// NoteIndex::findNotes -- Add the notes in the range [lo, hi) which start
+//     before end and end after start to the list.  Subtrees which end too
+//     early are skipped, and the search stops at the first note which
+//     starts too late.
+//
+
+void NoteIndex::findNotes(int lo, int hi, double start, double end,
+		bool secondsQ, std::vector<const MidiEvent*>& notes) const {
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		const _Note& node = m_notes[mid];
+		if ((secondsQ ? node.maxendsec : node.maxend) <= start) {
+			return;
+		}
+		findNotes(lo, mid, start, end, secondsQ, notes);
+		if ((secondsQ ? node.startsec : node.start) >= end) {
+			return;
+		}
+		if ((secondsQ ? node.endsec : node.end) > start) {
+			notes.push_back(node.event);
+		}
+		// continue with the right subtree
+		lo = mid + 1;
+	}
+}
+
+
+} // end namespace smf
+
+
+
@@ -0,0 +1,296 @@
+//
+// Creation Date: Wed Oct 21 15:48:30 PDT 2026
+// Filename:      midifile/src-library/NoteLinker.cpp
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Link note-ons to note-offs (and on/off switch
+//                controllers) in a MidiEventList, as done by
+//                MidiEventList::linkNotePairs().  The pairing of
+//                overlapping notes on the same key can be selected:
+//                the last note-on (LIFO), the first note-on (FIFO), or
+//                the note-on with the same velocity as the note-off.
+//                The open note-ons of each channel/key are kept in a
+//                fixed-size ring buffer inside the object, so linking
+//                does no memory allocation and each event is handled in
+//                constant time.  Note-ons and note-offs which could not
+//                be paired are reported.
+//
+
+#include "NoteLinker.h"
+
+#include <string.h>
+
+
+namespace smf {
+
+//////////////////////////////
+//
+// NoteLinker::NoteLinker -- Constructor.
+//
+
+NoteLinker::NoteLinker(void) {
+	memset(m_head, 0, sizeof(m_head));
+	memset(m_count, 0, sizeof(m_count));
+}
+
+
+NoteLinker::NoteLinker(NoteLinker::Policy policy) {
+	memset(m_head, 0, sizeof(m_head));
+	memset(m_count, 0, sizeof(m_count));
+	m_policy = policy;
+}
+
+
+
+//////////////////////////////
+//
+// NoteLinker::~NoteLinker -- Deconstructor.
+//
+
+NoteLinker::~NoteLinker() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// NoteLinker::setPolicy -- Select which note-on is ended by a note-off
+//     when several note-ons on the same channel/key are waiting.
+//
+
+void NoteLinker::setPolicy(NoteLinker::Policy policy) {
+	m_policy = policy;
+}
+
+
+
+//////////////////////////////
+//
+// NoteLinker::getPolicy -- Return the pairing policy for overlapping notes.
+//
+
+NoteLinker::Policy NoteLinker::getPolicy(void) const {
+	return m_policy;
+}
+
+
+
+//////////////////////////////
+//
+// NoteLinker::link -- Link note-ons to note-offs in an event list (or in
+//     each track of a MidiFile), replacing any previous links.  The
+//     events must be in time order.  The following General MIDI on/off
+//     switch controllers are also linked (on to the following off)
+//     within each track:
+//        64 (sustain), 65 (portamento), 66 (sostenuto), 67 (soft),
+//        68 (legato), 69 (hold 2), 80-90 (general purpose/undefined)
+//        and 122 (local keyboard).
+//     Returns the number of note-on/note-off pairs which were linked.
+//
+
+int NoteLinker::link(MidiEventList& events) {
+	m_unmatchedOns.clear();
+	m_unmatchedOffs.clear();
+	return linkTrack(events);
+}
+
+
+int NoteLinker::link(MidiFile& midifile) {
+	m_unmatchedOns.clear();
+	m_unmatchedOffs.clear();
+	int sum = 0;
+	for (int i=0; i<midifile.getTrackCount(); i++) {
+		sum += linkTrack(midifile[i]);
+	}
+	return sum;
+}
+
+
+
+//////////////////////////////
+//
+// NoteLinker::getUnmatchedCount -- Return the number of note-ons and
+//     note-offs which were not paired by the last call to link().
+//
+
+int NoteLinker::getUnmatchedCount(void) const {
+	return (int)(m_unmatchedOns.size() + m_unmatchedOffs.size());
+}
+
+
+
+//////////////////////////////
+//
+// NoteLinker::getUnmatchedNoteOns -- Return the note-ons which were left
+//     without a note-off by the last call to link().
+//
+
+const std::vector<MidiEvent*>& NoteLinker::getUnmatchedNoteOns(void) const {
+	return m_unmatchedOns;
+}
+
+
+
+//////////////////////////////
+//
+// NoteLinker::getUnmatchedNoteOffs -- Return the note-offs which had no
+//     note-on to end in the last call to link().
+//
+
+const std::vector<MidiEvent*>& NoteLinker::getUnmatchedNoteOffs(void) const {
+	return m_unmatchedOffs;
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//
+// private functions
+//
+
+//////////////////////////////
+//
+// NoteLinker::linkTrack -- Link the notes and controllers of one event
+//     list, and add unpaired notes to the unmatched lists.  The ring
+//     buffers are left empty for the next list.
+//
+
+int NoteLinker::linkTrack(MidiEventList& events) {
+	// Map controller numbers to switch-controller slots (-1 = not a switch).
+	static const signed char contmap[128] = {
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		 0,  1,  2,  3,  4,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		 6,  7,  8,  9, 10, 11, 12, 13, 14, 15, 16, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 17, -1, -1, -1, -1, -1
+	};
+
+	// contevents == last on (or off) event of each switch controller for
+	// each channel; oldstates == its state (-1 = not seen yet).
+	MidiEvent* contevents[18][16] = {{NULL}};
+	signed char oldstates[18][16];
+	memset(oldstates, -1, sizeof(oldstates));
+
+	int channelmask = 0;
+	int counter = 0;
+	int count = events.size();
+	for (int i=0; i<count; i++) {
+		MidiEvent* mev = &events[i];
+		mev->unlinkEvent();
+		if (mev->isNoteOn()) {
+			// store the note-on to pair later with a note-off message.
+			int channel = mev->getChannel();
+			int slot = channel * 128 + mev->getKeyNumber();
+			channelmask |= 1 << channel;
+			if (m_count[slot] == NOTELINKER_DEPTH) {
+				m_unmatchedOns.push_back(&events[m_slots[slot][m_head[slot]]]);
+				m_head[slot] = (m_head[slot] + 1) % NOTELINKER_DEPTH;
+				m_count[slot]--;
+			}
+			m_slots[slot][(m_head[slot] + m_count[slot]) % NOTELINKER_DEPTH] = i;
+			m_count[slot]++;
+		} else if (mev->isNoteOff()) {
+			int slot = mev->getChannel() * 128 + mev->getKeyNumber();
+			int index = popNoteOn(slot, events, mev->getVelocity());
+			if (index < 0) {
+				m_unmatchedOffs.push_back(mev);
+			} else {
+				events[index].linkEvent(mev);
+				counter++;
+			}
+		} else if (mev->isController()) {
+			int conti = contmap[mev->getP1() & 0x7f];
+			if (conti < 0) {
+				continue;
+			}
+			int channel   = mev->getChannel();
+			int contstate = mev->getP2() < 64 ? 0 : 1;
+			if ((oldstates[conti][channel] == -1) && contstate) {
+				// a newly initialized onstate was detected, so store for
+				// later linking to an off state.
+				contevents[conti][channel] = mev;
+				oldstates[conti][channel] = contstate;
+			} else if (oldstates[conti][channel] == contstate) {
+				// the controller state is redundant and will be ignored.
+			} else if ((oldstates[conti][channel] == 0) && contstate) {
+				// controller is currently off, so store on-state for next link
+				contevents[conti][channel] = mev;
+				oldstates[conti][channel] = contstate;
+			} else if ((oldstates[conti][channel] == 1) && (contstate == 0)) {
+				// controller has just been turned off, so link to
+				// stored on-message.
+				contevents[conti][channel]->linkEvent(mev);
+				oldstates[conti][channel] = contstate;
+				contevents[conti][channel] = mev;
+			}
+		}
+	}
+
+	// Report the note-ons which are still waiting, and empty the buffers:
+	for (int channel=0; channel<16; channel++) {
+		if (!(channelmask & (1 << channel))) {
+			continue;
+		}
+		for (int slot=channel*128; slot<(channel+1)*128; slot++) {
+			for (int j=0; j<m_count[slot]; j++) {
+				int index = m_slots[slot][(m_head[slot] + j) % NOTELINKER_DEPTH];
+				m_unmatchedOns.push_back(&events[index]);
+			}
+			m_head[slot] = 0;
+			m_count[slot] = 0;
+		}
+	}
+
+	return counter;
+}
+
+
+
+//////////////////////////////
+//
+// NoteLinker::popNoteOn -- Remove the note-on to be ended by a note-off
+//     from the ring buffer of a channel/key according to the policy, and
+//     return its index in the event list (or -1 if there is none).
+//
+
+int NoteLinker::popNoteOn(int slot, MidiEventList& events, int velocity) {
+	int count = m_count[slot];
+	if (count == 0) {
+		return -1;
+	}
+	int* ring = m_slots[slot];
+	int head = m_head[slot];
+	int position = 0;
+	if (m_policy == LIFO) {
+		position = count - 1;
+	} else if (m_policy == Velocity) {
+		for (int j=0; j<count; j++) {
+			if (events[ring[(head + j) % NOTELINKER_DEPTH]].getVelocity() == velocity) {
+				position = j;
+				break;
+			}
+		}
+	}
+	int index = ring[(head + position) % NOTELINKER_DEPTH];
+	if (position == 0) {
+		m_head[slot] = (head + 1) % NOTELINKER_DEPTH;
+	} else {
+		// close the gap left in the ring
+		for (int j=position; j<count-1; j++) {
+			ring[(head + j) % NOTELINKER_DEPTH] = ring[(head + j + 1) % NOTELINKER_DEPTH];
+		}
+	}
+	m_count[slot]--;
+	return index;
+}
+
+
+} // end namespace smf
+
+
+
@@ -0,0 +1,964 @@
+//
+// Creation Date: Tue Oct 20 14:31:08 PDT 2026
+// Filename:      midifile/src-library/NoteList.cpp
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Convert between MidiFiles and text notelists.  Two
+//                formats are handled: the "note start duration key
+//                velocity" lines (times in seconds) read by text2midi and
+//                written by midi2text, and the "Note on off key" lines
+//                (integer times in thousandths of a time unit) written by
+//                midi2notes.  Input files are memory mapped and parsed in
+//                place without iostreams, and the notes are collected
+//                into preallocated arrays which are sorted and merged
+//                once before being added to the MidiFile.  Output is
+//                formatted into a memory buffer which is written in
+//                large blocks.
+//
+
+#include "NoteList.h"
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+
+#if defined(__unix__) || defined(__APPLE__)
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#define NOTELIST_MMAP
+#endif
+
+
+namespace smf {
+
+// Powers of ten which are exactly representable as doubles.
+static const double PowersOfTen[23] = {
+	1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+//////////////////////////////
+//
+// NoteList::NoteList -- Constructor.
+//
+
+NoteList::NoteList(void) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// NoteList::~NoteList -- Deconstructor.
+//
+
+NoteList::~NoteList() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// NoteList::setFormat -- Set the notelist format for reading and
+//     writing.  Default value is NoteList::Text.
+//
+
+void NoteList::setFormat(NoteList::Format format) {
+	m_format = format;
+}
+
+
+
+//////////////////////////////
+//
+// NoteList::getFormat -- Return the notelist format.
+//
+
+NoteList::Format NoteList::getFormat(void) const {
+	return m_format;
+}
+
+
+
+//////////////////////////////
+//
+// NoteList::setTimeUnit -- Set the unit of the times in the notelist.
+//     Times in the Notes format are integers in thousandths of the unit.
+//     Default value is NoteList::Seconds.
+//
+
+void NoteList::setTimeUnit(NoteList::TimeUnit unit) {
+	m_unit = unit;
+}
+
+
+
+//////////////////////////////
+//
+// NoteList::getTimeUnit -- Return the unit of the times in the notelist.
+//
+
+NoteList::TimeUnit NoteList::getTimeUnit(void) const {
+	return m_unit;
+}
+
+
+
+//////////////////////////////
+//
+// NoteList::setTempo -- Set the tempo (in quarter notes per minute) used
+//     to convert between ticks and seconds.  When reading, this tempo is
+//     also stored at the start of the MidiFile.  When writing, it is used
+//     until the first tempo message in the MidiFile.  Default value is 120.
+//
+
+void NoteList::setTempo(double tempo) {
+	if (tempo > 0.0) {
+		m_tempo = tempo;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// NoteList::getTempo -- Return the tempo used to convert times.
+//
+
+double NoteList::getTempo(void) const {
+	return m_tempo;
+}
+
+
+
+//////////////////////////////
+//
+// NoteList::setTicksPerQuarterNote -- Set the ticks per quarter note of
+//     MidiFiles created by read().  Default value is 480.
+//
+
+void NoteList::setTicksPerQuarterNote(int tpq) {
+	if (tpq > 0) {
+		m_tpq = tpq;
+	}
+}
+
+
+void NoteList::setTPQ(int tpq) {
+	setTicksPerQuarterNote(tpq);
+}
+
+
+
+//////////////////////////////
+//
+// NoteList::setTrack -- Set the track which notes are added to when
+//     reading.  Default value is 0.
+//
+
+void NoteList::setTrack(int track) {
+	m_track = track < 0 ? 0 : track;
+}
+
+
+
+//////////////////////////////
+//
+// NoteList::setChannel -- Set the MIDI channel (offset from 0) of notes
+//     which are read.  Notes in the Notes format which have a CH_n column
+//     use that channel instead.  Default value is 0.
+//
+
+void NoteList::setChannel(int channel) {
+	m_channel = std::min(std::max(channel, 0), 15);
+}
+
+
+
+//////////////////////////////
+//
+// NoteList::setVelocity -- Set the attack velocity of notes read in the
+//     Notes format, which does not contain velocities.  Default value
+//     is 64.
+//
+
+void NoteList::setVelocity(int velocity) {
+	m_velocity = std::min(std::max(velocity, 0), 127);
+}
+
+
+
+//////////////////////////////
+//
+// NoteList::excludeChannel -- Ignore notes on the given MIDI channel
+//     (offset from 0) when writing.
+//
+
+void NoteList::excludeChannel(int channel) {
+	if ((channel >= 0) && (channel < 16)) {
+		m_excluded |= 1 << channel;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// NoteList::setChannelColumn -- Add the channel of each note (as CH_n,
+//     offset from 1) at the end of the lines written in the Notes format.
+//
+
+void NoteList::setChannelColumn(bool state) {
+	m_channelQ = state;
+}
+
+
+
+//////////////////////////////
+//
+// NoteList::read -- Read a notelist into a MidiFile.  The MidiFile is
+//     cleared and then filled with a tempo message followed by the notes
+//     in time order.  Lines which do not start with "note" (in any case)
+//     and anything following a ";" are ignored.  Note lines which cannot
+//     be parsed are skipped, and their line numbers are available from
+//     getErrorLines().  Returns false if the file could not be read.
+//
+
+bool NoteList::read(const std::string& filename, MidiFile& midifile) {
+#ifdef NOTELIST_MMAP
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		std::cerr << "Error: cannot read notelist " << filename << std::endl;
+		return false;
+	}
+	struct stat info;
+	if ((fstat(fd, &info) == 0) && S_ISREG(info.st_mode) && (info.st_size > 0)) {
+		size_t size = (size_t)info.st_size;
+		void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (data != MAP_FAILED) {
+			madvise(data, size, MADV_SEQUENTIAL);
+			bool status = read((const char*)data, size, midifile);
+			munmap(data, size);
+			return status;
+		}
+	} else {
+		close(fd);
+	}
+#endif
+
+	// Other systems, special files and files which cannot be mapped:
+	std::string contents;
+	if (!readFile(filename, contents)) {
+		std::cerr << "Error: cannot read notelist " << filename << std::endl;
+		return false;
+	}
+	return read(contents.data(), contents.size(), midifile);
+}
+
+
+bool NoteList::read(const char* data, size_t size, MidiFile& midifile) {
+	parse(data, size);
+	midifile.clear();
+	midifile.setTicksPerQuarterNote(m_tpq);
+	midifile.absoluteTicks();
+	if (m_track > 0) {
+		midifile.addTracks(m_track);
+	}
+	addEvents(midifile);
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// NoteList::write -- Write the notes in a MidiFile as a notelist.  The
+//     MidiFile is converted to absolute ticks with joined tracks (as
+//     midi2text and midi2notes have always done).  Notes are matched by
+//     key number only.  In the Text format, notes are written in the
+//     order of their note-offs, and only the first tempo is used to
+//     calculate times (later tempo changes are listed in comment lines).
+//     In the Notes format, notes are written in the order of their
+//     note-ons, and the times of each event are calculated with the tempo
+//     which was last set before it.  Returns false if the output could
+//     not be written.
+//
+
+bool NoteList::write(const std::string& filename, MidiFile& midifile) {
+	std::ofstream output(filename.c_str(), std::ios::binary);
+	if (!output.is_open()) {
+		std::cerr << "Error: cannot write notelist " << filename << std::endl;
+		return false;
+	}
+	return write(output, midifile);
+}
+
+
+bool NoteList::write(std::ostream& output, MidiFile& midifile) {
+	struct _NoteLine {
+		double on;
+		int    ontime;
+		int    offtime;
+		uchar  key;
+		uchar  channel;
+	};
+
+	midifile.absoluteTicks();
+	midifile.joinTracks();
+	MidiEventList& events = midifile[0];
+	int tpq = midifile.getTicksPerQuarterNote();
+	bool textQ = m_format == Text;
+
+	double ontimes[128];
+	int velocities[128];
+	std::fill(ontimes, ontimes + 128, -1.0);
+	std::fill(velocities, velocities + 128, -1);
+	double tempo = m_tempo;
+	int tempocount = 0;
+	std::vector<_NoteLine> lines;
+
+	std::vector<char> buffer(NOTELIST_BUFFER_SIZE + 256);
+	char* start = buffer.data();
+	char* limit = start + NOTELIST_BUFFER_SIZE;
+	char* out = start;
+	m_lineCount = 0;
+	m_noteCount = 0;
+
+	// Called after every line: the buffer has room for one more line
+	// past the limit, so it is written out as soon as the limit is passed.
+	auto endLine = [&]() {
+		*out++ = '\n';
+		if (out >= limit) {
+			output.write(start, out - start);
+			out = start;
+		}
+	};
+
+	for (int i=0; i<events.size(); i++) {
+		const MidiEvent& event = events[i];
+		if (event.isTempo()) {
+			int microseconds = (event[3] << 16) | (event[4] << 8) | event[5];
+			double newtempo = 60.0 / microseconds * 1000000.0;
+			tempocount++;
+			if ((tempocount <= 1) || !textQ) {
+				tempo = newtempo;
+			} else if (tempo != newtempo) {
+				static const char warning[] = "; WARNING: change of tempo from ";
+				out = std::copy(warning, warning + sizeof(warning) - 1, out);
+				out = writeDouble(out, tempo);
+				out = std::copy(" to ", " to " + 4, out);
+				out = writeDouble(out, newtempo);
+				out = std::copy(" ignored", " ignored" + 8, out);
+				endLine();
+				m_lineCount++;
+			}
+			continue;
+		}
+		if (!event.isNote()) {
+			continue;
+		}
+		int channel = event.getChannelNibble();
+		if (m_excluded & (1 << channel)) {
+			continue;
+		}
+		int key = event.getKeyNumber();
+		if (event.isNoteOn()) {
+			ontimes[key] = getTime(event.tick, tempo, tpq);
+			velocities[key] = event.getVelocity();
+			continue;
+		}
+		if (velocities[key] < 0) {
+			// note-off without a note-on
+			continue;
+		}
+
+		double on = ontimes[key];
+		double duration = getTime(event.tick, tempo, tpq) - on;
+		if (textQ) {
+			out = std::copy("note\t", "note\t" + 5, out);
+			out = writeDouble(out, on);
+			*out++ = '\t';
+			out = writeDouble(out, duration);
+			*out++ = '\t';
+			out = writeInteger(out, key);
+			*out++ = '\t';
+			out = writeInteger(out, velocities[key]);
+			endLine();
+		} else {
+			_NoteLine line;
+			line.on = on;
+			line.ontime = int(on * 1000 + 0.5);
+			line.offtime = int((on + duration) * 1000 + 0.5);
+			line.key = (uchar)key;
+			line.channel = (uchar)channel;
+			if (line.ontime >= 0) {
+				// (times which are too large for an int are negative)
+				lines.push_back(line);
+			}
+		}
+		ontimes[key] = -1.0;
+		velocities[key] = -1;
+		m_noteCount++;
+	}
+
+	if (!textQ) {
+		std::stable_sort(lines.begin(), lines.end(),
+				[](const _NoteLine& a, const _NoteLine& b) {
+					return a.on < b.on;
+				});
+		for (const _NoteLine& line : lines) {
+			out = std::copy("Note\t", "Note\t" + 5, out);
+			out = writeInteger(out, line.ontime);
+			*out++ = '\t';
+			out = writeInteger(out, line.offtime);
+			*out++ = '\t';
+			out = writeInteger(out, line.key);
+			if (m_channelQ) {
+				out = std::copy("\tCH_", "\tCH_" + 4, out);
+				out = writeInteger(out, line.channel + 1);
+			}
+			endLine();
+		}
+	}
+	output.write(start, out - start);
+	output.flush();
+	m_lineCount += m_noteCount;
+	return !output.fail();
+}
+
+
+
+//////////////////////////////
+//
+// NoteList::getLineCount -- Return the number of lines in the last
+//     notelist which was read or written.
+//
+
+int NoteList::getLineCount(void) const {
+	return m_lineCount;
+}
+
+
+
+//////////////////////////////
+//
+// NoteList::getNoteCount -- Return the number of notes in the last
+//     notelist which was read or written.
+//
+
+int NoteList::getNoteCount(void) const {
+	return m_noteCount;
+}
+
+
+
+//////////////////////////////
+//
+// NoteList::getErrorLines -- Return the line numbers (starting at 1)
+//     of the notes in the last notelist read which could not be parsed.
+//
+
+const std::vector<int>& NoteList::getErrorLines(void) const {
+	return m_errors;
+}
+
+
+
+//////////////////////////////
+//
+// NoteList::parseDouble -- Parse a floating-point number at the start
+//     of the text between ptr and end, in the same way as strtod(), and
+//     move ptr to the character after the number.  Numbers with up to 15
+//     significant digits and small exponents are converted exactly with
+//     integer arithmetic; others are passed on to strtod().  Returns 0.0
+//     if there is no number.
+//
+
+double NoteList::parseDouble(const char*& ptr, const char* end) {
+	const char* p = ptr;
+	bool negativeQ = false;
+	if ((p < end) && ((*p == '-') || (*p == '+'))) {
+		negativeQ = *p == '-';
+		p++;
+	}
+	unsigned long long mantissa = 0;
+	int digits = 0;
+	int exponent = 0;
+	bool numberQ = false;
+	while ((p < end) && (*p >= '0') && (*p <= '9')) {
+		if (digits < 19) {
+			mantissa = mantissa * 10 + (*p - '0');
+			digits += mantissa ? 1 : 0;
+		} else {
+			exponent++;
+			digits++;
+		}
+		numberQ = true;
+		p++;
+	}
+	if ((p < end) && (*p == '.')) {
+		p++;
+		while ((p < end) && (*p >= '0') && (*p <= '9')) {
+			if (digits < 19) {
+				mantissa = mantissa * 10 + (*p - '0');
+				digits += mantissa ? 1 : 0;
+				exponent--;
+			} else {
+				digits++;
+			}
+			numberQ = true;
+			p++;
+		}
+	}
+	if (numberQ && (p < end) && ((*p == 'e') || (*p == 'E'))) {
+		const char* q = p + 1;
+		bool negativeExponentQ = false;
+		if ((q < end) && ((*q == '-') || (*q == '+'))) {
+			negativeExponentQ = *q == '-';
+			q++;
+		}
+		if ((q < end) && (*q >= '0') && (*q <= '9')) {
+			int value = 0;
+			while ((q < end) && (*q >= '0') && (*q <= '9')) {
+				if (value < 10000) {
+					value = value * 10 + (*q - '0');
+				}
+				q++;
+			}
+			exponent += negativeExponentQ ? -value : value;
+			p = q;
+		}
+	}
+
+	bool separatorQ = (p == end) || (*p == ' ') || (*p == '\t') ||
+			(*p == '\r') || (*p == '\n');
+	if (numberQ && separatorQ && (digits <= 15) && (exponent >= -22) &&
+			(exponent <= 22)) {
+		double value = (double)mantissa;
+		if (exponent < 0) {
+			value /= PowersOfTen[-exponent];
+		} else {
+			value *= PowersOfTen[exponent];
+		}
+		ptr = p;
+		return negativeQ ? -value : value;
+	}
+
+	// Everything else (long numbers, "inf", hexadecimal, etc.):
+	char text[64];
+	int length = (int)std::min((long)(end - ptr), (long)sizeof(text) - 1);
+	memcpy(text, ptr, length);
+	text[length] = '\0';
+	char* stop = text;
+	double value = strtod(text, &stop);
+	ptr += stop - text;
+	return value;
+}
+
+
+
+//////////////////////////////
+//
+// NoteList::parseInteger -- Parse a decimal integer at the start of the
+//     text between ptr and end, in the same way as strtol(), and move ptr
+//     to the character after the number.  Returns 0 if there is no number.
+//
+
+int NoteList::parseInteger(const char*& ptr, const char* end) {
+	const char* p = ptr;
+	bool negativeQ = false;
+	if ((p < end) && ((*p == '-') || (*p == '+'))) {
+		negativeQ = *p == '-';
+		p++;
+	}
+	if ((p >= end) || (*p < '0') || (*p > '9')) {
+		return 0;
+	}
+	long long value = 0;
+	while ((p < end) && (*p >= '0') && (*p <= '9')) {
+		if (value < 0x7fffffff) {
+			value = value * 10 + (*p - '0');
+		}
+		p++;
+	}
+	ptr = p;
+	value = std::min(value, 0x7fffffffLL);
+	return (int)(negativeQ ? -value : value);
+}
+
+
+
+//////////////////////////////
+//
+// NoteList::writeDouble -- Write a number in the same form as the
+//     default output of a C++ stream (or printf("%g")), with six
+//     significant digits and trailing zeros removed.  Values which need
+//     an exponent or which are halfway between two six-digit values are
+//     passed on to snprintf().  Returns the end of the written text (at
+//     most 16 characters).
+//
+
+char* NoteList::writeDouble(char* output, double value) {
+	if (value == 0.0) {
+		if (signbit(value)) {
+			*output++ = '-';
+		}
+		*output++ = '0';
+		return output;
+	}
+	double magnitude = fabs(value);
+	if ((magnitude >= 1.0e-4) && (magnitude < 999999.5)) {
+		int exponent = 5;
+		while ((exponent > -4) && (magnitude < (exponent >= 0 ?
+				PowersOfTen[exponent] : 1.0 / PowersOfTen[-exponent]))) {
+			exponent--;
+		}
+		int decimals = 5 - exponent;
+		double scaled = magnitude * PowersOfTen[decimals];
+		double rounded = floor(scaled + 0.5);
+		if (fabs(scaled - floor(scaled) - 0.5) > 1.0e-7) {
+			if (rounded == 1.0e6) {
+				rounded = 1.0e5;
+				decimals--;
+			}
+			if ((rounded >= 1.0e5) && (rounded < 1.0e6) && (decimals >= 0)) {
+				char digits[16];
+				int length = snprintf(digits, sizeof(digits), "%d", (int)rounded);
+				// remove trailing zeros after the decimal point:
+				while ((decimals > 0) && (digits[length - 1] == '0')) {
+					length--;
+					decimals--;
+				}
+				if (value < 0.0) {
+					*output++ = '-';
+				}
+				int whole = length - decimals;
+				if (whole <= 0) {
+					*output++ = '0';
+					*output++ = '.';
+					for (int i=whole; i<0; i++) {
+						*output++ = '0';
+					}
+					output = std::copy(digits, digits + length, output);
+				} else {
+					output = std::copy(digits, digits + whole, output);
+					if (decimals > 0) {
+						*output++ = '.';
+						output = std::copy(digits + whole, digits + length, output);
+					}
+				}
+				return output;
+			}
+		}
+	}
+	return output + snprintf(output, 16, "%g", value);
+}
+
+
+
+//////////////////////////////
+//
+// NoteList::writeInteger -- Write an integer in decimal.  Returns the end
+//     of the written text.
+//
+
+char* NoteList::writeInteger(char* output, int value) {
+	unsigned int magnitude = value < 0 ? 0u - (unsigned int)value : value;
+	if (value < 0) {
+		*output++ = '-';
+	}
+	char digits[12];
+	int count = 0;
+	do {
+		digits[count++] = (char)('0' + magnitude % 10);
+		magnitude /= 10;
+	} while (magnitude);
+	while (count > 0) {
+		*output++ = digits[--count];
+	}
+	return output;
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//
+// private functions
+//
+
+//////////////////////////////
+//
+// NoteList::readFile -- Read the contents of a file into a string.
+//
+
+bool NoteList::readFile(const std::string& filename, std::string& contents) {
+	std::ifstream input(filename.c_str(), std::ios::binary);
+	if (!input.is_open()) {
+		return false;
+	}
+	input.seekg(0, std::ios::end);
+	std::streamoff size = input.tellg();
+	input.seekg(0, std::ios::beg);
+	if (size > 0) {
+		contents.resize((size_t)size);
+		input.read(&contents[0], size);
+		contents.resize((size_t)input.gcount());
+	} else {
+		// stream which cannot seek (such as a pipe)
+		input.clear();
+		contents.assign(std::istreambuf_iterator<char>(input),
+				std::istreambuf_iterator<char>());
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// NoteList::parse -- Read the notes in a notelist into m_ons and m_offs.
+//     The arrays are allocated for the number of lines in the text before
+//     parsing.
+//
+
+void NoteList::parse(const char* data, size_t size) {
+	const char* end = data + size;
+	size_t lines = 1;
+	for (const char* p = data; (p = (const char*)memchr(p, '\n', end - p)); p++) {
+		lines++;
+	}
+	m_ons.clear();
+	m_offs.clear();
+	m_errors.clear();
+	m_ons.reserve(lines);
+	m_offs.reserve(lines);
+	m_lineCount = 0;
+	m_noteCount = 0;
+
+	double factor = 1.0;
+	switch (m_unit) {
+		case Ticks:        factor = 1.0;                          break;
+		case Beats:        factor = m_tpq;                        break;
+		case Seconds:      factor = m_tpq * m_tempo / 60.0;         break;
+		case Milliseconds: factor = m_tpq * m_tempo / 60.0 / 1000.0; break;
+	}
+	if (m_format == Notes) {
+		factor /= 1000.0;
+	}
+
+	const char* ptr = data;
+	while (ptr < end) {
+		const char* eol = (const char*)memchr(ptr, '\n', end - ptr);
+		if (eol == NULL) {
+			eol = end;
+		}
+		const char* comment = (const char*)memchr(ptr, ';', eol - ptr);
+		m_lineCount++;
+
+		double on;
+		double off;
+		int key;
+		int velocity;
+		int channel;
+		int status = parseLine(ptr, comment ? comment : eol, on, off, key,
+				velocity, channel);
+		ptr = eol + 1;
+		if (status == 0) {
+			continue;
+		} else if (status < 0) {
+			m_errors.push_back(m_lineCount);
+			continue;
+		}
+
+		_NoteEvent event;
+		event.key = (uchar)key;
+		event.velocity = (uchar)velocity;
+		int ontick = (int)(on * factor + 0.5);
+		int offtick = (int)(off * factor + 0.5);
+		if (offtick <= ontick) {
+			offtick = ontick + 1;
+		}
+
+		event.tick = ontick;
+		event.command = (uchar)(0x90 | channel);
+		if (velocity == 0) {
+			// A note-on with zero velocity is sorted as a note-off.
+			m_offs.push_back(event);
+		} else {
+			m_ons.push_back(event);
+		}
+		event.tick = offtick;
+		event.command = (uchar)(0x80 | channel);
+		m_offs.push_back(event);
+		m_noteCount++;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// NoteList::parseLine -- Read the values from a line of the notelist.
+//     Returns 1 if the line contains a note, 0 if the line should be
+//     ignored, and -1 if the note cannot be parsed.
+//
+
+int NoteList::parseLine(const char* ptr, const char* end, double& on,
+		double& off, int& key, int& velocity, int& channel) {
+	const char* token[6];
+	const char* tokenend[6];
+	int count = 0;
+	while ((ptr < end) && (count < 6)) {
+		while ((ptr < end) && ((*ptr == ' ') || (*ptr == '\t'))) {
+			ptr++;
+		}
+		if (ptr == end) {
+			break;
+		}
+		token[count] = ptr;
+		while ((ptr < end) && (*ptr != ' ') && (*ptr != '\t')) {
+			ptr++;
+		}
+		tokenend[count++] = ptr;
+	}
+
+	if ((count == 0) || (tokenend[0] - token[0] != 4) ||
+			((token[0][0] | 0x20) != 'n') || ((token[0][1] | 0x20) != 'o') ||
+			((token[0][2] | 0x20) != 't') || ((token[0][3] | 0x20) != 'e')) {
+		return 0;
+	}
+
+	if (m_format == Notes) {
+		if (count < 4) {
+			return -1;
+		}
+		on  = parseDouble(token[1], tokenend[1]);
+		off = parseDouble(token[2], tokenend[2]);
+		key = parseInteger(token[3], tokenend[3]);
+		velocity = m_velocity;
+		channel = m_channel;
+		if ((count > 4) && (tokenend[4] - token[4] > 3) &&
+				((token[4][0] | 0x20) == 'c') && ((token[4][1] | 0x20) == 'h') &&
+				(token[4][2] == '_')) {
+			const char* p = token[4] + 3;
+			channel = parseInteger(p, tokenend[4]) - 1;
+			if ((channel < 0) || (channel > 15)) {
+				return -1;
+			}
+		}
+	} else {
+		if (count < 5) {
+			return -1;
+		}
+		on  = parseDouble(token[1], tokenend[1]);
+		off = on + parseDouble(token[2], tokenend[2]);
+		key = parseInteger(token[3], tokenend[3]);
+		velocity = parseInteger(token[4], tokenend[4]);
+		channel = m_channel;
+	}
+
+	if ((key < 0) || (key > 127) || (velocity < 0) || (velocity > 127) ||
+			!(on >= 0.0)) {
+		return -1;
+	}
+	return 1;
+}
+
+
+
+//////////////////////////////
+//
+// NoteList::addEvents -- Add a tempo message and the notes to the
+//     MidiFile.  The note-offs and note-ons are each sorted, and then
+//     merged into the track, in the order given by eventcompare() (as in
+//     MidiFile::sortTracks()).
+//
+
+void NoteList::addEvents(MidiFile& midifile) {
+	MidiEventList& list = midifile[m_track];
+	list.reserve(list.size() + 1 + (int)m_ons.size() + (int)m_offs.size());
+
+	std::vector<uchar> tempo(6);
+	int microseconds = (int)(60.0 / m_tempo * 1000000.0 + 0.5);
+	tempo[0] = 0xff;
+	tempo[1] = 0x51;
+	tempo[2] = 0x03;
+	tempo[3] = (microseconds >> 16) & 0xff;
+	tempo[4] = (microseconds >> 8)  & 0xff;
+	tempo[5] = (microseconds >> 0)  & 0xff;
+	list.push_back_no_copy(new MidiEvent(0, m_track, tempo));
+
+	std::vector<MidiEvent*> ons;
+	std::vector<MidiEvent*> offs;
+	makeEvents(m_ons, ons);
+	makeEvents(m_offs, offs);
+
+	size_t i = 0;
+	size_t j = 0;
+	while ((i < ons.size()) || (j < offs.size())) {
+		if ((j < offs.size()) && ((i == ons.size()) ||
+				(eventcompare(*offs[j], *ons[i]) <= 0))) {
+			list.push_back_no_copy(offs[j++]);
+		} else {
+			list.push_back_no_copy(ons[i++]);
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// NoteList::getTime -- Convert ticks into the time unit.
+//
+
+double NoteList::getTime(int tick, double tempo, int tpq) const {
+	switch (m_unit) {
+		case Ticks:        return tick;
+		case Beats:        return (double)tick / tpq;
+		case Seconds:      return tick * 60.0 / tempo / tpq;
+		case Milliseconds: return tick * 60.0 / tempo / tpq * 1000.0;
+	}
+	return 0.0;
+}
+
+
+
+//////////////////////////////
+//
+// NoteList::makeEvents -- Make a MidiEvent for each note event, sorted
+//     with eventcompare() if the notes were not read in that order.
+//
+
+void NoteList::makeEvents(const std::vector<NoteList::_NoteEvent>& notes,
+		std::vector<MidiEvent*>& events) {
+	events.reserve(notes.size());
+	for (const _NoteEvent& note : notes) {
+		MidiEvent* event = new MidiEvent(note.command, note.key, note.velocity);
+		event->tick = note.tick;
+		event->track = m_track;
+		events.push_back(event);
+	}
+	auto less = [](const MidiEvent* a, const MidiEvent* b) {
+		return eventcompare(*a, *b) < 0;
+	};
+	if (!std::is_sorted(events.begin(), events.end(), less)) {
+		std::stable_sort(events.begin(), events.end(), less);
+	}
+}
+
+
+} // end namespace smf
+
+
+
@@ -0,0 +1,537 @@
+//
+// Creation Date: Mon Oct 19 15:02:18 PDT 2026
+// Filename:      midifile/src-library/PerformanceClassifier.cpp
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Determine if a MIDI file is a live performance or if it
+//                was entered in step-time (quantized), based on a
+//                histogram of the inter-onset intervals (IOIs) between
+//                successive note-ons in the file.  Standard MIDI files
+//                are scanned directly without creating MidiEvents, and
+//                lists of files can be classified in parallel.
+//
+
+#include "PerformanceClassifier.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <cstring>
+#include <algorithm>
+#include <cmath>
+#include <climits>
+
+
+namespace smf {
+
+// Number of distinct IOIs examined by the classification rules.
+#define PERFORMANCE_IOI_COUNT 6
+
+//////////////////////////////
+//
+// PerformanceClassifier::PerformanceClassifier -- Constructor.
+//
+
+PerformanceClassifier::PerformanceClassifier(void) {
+	m_histogram.resize(PERFORMANCE_HISTOGRAM_SIZE, 0);
+}
+
+
+
+//////////////////////////////
+//
+// PerformanceClassifier::~PerformanceClassifier -- Deconstructor.
+//
+
+PerformanceClassifier::~PerformanceClassifier() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// PerformanceClassifier::setCutoff -- IOIs which are this number of ticks
+//     or longer are not included in the histogram.  Default value is
+//     1000000.
+//
+
+void PerformanceClassifier::setCutoff(int ticks) {
+	m_cutoff = ticks < 1 ? 1 : ticks;
+}
+
+
+
+//////////////////////////////
+//
+// PerformanceClassifier::getCutoff -- Return the maximum IOI length (+1).
+//
+
+int PerformanceClassifier::getCutoff(void) const {
+	return m_cutoff;
+}
+
+
+
+//////////////////////////////
+//
+// PerformanceClassifier::classify -- Classify a MIDI file.  Standard MIDI
+//     files are scanned directly; other input formats readable by MidiFile
+//     (such as binasc text) are read into a MidiFile first.  Returns false
+//     if the input could not be read, in which case the type is Unknown.
+//
+
+bool PerformanceClassifier::classify(const std::string& filename) {
+	std::ifstream input(filename, std::ios::binary);
+	if (!input.is_open()) {
+		std::cerr << "Error: could not open file " << filename << std::endl;
+		clear();
+		return false;
+	}
+	return classify(input);
+}
+
+
+bool PerformanceClassifier::classify(std::istream& input) {
+	std::vector<uchar> data;
+	std::streampos start = input.tellg();
+	if ((start != (std::streampos)-1) && input.seekg(0, std::ios::end)) {
+		// read seekable input in a single block:
+		data.resize((size_t)(input.tellg() - start));
+		input.seekg(start);
+		input.read((char*)data.data(), data.size());
+		data.resize((size_t)input.gcount());
+	} else {
+		input.clear();
+		data.assign(std::istreambuf_iterator<char>(input),
+				std::istreambuf_iterator<char>());
+	}
+	if ((data.size() >= 4) && (memcmp(data.data(), "MThd", 4) == 0)) {
+		return classify(data.data(), data.size());
+	}
+
+	MidiFile midifile;
+	std::string contents(data.begin(), data.end());
+	std::stringstream stream(contents);
+	if (!midifile.read(stream)) {
+		clear();
+		return false;
+	}
+	return classify(midifile);
+}
+
+
+bool PerformanceClassifier::classify(const MidiFile& midifile) {
+	clear();
+	bool absoluteQ = midifile.isAbsoluteTicks();
+	for (int i=0; i<midifile.getTrackCount(); i++) {
+		startTrack();
+		const MidiEventList& list = midifile[i];
+		int tick = 0;
+		for (int j=0; j<list.size(); j++) {
+			const MidiEvent& event = list[j];
+			tick = absoluteQ ? event.tick : tick + event.tick;
+			if ((event.size() > 2) && ((event[0] & 0xf0) == 0x90) &&
+					(event[2] > 0)) {
+				m_ticks.push_back(tick);
+			}
+		}
+	}
+	analyze();
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// PerformanceClassifier::classify -- Scan the bytes of a Standard MIDI
+//     File and classify it.  Only the note-on times are extracted.
+//     Returns false if the data is not a valid MIDI file.
+//
+
+bool PerformanceClassifier::classify(const uchar* data, size_t size) {
+	clear();
+	if ((size < 14) || (memcmp(data, "MThd", 4) != 0)) {
+		return false;
+	}
+
+	size_t pos = 0;
+	while (pos + 8 <= size) {
+		const uchar* chunk = data + pos;
+		size_t length = ((size_t)chunk[4] << 24) | (chunk[5] << 16) |
+				(chunk[6] << 8) | chunk[7];
+		pos += 8;
+		if (length > size - pos) {
+			// Truncated chunk.
+			length = size - pos;
+		}
+		if (memcmp(chunk, "MTrk", 4) != 0) {
+			pos += length;
+			continue;
+		}
+
+		startTrack();
+		const uchar* p = data + pos;
+		const uchar* end = p + length;
+		pos += length;
+		int tick = 0;
+		uchar status = 0;
+		while (p < end) {
+			// delta time:
+			int delta = 0;
+			int count = 0;
+			do {
+				delta = (delta << 7) | (*p & 0x7f);
+				count++;
+			} while ((*p++ & 0x80) && (p < end) && (count < 4));
+			tick += delta;
+			if (p >= end) {
+				break;
+			}
+
+			if (*p & 0x80) {
+				status = *p++;
+			} else if (status == 0) {
+				clear();
+				return false;
+			}
+
+			if ((status == 0xff) || (status == 0xf0) || (status == 0xf7)) {
+				if ((status == 0xff) && (p < end)) {
+					p++; // meta message type
+				}
+				size_t datalength = 0;
+				while (p < end) {
+					datalength = (datalength << 7) | (*p & 0x7f);
+					if ((*p++ & 0x80) == 0) {
+						break;
+					}
+				}
+				p += std::min(datalength, (size_t)(end - p));
+				// System messages cancel running status.
+				status = 0;
+				continue;
+			}
+
+			int datacount = ((status & 0xe0) == 0xc0) ? 1 : 2;
+			if (end - p < datacount) {
+				break;
+			}
+			if (((status & 0xf0) == 0x90) && (p[1] > 0)) {
+				m_ticks.push_back(tick);
+			}
+			p += datacount;
+		}
+	}
+
+	analyze();
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// PerformanceClassifier::clear -- Remove the results of the last
+//     classification.
+//
+
+void PerformanceClassifier::clear(void) {
+	std::fill(m_histogram.begin(), m_histogram.end(), 0);
+	m_overflow = 0;
+	m_longIois.clear();
+	m_longCounts.clear();
+	m_ticks.clear();
+	m_trackStarts.clear();
+	m_noteCount  = 0;
+	m_type       = Unknown;
+	m_confidence = 0.0;
+}
+
+
+
+//////////////////////////////
+//
+// PerformanceClassifier::getType -- Return the classification of the
+//     last file.
+//
+
+PerformanceClassifier::Type PerformanceClassifier::getType(void) const {
+	return m_type;
+}
+
+
+
+//////////////////////////////
+//
+// PerformanceClassifier::getTypeName -- Return the name of a
+//     classification: "Unknown", "Empty", "Quantized" or "Performance".
+//
+
+const char* PerformanceClassifier::getTypeName(void) const {
+	return getTypeName(m_type);
+}
+
+
+const char* PerformanceClassifier::getTypeName(Type type) {
+	switch (type) {
+		case Empty:       return "Empty";
+		case Quantized:   return "Quantized";
+		case Performance: return "Performance";
+		default:          return "Unknown";
+	}
+}
+
+
+
+//////////////////////////////
+//
+// PerformanceClassifier::getConfidence -- Return the confidence of the
+//     classification, from 0.0 (a guess) to 1.0 (certain).  Unknown and
+//     Empty files have a confidence of 0.0.
+//
+
+double PerformanceClassifier::getConfidence(void) const {
+	return m_confidence;
+}
+
+
+
+//////////////////////////////
+//
+// PerformanceClassifier::getNoteCount -- Return the number of note-ons
+//     in the last file.
+//
+
+int PerformanceClassifier::getNoteCount(void) const {
+	return m_noteCount;
+}
+
+
+
+//////////////////////////////
+//
+// PerformanceClassifier::getIoiCount -- Return the number of IOIs with
+//     the given length in ticks.  Only lengths below
+//     PERFORMANCE_HISTOGRAM_SIZE are stored (see getOverflowCount()).
+//
+
+int PerformanceClassifier::getIoiCount(int ticks) const {
+	if ((ticks < 0) || (ticks >= (int)m_histogram.size())) {
+		return 0;
+	}
+	return m_histogram[ticks];
+}
+
+
+
+//////////////////////////////
+//
+// PerformanceClassifier::getOverflowCount -- Return the number of IOIs
+//     which are PERFORMANCE_HISTOGRAM_SIZE ticks or longer (but shorter
+//     than the cutoff).
+//
+
+int PerformanceClassifier::getOverflowCount(void) const {
+	return m_overflow;
+}
+
+
+
+//////////////////////////////
+//
+// PerformanceClassifier::classifyFiles -- Classify a list of MIDI files
+//     in parallel.  The results are stored in the same order as the
+//     filenames.
+//
+
+void PerformanceClassifier::classifyFiles(
+		const std::vector<std::string>& filenames,
+		std::vector<Result>& results, int cutoff) {
+	int count = (int)filenames.size();
+	results.resize(count);
+	// Each file is assumed to be worth about 10000 events of work.
+	int workload = count > INT_MAX / 10000 ? INT_MAX : count * 10000;
+	parallelFor(count, workload, [&](int index) {
+		// reuse the histogram and note storage for each file in a thread:
+		static thread_local PerformanceClassifier classifier;
+		classifier.setCutoff(cutoff);
+		Result& result = results[index];
+		result.status     = classifier.classify(filenames[index]);
+		result.type       = classifier.getType();
+		result.confidence = classifier.getConfidence();
+		result.noteCount  = classifier.getNoteCount();
+	});
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//
+// private functions
+//
+
+//////////////////////////////
+//
+// PerformanceClassifier::startTrack -- Mark the start of note-on times
+//    for a new track.
+//
+
+void PerformanceClassifier::startTrack(void) {
+	m_trackStarts.push_back((int)m_ticks.size());
+}
+
+
+
+//////////////////////////////
+//
+// PerformanceClassifier::analyze -- Merge the note-on times of all tracks
+//    into a single time-ordered list (each track is already in order),
+//    fill in the IOI histogram and then classify the file.
+//
+//    Classification rules:
+//    (1) If the shortest IOI is 0, it occurs more than 10 times, and
+//        the next shortest IOI is at least 10 ticks, then the file is
+//        quantized.  Confidence = 1 - 10 / (count of 0 IOIs).
+//    (2) Otherwise if the sixth shortest distinct IOI (or the longest one
+//        if there are fewer) is less than 10 ticks, then the file is a
+//        performance if the shortest IOI occurs less often than the next
+//        four shortest IOIs combined, or quantized if not.  Confidence
+//        = |a - b| / (a + b), where a is the count of the shortest IOI,
+//        and b is the count of the next four.
+//    (3) Otherwise the file type is unknown.
+//
+
+void PerformanceClassifier::analyze(void) {
+	m_noteCount = (int)m_ticks.size();
+	m_trackStarts.push_back(m_noteCount);
+
+	// Merge neighboring tracks until there is only one:
+	int segments = (int)m_trackStarts.size() - 1;
+	for (int width=1; width<segments; width*=2) {
+		for (int i=0; i+width<segments; i+=2*width) {
+			int last = std::min(i + 2 * width, segments);
+			std::inplace_merge(m_ticks.begin() + m_trackStarts[i],
+					m_ticks.begin() + m_trackStarts[i + width],
+					m_ticks.begin() + m_trackStarts[last]);
+		}
+	}
+
+	int ioicount = 0;
+	for (int i=1; i<m_noteCount; i++) {
+		int ioi = m_ticks[i] - m_ticks[i-1];
+		if (ioi < m_cutoff) {
+			addIoi(ioi);
+			ioicount++;
+		}
+	}
+
+	if (ioicount == 0) {
+		m_type = Empty;
+		m_confidence = 0.0;
+		return;
+	}
+
+	std::vector<int> iois;
+	std::vector<int> counts;
+	int size = getDistinctIois(iois, counts, PERFORMANCE_IOI_COUNT);
+
+	if ((size > 2) && (iois[0] == 0) && (counts[0] > 10) && (iois[1] >= 10)) {
+		m_type = Quantized;
+		m_confidence = 1.0 - 10.0 / counts[0];
+		return;
+	}
+
+	int last = std::min(size, PERFORMANCE_IOI_COUNT) - 1;
+	if ((size > 3) && (iois[last] < 10)) {
+		double a = counts[0];
+		double b = 0.0;
+		for (int i=1; (i<=4) && (i<size); i++) {
+			b += counts[i];
+		}
+		m_type = (a < b) ? Performance : Quantized;
+		m_confidence = std::fabs(a - b) / (a + b);
+		return;
+	}
+
+	m_type = Unknown;
+	m_confidence = 0.0;
+}
+
+
+
+//////////////////////////////
+//
+// PerformanceClassifier::addIoi -- Add an IOI to the histogram.  For IOIs
+//    which are too long for the histogram, the smallest few distinct
+//    values are kept in sorted order along with their counts.
+//
+
+void PerformanceClassifier::addIoi(int ticks) {
+	if (ticks < PERFORMANCE_HISTOGRAM_SIZE) {
+		m_histogram[ticks]++;
+		return;
+	}
+	m_overflow++;
+
+	int i = 0;
+	int size = (int)m_longIois.size();
+	while ((i < size) && (m_longIois[i] < ticks)) {
+		i++;
+	}
+	if ((i < size) && (m_longIois[i] == ticks)) {
+		m_longCounts[i]++;
+		return;
+	}
+	if (i >= PERFORMANCE_IOI_COUNT) {
+		return;
+	}
+	m_longIois.insert(m_longIois.begin() + i, ticks);
+	m_longCounts.insert(m_longCounts.begin() + i, 1);
+	if ((int)m_longIois.size() > PERFORMANCE_IOI_COUNT) {
+		m_longIois.pop_back();
+		m_longCounts.pop_back();
+	}
+}
+
+
+
+//////////////////////////////
+//
+// PerformanceClassifier::getDistinctIois -- Get up to max of the shortest
+//    distinct IOIs and their counts in increasing order of length.
+//    Returns the number of IOIs found.
+//
+
+int PerformanceClassifier::getDistinctIois(std::vector<int>& iois,
+		std::vector<int>& counts, int max) {
+	iois.clear();
+	counts.clear();
+	for (int i=0; i<(int)m_histogram.size(); i++) {
+		if (m_histogram[i] == 0) {
+			continue;
+		}
+		iois.push_back(i);
+		counts.push_back(m_histogram[i]);
+		if ((int)iois.size() >= max) {
+			return (int)iois.size();
+		}
+	}
+	for (int i=0; i<(int)m_longIois.size(); i++) {
+		iois.push_back(m_longIois[i]);
+		counts.push_back(m_longCounts[i]);
+		if ((int)iois.size() >= max) {
+			break;
+		}
+	}
+	return (int)iois.size();
+}
+
+
+} // end namespace smf
+
+
+
@@ -0,0 +1,748 @@
+//
+// Creation Date: Mon Oct 19 13:40:02 PDT 2026
+// Filename:      midifile/src-library/PianoRoll.cpp
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Piano-roll rendering of a MidiFile.  Note geometry is
+//                extracted from linked note-on/note-off pairs for each
+//                track (in parallel for large files), and can be written
+//                as an SVG image or as a PGM/PPM raster image for
+//                thumbnails.
+//
+
+#include "PianoRoll.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+
+
+namespace smf {
+
+//////////////////////////////
+//
+// PianoRoll::PianoRoll -- Constructor.
+//
+
+PianoRoll::PianoRoll(void) {
+	// do nothing
+}
+
+
+PianoRoll::PianoRoll(MidiFile& midifile) {
+	load(midifile);
+}
+
+
+
+//////////////////////////////
+//
+// PianoRoll::~PianoRoll -- Deconstructor.
+//
+
+PianoRoll::~PianoRoll() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// PianoRoll::setScale -- Set the size of a pitch row in the SVG output.
+//     Default value is 1.0.
+//
+
+void PianoRoll::setScale(double scale) {
+	if (scale > 0.0) {
+		m_scale = scale;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// PianoRoll::setAspectRatio -- Set the width of one second compared to the
+//     height of a pitch row in the SVG output.  Default value is 2.5.
+//
+
+void PianoRoll::setAspectRatio(double ratio) {
+	if (ratio > 0.0) {
+		m_aspectRatio = ratio;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// PianoRoll::setBorder -- Set the space around the notes in the SVG output
+//     (in units of pitch rows).  Default value is 1.0.
+//
+
+void PianoRoll::setBorder(double border) {
+	if (border >= 0.0) {
+		m_border = border;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// PianoRoll::setDrums -- Include notes on channel 10 (0x09) when loading
+//     a MIDI file.  Drum notes are ignored by default.
+//
+
+void PianoRoll::setDrums(bool state) {
+	m_drumQ = state;
+}
+
+
+
+//////////////////////////////
+//
+// PianoRoll::setSustain -- Use the sounding duration of notes when
+//     loading a MIDI file: notes released while the sustain pedal is down
+//     are extended until the pedal is released (see
+//     MidiEventList::getSustainedNoteEnds()).  Off by default.
+//
+
+void PianoRoll::setSustain(bool state) {
+	m_sustainQ = state;
+}
+
+
+
+//////////////////////////////
+//
+// PianoRoll::setLevelOfDetail -- Merge notes in the same pitch row which
+//     overlap or are separated by less than the given number of pixels
+//     (at the current scale and aspect ratio) in the SVG output.  Each
+//     track is then written as a single path rather than one rectangle
+//     per note.  A value of 0 (the default) disables merging.
+//
+
+void PianoRoll::setLevelOfDetail(double pixels) {
+	m_detail = pixels > 0.0 ? pixels : 0.0;
+}
+
+
+
+//////////////////////////////
+//
+// PianoRoll::getLevelOfDetail -- Return the merging threshold in pixels.
+//
+
+double PianoRoll::getLevelOfDetail(void) const {
+	return m_detail;
+}
+
+
+
+//////////////////////////////
+//
+// PianoRoll::load -- Extract the notes from a MIDI file.  Note-ons are
+//     linked to their note-offs and the time in seconds for each event is
+//     calculated if that has not been done already.  Each track is
+//     processed independently, so large files are processed in parallel.
+//     Returns the number of notes extracted.
+//
+
+int PianoRoll::load(MidiFile& midifile) {
+	clear();
+	midifile.linkNotePairs();
+	midifile.doTimeAnalysis();
+
+	int trackcount = midifile.getTrackCount();
+	int eventcount = 0;
+	for (int i=0; i<trackcount; i++) {
+		eventcount += midifile[i].size();
+	}
+
+	m_notes.resize(trackcount);
+	bool drumQ = m_drumQ;
+	bool sustainQ = m_sustainQ;
+	parallelFor(trackcount, eventcount, [&](int track) {
+		MidiEventList& list = midifile[track];
+		std::vector<PianoRollNote>& notes = m_notes[track];
+		std::vector<const MidiEvent*> ends;
+		if (sustainQ) {
+			list.getSustainedNoteEnds(ends);
+		}
+		int count = list.size();
+		int notecount = 0;
+		for (int i=0; i<count; i++) {
+			if (list[i].isNoteOn()) {
+				notecount++;
+			}
+		}
+		notes.reserve(notecount);
+		PianoRollNote note;
+		for (int i=0; i<count; i++) {
+			MidiEvent& event = list[i];
+			if (!event.isNoteOn()) {
+				continue;
+			}
+			note.channel = event.getChannelNibble();
+			if ((note.channel == 0x09) && !drumQ) {
+				continue;
+			}
+			note.start    = event.seconds;
+			if (sustainQ && (ends[i] != NULL)) {
+				note.duration = ends[i]->seconds - event.seconds;
+			} else {
+				note.duration = event.getDurationInSeconds();
+			}
+			note.key      = event.getKeyNumber();
+			note.velocity = event.getVelocity();
+			note.track    = track;
+			notes.push_back(note);
+		}
+	});
+
+	// Assign track colors by maximally spaced hue (same as mid2svg).
+	m_hues.resize(trackcount);
+	int tcount = 0;
+	for (int i=0; i<trackcount; i++) {
+		if (!m_notes[i].empty()) {
+			tcount++;
+		}
+	}
+	int index = 0;
+	for (int i=0; i<trackcount; i++) {
+		if (m_notes[i].empty()) {
+			m_hues[i] = -1.0;
+			continue;
+		}
+		m_hues[i] = (double)index++ / (double)tcount * 360.0;
+		for (auto& note : m_notes[i]) {
+			if ((m_minPitch < 0) || (note.key < m_minPitch)) {
+				m_minPitch = note.key;
+			}
+			if (note.key > m_maxPitch) {
+				m_maxPitch = note.key;
+			}
+			if (note.start + note.duration > m_duration) {
+				m_duration = note.start + note.duration;
+			}
+		}
+		m_noteCount += (int)m_notes[i].size();
+	}
+
+	return m_noteCount;
+}
+
+
+
+//////////////////////////////
+//
+// PianoRoll::clear -- Remove all notes.  Rendering options are not changed.
+//
+
+void PianoRoll::clear(void) {
+	m_notes.clear();
+	m_hues.clear();
+	m_noteCount = 0;
+	m_minPitch  = -1;
+	m_maxPitch  = -1;
+	m_duration  = 0.0;
+}
+
+
+
+//////////////////////////////
+//
+// PianoRoll::getTrackCount -- Return the number of tracks in the MIDI file
+//     which was loaded (including tracks without notes).
+//
+
+int PianoRoll::getTrackCount(void) const {
+	return (int)m_notes.size();
+}
+
+
+
+//////////////////////////////
+//
+// PianoRoll::getNoteCount -- Return the total number of notes in all tracks.
+//
+
+int PianoRoll::getNoteCount(void) const {
+	return m_noteCount;
+}
+
+
+
+//////////////////////////////
+//
+// PianoRoll::getTrackNotes -- Return the list of notes for a track.
+//
+
+const std::vector<PianoRollNote>& PianoRoll::getTrackNotes(int track) const {
+	return m_notes.at(track);
+}
+
+
+
+//////////////////////////////
+//
+// PianoRoll::getMinPitch -- Return the lowest key number of all notes,
+//     or -1 if there are no notes.
+//
+
+int PianoRoll::getMinPitch(void) const {
+	return m_minPitch;
+}
+
+
+
+//////////////////////////////
+//
+// PianoRoll::getMaxPitch -- Return the highest key number of all notes,
+//     or -1 if there are no notes.
+//
+
+int PianoRoll::getMaxPitch(void) const {
+	return m_maxPitch;
+}
+
+
+
+//////////////////////////////
+//
+// PianoRoll::getDuration -- Return the time in seconds of the end of
+//     the last note.
+//
+
+double PianoRoll::getDuration(void) const {
+	return m_duration;
+}
+
+
+
+//////////////////////////////
+//
+// PianoRoll::getTrackHue -- Return the color hue (0-360) for the notes
+//     of the given track, or -1 if the track does not contain any notes.
+//
+
+double PianoRoll::getTrackHue(int track) const {
+	return m_hues.at(track);
+}
+
+
+
+//////////////////////////////
+//
+// PianoRoll::writeSvg -- Write the notes as an SVG image.  Each track
+//     is written in its own group, with the first track drawn on top.
+//     The note data for each track is generated independently (in parallel
+//     for large files) and then written in track order, so the output
+//     is the same regardless of the number of threads used.
+//
+
+bool PianoRoll::writeSvg(std::ostream& out) {
+	int minpitch = m_minPitch < 0 ? 0 : m_minPitch;
+	int maxpitch = m_maxPitch < 0 ? 0 : m_maxPitch;
+	double width  = (m_duration * m_aspectRatio + 2 * m_border) * m_scale;
+	double height = (maxpitch - minpitch + 1 + 2 * m_border) * m_scale;
+
+	out << "<?xml version=\"1.0\""
+	    << " encoding=\"UTF-8\""
+	    << " standalone=\"no\""
+	    << "?>\n";
+	out << "<!DOCTYPE svg PUBLIC \"-//W3C//DTD SVG 1.1//EN\""
+	    << " \"http://www.w3.org/Graphics/SVG/1.1/DTD/svg11.dtd\""
+	    << ">\n";
+	out << "<svg"
+	    << " version=\"1.1\""
+	    << " xmlns=\"http://www.w3.org/2000/svg\""
+	    << " xmlns:xlink=\"http://www.w3.org/1999/xlink\""
+	    << " viewBox=\"" << -m_border * m_scale << " "
+	                     << -m_border * m_scale << " "
+	                     << width << " " << height << "\""
+	    << " width=\"" << width << "\""
+	    << " height=\"" << height << "\""
+	    << ">\n";
+	out << "<g"
+	    << " transform=\""
+	    << "scale(" << m_scale * m_aspectRatio << ", " << -m_scale << ")"
+	    << " translate(0, " << -(maxpitch+1) << ")"
+	    << "\" >\n";
+
+	int trackcount = getTrackCount();
+	std::vector<std::string> tracks(trackcount);
+	parallelFor(trackcount, m_noteCount * 10, [&](int track) {
+		writeSvgTrack(tracks[track], track);
+	});
+	for (int i=trackcount-1; i>=0; i--) {
+		out.write(tracks[i].data(), tracks[i].size());
+	}
+
+	out << "</g>\n";
+	out << "</svg>\n";
+	return !out.fail();
+}
+
+
+
+//////////////////////////////
+//
+// PianoRoll::writePgm -- Write the notes as a binary grayscale raster
+//     image (black notes on a white background).  Time goes from left to
+//     right and pitch from bottom to top.  Notes are at least one pixel
+//     in size.
+//
+
+bool PianoRoll::writePgm(std::ostream& out, int width, int height) {
+	return writeRaster(out, width, height, false);
+}
+
+
+
+//////////////////////////////
+//
+// PianoRoll::writePpm -- Write the notes as a binary color raster
+//     image, using the same track colors as the SVG output.
+//
+
+bool PianoRoll::writePpm(std::ostream& out, int width, int height) {
+	return writeRaster(out, width, height, true);
+}
+
+
+
+//////////////////////////////
+//
+// PianoRoll::writeNumber -- Write a number into a character buffer with
+//     at most the given number of digits after the decimal point (trailing
+//     zeros are removed).  Returns a pointer to the character after the
+//     number (no null terminator is added).  The buffer must have space
+//     for at least 32 characters.
+//
+
+char* PianoRoll::writeNumber(char* buffer, double value, int decimals) {
+	static const long long powers[10] = { 1, 10, 100, 1000, 10000, 100000,
+			1000000, 10000000, 100000000, 1000000000 };
+	if (decimals < 0) {
+		decimals = 0;
+	} else if (decimals > 9) {
+		decimals = 9;
+	}
+	if (!std::isfinite(value)) {
+		*buffer++ = '0';
+		return buffer;
+	}
+	double scaled = std::fabs(value) * powers[decimals];
+	if (scaled >= 9.0e18) {
+		int count = snprintf(buffer, 32, "%g", value);
+		return buffer + count;
+	}
+	unsigned long long number = (unsigned long long)(scaled + 0.5);
+	unsigned long long integer  = number / powers[decimals];
+	unsigned long long fraction = number % powers[decimals];
+	if ((value < 0.0) && (number != 0)) {
+		*buffer++ = '-';
+	}
+
+	char digits[24];
+	int count = 0;
+	do {
+		digits[count++] = (char)('0' + integer % 10);
+		integer /= 10;
+	} while (integer);
+	while (count) {
+		*buffer++ = digits[--count];
+	}
+
+	if (fraction) {
+		while (fraction % 10 == 0) {
+			fraction /= 10;
+			decimals--;
+		}
+		*buffer++ = '.';
+		for (int i=decimals-1; i>=0; i--) {
+			buffer[i] = (char)('0' + fraction % 10);
+			fraction /= 10;
+		}
+		buffer += decimals;
+	}
+	return buffer;
+}
+
+
+//////////////////////////////
+//
+// PianoRoll::mergeNotes -- Merge notes with the same key which overlap or
+//     are separated by no more than the gap (in seconds) into spans.  The
+//     notes are grouped by key with a counting sort, and notes for each
+//     key must already be in start-time order (as in a track list).  The
+//     spans are stored in key order, with the maximum velocity of the
+//     merged notes.
+//
+
+void PianoRoll::mergeNotes(std::vector<PianoRollNote>& spans,
+		const std::vector<PianoRollNote>& notes, double gap) {
+	spans.clear();
+	if (notes.empty()) {
+		return;
+	}
+	int minkey = notes[0].key;
+	int maxkey = notes[0].key;
+	for (auto& note : notes) {
+		minkey = std::min(minkey, note.key);
+		maxkey = std::max(maxkey, note.key);
+	}
+
+	std::vector<int> offsets(maxkey - minkey + 2, 0);
+	for (auto& note : notes) {
+		offsets[note.key - minkey + 1]++;
+	}
+	for (int i=1; i<(int)offsets.size(); i++) {
+		offsets[i] += offsets[i-1];
+	}
+	std::vector<const PianoRollNote*> sorted(notes.size());
+	for (auto& note : notes) {
+		sorted[offsets[note.key - minkey]++] = &note;
+	}
+
+	PianoRollNote span;
+	double spanend = 0.0;
+	bool activeQ = false;
+	for (const PianoRollNote* note : sorted) {
+		if (activeQ && (note->key == span.key) &&
+				(note->start <= spanend + gap)) {
+			spanend = std::max(spanend, note->start + note->duration);
+			span.velocity = std::max(span.velocity, note->velocity);
+			continue;
+		}
+		if (activeQ) {
+			span.duration = spanend - span.start;
+			spans.push_back(span);
+		}
+		span = *note;
+		spanend = note->start + note->duration;
+		activeQ = true;
+	}
+	span.duration = spanend - span.start;
+	spans.push_back(span);
+}
+
+
+
+//////////////////////////////
+//
+// PianoRoll::writeSvgPath -- Append SVG path data for a list of notes
+//     (or merged spans) to the output string, with each note being a box
+//     of height 1 at its key number.
+//
+
+void PianoRoll::writeSvgPath(std::string& output,
+		const std::vector<PianoRollNote>& spans) {
+	size_t start = output.size();
+	// 3 numbers of at most 32 characters plus the fixed text:
+	output.resize(start + spans.size() * (3 * 32 + 16));
+	char* p = &output[start];
+	char* begin = p;
+	for (auto& span : spans) {
+		*p++ = 'M';
+		p = writeNumber(p, span.start);
+		*p++ = ' ';
+		p = writeNumber(p, span.key, 0);
+		*p++ = 'h';
+		p = writeNumber(p, span.duration);
+		memcpy(p, "v1h-", 4);
+		p = writeNumber(p + 4, span.duration);
+		*p++ = 'z';
+	}
+	output.resize(start + (p - begin));
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//
+// private functions
+//
+
+//////////////////////////////
+//
+// PianoRoll::writeSvgTrack -- Generate the SVG group for a single track.
+//    The output string is sized for the largest possible note data and
+//    then trimmed, so the numbers are written directly into its storage.
+//
+
+void PianoRoll::writeSvgTrack(std::string& output, int track) {
+	const std::vector<PianoRollNote>& notes = m_notes[track];
+	output.clear();
+	if (notes.empty()) {
+		return;
+	}
+
+	char header[128];
+	int hlen = snprintf(header, sizeof(header),
+			"\t<g class=\"track-%d\" style=\"fill:hsl(%g, 100%%, 75%%);\" >\n",
+			track, m_hues[track]);
+	static const char footer[] = "\t</g>\n";
+
+	if (m_detail > 0.0) {
+		std::vector<PianoRollNote> spans;
+		mergeNotes(spans, notes, m_detail / (m_scale * m_aspectRatio));
+		output.append(header, hlen);
+		output += "\t\t<path d=\"";
+		writeSvgPath(output, spans);
+		output += "\" />\n";
+		output += footer;
+		return;
+	}
+
+	// 3 numbers of at most 32 characters plus the fixed text:
+	const int maxnote = 3 * 32 + 64;
+	output.resize(hlen + notes.size() * maxnote + sizeof(footer));
+	char* start = &output[0];
+	char* p = start;
+
+	memcpy(p, header, hlen);
+	p += hlen;
+	for (auto& note : notes) {
+		memcpy(p, "\t\t<rect x=\"", 11);
+		p = writeNumber(p + 11, note.start);
+		memcpy(p, "\" y=\"", 5);
+		p = writeNumber(p + 5, note.key, 0);
+		memcpy(p, "\" width=\"", 9);
+		p = writeNumber(p + 9, note.duration);
+		memcpy(p, "\" height=\"1\" />\n", 16);
+		p += 16;
+	}
+	memcpy(p, footer, sizeof(footer) - 1);
+	p += sizeof(footer) - 1;
+
+	output.resize(p - start);
+}
+
+
+
+//////////////////////////////
+//
+// PianoRoll::writeRaster -- Write a PGM (colorQ == false) or PPM
+//    (colorQ == true) image of the notes.  The image is divided into
+//    horizontal bands which are filled in parallel, with each band drawing
+//    only the parts of the notes which fall inside of it.
+//
+
+bool PianoRoll::writeRaster(std::ostream& out, int width, int height,
+		bool colorQ) {
+	if ((width <= 0) || (height <= 0)) {
+		std::cerr << "Error: invalid raster size " << width << "x"
+		          << height << std::endl;
+		return false;
+	}
+
+	int channels = colorQ ? 3 : 1;
+	std::vector<uchar> pixels((size_t)width * height * channels, 255);
+
+	int trackcount = getTrackCount();
+	std::vector<uchar> colors(trackcount * 3, 0);
+	if (colorQ) {
+		for (int i=0; i<trackcount; i++) {
+			if (m_hues[i] >= 0.0) {
+				hueToRgb(m_hues[i], &colors[i*3]);
+			}
+		}
+	}
+
+	int minpitch = m_minPitch < 0 ? 0 : m_minPitch;
+	int maxpitch = m_maxPitch < 0 ? 0 : m_maxPitch;
+	double rowheight = (double)height / (maxpitch - minpitch + 1);
+	double xscale = m_duration > 0.0 ? width / m_duration : 0.0;
+
+	// Sort the notes into the bands that they cross, keeping the drawing
+	// order (later tracks first so that the first track is on top):
+	int bandcount = std::min(height, 64);
+	std::vector<std::vector<const PianoRollNote*>> bands(bandcount);
+	for (int t=trackcount-1; t>=0; t--) {
+		for (auto& note : m_notes[t]) {
+			int y0 = (int)((maxpitch - note.key) * rowheight);
+			int y1 = std::max(y0 + 1, (int)((maxpitch - note.key + 1) * rowheight));
+			int b0 = (int)((long long)y0 * bandcount / height);
+			int b1 = (int)((long long)(std::min(y1, height) - 1) * bandcount / height);
+			for (int b=b0; b<=b1; b++) {
+				bands[b].push_back(&note);
+			}
+		}
+	}
+
+	parallelFor(bandcount, m_noteCount, [&](int band) {
+		int top    = (int)(((long long)height * band + bandcount - 1) / bandcount);
+		int bottom = (int)(((long long)height * (band + 1) + bandcount - 1) / bandcount);
+		for (const PianoRollNote* note : bands[band]) {
+			const uchar* color = &colors[note->track * 3];
+			int y0 = (int)((maxpitch - note->key) * rowheight);
+			int y1 = std::max(y0 + 1, (int)((maxpitch - note->key + 1) * rowheight));
+			y0 = std::max(y0, top);
+			y1 = std::min(y1, bottom);
+			int x0 = (int)(note->start * xscale);
+			int x1 = std::max(x0 + 1,
+					(int)((note->start + note->duration) * xscale));
+			x0 = std::max(x0, 0);
+			x1 = std::min(x1, width);
+			if (x1 <= x0) {
+				continue;
+			}
+			for (int y=y0; y<y1; y++) {
+				uchar* row = &pixels[((size_t)y * width + x0) * channels];
+				if (colorQ) {
+					for (int x=x0; x<x1; x++) {
+						*row++ = color[0];
+						*row++ = color[1];
+						*row++ = color[2];
+					}
+				} else {
+					memset(row, 0, x1 - x0);
+				}
+			}
+		}
+	});
+
+	out << (colorQ ? "P6" : "P5") << "\n"
+	    << width << " " << height << "\n"
+	    << "255\n";
+	out.write((const char*)pixels.data(), pixels.size());
+	return !out.fail();
+}
+
+
+
+//////////////////////////////
+//
+// PianoRoll::hueToRgb -- Convert a hue (0-360) to an RGB color with
+//    100% saturation and 75% lightness (the SVG note color).
+//
+
+void PianoRoll::hueToRgb(double hue, uchar* rgb) {
+	const double lightness = 0.75;
+	const double chroma = (1.0 - std::fabs(2 * lightness - 1.0));
+	double h = std::fmod(hue, 360.0) / 60.0;
+	double x = chroma * (1.0 - std::fabs(std::fmod(h, 2.0) - 1.0));
+	double r = 0.0, g = 0.0, b = 0.0;
+	if      (h < 1.0) { r = chroma; g = x; }
+	else if (h < 2.0) { r = x; g = chroma; }
+	else if (h < 3.0) { g = chroma; b = x; }
+	else if (h < 4.0) { g = x; b = chroma; }
+	else if (h < 5.0) { r = x; b = chroma; }
+	else              { r = chroma; b = x; }
+	double m = lightness - chroma / 2.0;
+	rgb[0] = (uchar)std::lround((r + m) * 255.0);
+	rgb[1] = (uchar)std::lround((g + m) * 255.0);
+	rgb[2] = (uchar)std::lround((b + m) * 255.0);
+}
+
+
+} // end namespace smf
+
+
+
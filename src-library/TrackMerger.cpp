@@ -0,0 +1,268 @@
+//
+// Creation Date: Wed Oct 21 09:26:15 PDT 2026
+// Filename:      midifile/src-library/TrackMerger.cpp
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Iterate over the events of all tracks in a MidiFile in
+//                the order that joinTracks() would place them, without
+//                modifying the MidiFile.  A cursor is kept for each
+//                track, and a tournament tree of the cursors selects the
+//                next event, so each step takes O(log tracks) time.  The
+//                MidiFile may be in delta or absolute tick mode, and is
+//                only accessed through const functions, so several
+//                TrackMergers can read the same file concurrently.
+//
+
+#include "TrackMerger.h"
+
+
+namespace smf {
+
+//////////////////////////////
+//
+// TrackMerger::TrackMerger -- Constructor.
+//
+
+TrackMerger::TrackMerger(void) {
+	m_index = m_indexBuffer;
+	m_tick  = m_tickBuffer;
+	m_tree  = m_treeBuffer;
+}
+
+
+TrackMerger::TrackMerger(const MidiFile& midifile) {
+	m_index = m_indexBuffer;
+	m_tick  = m_tickBuffer;
+	m_tree  = m_treeBuffer;
+	setFile(midifile);
+}
+
+
+
+//////////////////////////////
+//
+// TrackMerger::~TrackMerger -- Deconstructor.
+//
+
+TrackMerger::~TrackMerger() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// TrackMerger::setFile -- Start iterating over the events of a MidiFile.
+//     The MidiFile must not be modified while it is being iterated over.
+//     Each track must be sorted in time order (as they are when a file is
+//     read, or after MidiFile::sortTracks()).  Memory is only allocated
+//     for files with more than TRACKMERGER_TRACKS tracks.
+//
+
+void TrackMerger::setFile(const MidiFile& midifile) {
+	m_file = &midifile;
+	m_trackCount = midifile.getTrackCount();
+	m_deltaQ = midifile.isDeltaTicks();
+	m_leaves = 2;
+	while (m_leaves < m_trackCount) {
+		m_leaves *= 2;
+	}
+	if (m_leaves > TRACKMERGER_TRACKS) {
+		m_storage.resize(3 * m_leaves);
+		m_index = m_storage.data();
+		m_tick  = m_index + m_leaves;
+		m_tree  = m_tick + m_leaves;
+	} else {
+		m_index = m_indexBuffer;
+		m_tick  = m_tickBuffer;
+		m_tree  = m_treeBuffer;
+	}
+	reset();
+}
+
+
+
+//////////////////////////////
+//
+// TrackMerger::reset -- Go back to before the first event of the file.
+//
+
+void TrackMerger::reset(void) {
+	for (int i=0; i<m_trackCount; i++) {
+		m_index[i] = 0;
+		// the first delta tick of a track is also its absolute tick
+		m_tick[i] = (*m_file)[i].size() > 0 ? (*m_file)[i][0].tick : 0;
+	}
+	m_current  = -1;
+	m_position = -1;
+}
+
+
+
+//////////////////////////////
+//
+// TrackMerger::next -- Move to the next event in time order.  Returns
+//     false when there are no more events.  Events at the same tick are
+//     ordered by the rules of eventcompare() (which uses their sequence
+//     numbers first, if both have one; see MidiFile::markSequence()).
+//     Events which it cannot order are returned in track order.
+//
+
+bool TrackMerger::next(void) {
+	if (m_file == NULL) {
+		return false;
+	}
+	if (m_position < 0) {
+		// first event: play the whole tournament
+		for (int node=m_leaves-1; node>0; node--) {
+			m_tree[node] = getWinner(node);
+		}
+	} else if (m_current < 0) {
+		return false;
+	} else {
+		// advance the cursor of the previous winner and replay its matches
+		int track = m_current;
+		const MidiEventList& events = (*m_file)[track];
+		if (++m_index[track] < events.size()) {
+			int tick = events[m_index[track]].tick;
+			m_tick[track] = m_deltaQ ? m_tick[track] + tick : tick;
+		}
+		for (int node=(m_leaves + track) >> 1; node>0; node >>= 1) {
+			m_tree[node] = getWinner(node);
+		}
+	}
+	m_current = m_tree[1];
+	if (m_current < 0) {
+		return false;
+	}
+	m_position++;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// TrackMerger::getTrack -- Return the track of the current event, or -1
+//     if there is no current event.
+//
+
+int TrackMerger::getTrack(void) const {
+	return m_current;
+}
+
+
+
+//////////////////////////////
+//
+// TrackMerger::getIndex -- Return the index of the current event in its
+//     track, or -1 if there is no current event.
+//
+
+int TrackMerger::getIndex(void) const {
+	return m_current < 0 ? -1 : m_index[m_current];
+}
+
+
+
+//////////////////////////////
+//
+// TrackMerger::getTick -- Return the absolute tick of the current event
+//     (also when the MidiFile is in delta tick mode).
+//
+
+int TrackMerger::getTick(void) const {
+	return m_current < 0 ? -1 : m_tick[m_current];
+}
+
+
+
+//////////////////////////////
+//
+// TrackMerger::getPosition -- Return the index that the current event
+//     would have after joinTracks().
+//
+
+int TrackMerger::getPosition(void) const {
+	return m_position;
+}
+
+
+
+//////////////////////////////
+//
+// TrackMerger::getEvent -- Return the current event.  Only valid after
+//     next() has returned true.
+//
+
+const MidiEvent& TrackMerger::getEvent(void) const {
+	return (*m_file)[m_current][m_index[m_current]];
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//
+// private functions
+//
+
+//////////////////////////////
+//
+// TrackMerger::getLeaf -- Return the track number for a leaf of the
+//     tournament tree, or -1 if the track does not exist or has ended.
+//
+
+int TrackMerger::getLeaf(int leaf) const {
+	if (leaf >= m_trackCount) {
+		return -1;
+	}
+	return m_index[leaf] < (*m_file)[leaf].size() ? leaf : -1;
+}
+
+
+
+//////////////////////////////
+//
+// TrackMerger::getWinner -- Return the track with the earliest event
+//     from the two children of a node in the tournament tree.  Ties go
+//     to the left child, which has the lower track numbers.
+//
+
+int TrackMerger::getWinner(int node) const {
+	int left  = 2 * node;
+	int right = left + 1;
+	int track1 = left  >= m_leaves ? getLeaf(left  - m_leaves) : m_tree[left];
+	int track2 = right >= m_leaves ? getLeaf(right - m_leaves) : m_tree[right];
+	if (track1 < 0) {
+		return track2;
+	} else if (track2 < 0) {
+		return track1;
+	}
+	return isBefore(track2, track1) ? track2 : track1;
+}
+
+
+
+//////////////////////////////
+//
+// TrackMerger::isBefore -- Return true if the event at the cursor of
+//     track1 must come before the event at the cursor of track2.  The
+//     absolute ticks are compared here, since the events may hold delta
+//     ticks, and events at the same tick are compared with
+//     eventcompareAtTick().
+//
+
+bool TrackMerger::isBefore(int track1, int track2) const {
+	if (m_tick[track1] != m_tick[track2]) {
+		return m_tick[track1] < m_tick[track2];
+	}
+	return eventcompareAtTick((*m_file)[track1][m_index[track1]],
+			(*m_file)[track2][m_index[track2]]) < 0;
+}
+
+
+} // end namespace smf
+
+
+
@@ -2,17 +2,26 @@
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Thu Feb 19 20:43:49 PST 2015
 // Last Modified: Thu Feb 19 20:43:52 PST 2015
+// Last Modified: Wed Oct 21 09:26:15 PDT 2026 Join tracks with TrackMerger.
+// Last Modified: Wed Oct 21 13:02:51 PDT 2026 Added -p option.
+// Last Modified: Wed Oct 21 16:40:12 PDT 2026 Added -l option.
 // Filename:      midifile/src-programs/durations.cpp
 // Website:       http://midifile.sapp.org
 // Syntax:        C++11
 //
 // Description:   Print note durations in a MidiFile.  Note-ons with no
 //                no matching note-offs (such as for rhythm-channel
-//                events) will have a duration of 0.
+//                events) will have a duration of 0.  With the -p option,
+//                notes released while the sustain pedal is down last
+//                until the pedal is released.  The -l option selects
+//                which note-on is ended by a note-off when notes on the
+//                same key overlap (lifo, fifo or velocity).
 //
 
 #include "Options.h"
 #include "MidiFile.h"
+#include "NoteLinker.h"
+#include "TrackMerger.h"
 #include <iostream>
 
 using namespace std;
@@ -23,11 +32,15 @@ Options  options;
 int      quarterQ = 0;  // used with -q option: time units in quarter notes.
 int      joinQ    = 0;  // used with -j option: join tracks before printing.
 int      secondsQ = 0;  // used with -s option: print times in seconds.
+int      pedalQ   = 0;  // used with -p option: include sustain pedal.
+NoteLinker::Policy LinkPolicy = NoteLinker::LIFO; // used with -l option
 
 // function declarations:
 void     checkOptions        (Options& opts);
 void     example             (void);
 void     usage               (const string& command);
+void     printNote           (const MidiEvent& event, int tpq,
+                              const MidiEvent* end);
 
 ///////////////////////////////////////////////////////////////////////////
 
@@ -48,12 +61,12 @@ int main(int argc, char** argv) {
    }
 
    int tpq = midifile.getTicksPerQuarterNote();
-   midifile.linkNotePairs();
-   if (joinQ) {
-      midifile.joinTracks();
+   NoteLinker linker(LinkPolicy);
+   midifile.linkNotePairs(linker);
+   if (linker.getUnmatchedCount() > 0) {
+      cerr << "Warning: " << linker.getUnmatchedCount()
+           << " unmatched note-ons/offs" << endl;
    }
-   MidiEvent* mev;
-   double duration;
 
    if (secondsQ) {
       midifile.doTimeAnalysis();
@@ -68,31 +81,27 @@ int main(int argc, char** argv) {
    }
    cout << "============================\n";
 
+   // sounding ends of notes held by the sustain pedal:
+   vector<vector<const MidiEvent*>> ends(midifile.getTrackCount());
+   if (pedalQ) {
+      for (int track=0; track < midifile.getTrackCount(); track++) {
+         midifile[track].getSustainedNoteEnds(ends[track]);
+      }
+   }
+
+   if (joinQ) {
+      // visit all tracks in time order without joining them
+      TrackMerger merger(midifile);
+      while (merger.next()) {
+         printNote(merger.getEvent(), tpq, pedalQ ?
+               ends[merger.getTrack()][merger.getIndex()] : NULL);
+      }
+      return 0;
+   }
+
    for (int track=0; track < midifile.getTrackCount(); track++) {
       for (int i=0; i<midifile[track].size(); i++) {
-         mev = &midifile[track][i];
-         if (!mev->isNoteOn()) {
-            continue;
-         }
-         if (secondsQ) {
-            duration = mev->getDurationInSeconds();
-         } else {
-            duration = mev->getTickDuration();
-         }
-
-         if (secondsQ) {
-            cout << mev->seconds << '\t';
-            cout << duration << '\t';
-         } else if (quarterQ) {
-            cout << mev->tick/tpq << '\t';
-            cout << duration/tpq << '\t';
-         } else {
-            cout << mev->tick << '\t';
-            cout << duration << '\t';
-         }
-         cout << mev->track << '\t';
-         cout << mev->getKeyNumber();
-         cout << endl;
+         printNote(midifile[track][i], tpq, pedalQ ? ends[track][i] : NULL);
       }
       if (midifile.getTrackCount() > 1) {
          cout << endl;
@@ -105,6 +114,45 @@ int main(int argc, char** argv) {
 ///////////////////////////////////////////////////////////////////////////
 
 
+//////////////////////////////
+//
+// printNote -- Print the time, duration, track and key number of a
+//     note-on (other events are ignored).  If end is not NULL, it is the
+//     event which stops the note from sounding.
+//
+
+void printNote(const MidiEvent& event, int tpq, const MidiEvent* end) {
+   if (!event.isNoteOn()) {
+      return;
+   }
+   double duration;
+   if (end && secondsQ) {
+      duration = end->seconds - event.seconds;
+   } else if (end) {
+      duration = end->tick - event.tick;
+   } else if (secondsQ) {
+      duration = event.getDurationInSeconds();
+   } else {
+      duration = event.getTickDuration();
+   }
+
+   if (secondsQ) {
+      cout << event.seconds << '\t';
+      cout << duration << '\t';
+   } else if (quarterQ) {
+      cout << event.tick/tpq << '\t';
+      cout << duration/tpq << '\t';
+   } else {
+      cout << event.tick << '\t';
+      cout << duration << '\t';
+   }
+   cout << event.track << '\t';
+   cout << event.getKeyNumber();
+   cout << endl;
+}
+
+
+
 //////////////////////////////
 //
 // checkOptions --
@@ -114,6 +162,8 @@ void checkOptions(Options& opts) {
    opts.define("q|quarter=b", "Display ticks in quarter note units");
    opts.define("j|join=b",    "Join tracks before printing");
    opts.define("s|seconds=b", "Display times in seconds");
+   opts.define("p|pedal=b",   "Extend durations while sustain pedal is down");
+   opts.define("l|link=s:lifo", "Pairing of overlapping notes: lifo, fifo or velocity");
 
    opts.define("author=b",   "Author of the program");
    opts.define("version=b",  "Version of the program");
@@ -140,6 +190,19 @@ void checkOptions(Options& opts) {
    quarterQ  = opts.getBoolean("quarter");
    joinQ     = opts.getBoolean("join");
    secondsQ  = opts.getBoolean("seconds");
+   pedalQ    = opts.getBoolean("pedal");
+
+   string link = opts.getString("link");
+   if (link == "lifo") {
+      LinkPolicy = NoteLinker::LIFO;
+   } else if (link == "fifo") {
+      LinkPolicy = NoteLinker::FIFO;
+   } else if (link == "velocity") {
+      LinkPolicy = NoteLinker::Velocity;
+   } else {
+      cerr << "Error: unknown link policy: " << link << endl;
+      exit(1);
+   }
    if (secondsQ) {
       quarterQ = 0;
    }
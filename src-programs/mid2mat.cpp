@@ -5,6 +5,7 @@
 // Last Modified: Mon Sep  6 23:21:17 PDT 2004 Changed pow(2) to pow(2.0).
 // Last Modified: Fri Jul 23 12:32:31 PDT 2010 Generalized tempo parsing.
 // Last Modified: Mon Feb  9 21:17:36 PST 2015 Updated for C++11.
+// Last Modified: Tue Oct 20 17:12:40 PDT 2026 Use FeatureMatrix, multiple files.
 // Filename:      ...sig/examples/all/mid2mat.cpp
 // Web Address:   http://sig.sapp.org/examples/museinfo/midi/mid2mat.cpp
 // Syntax:        C++; museinfo
@@ -18,6 +19,7 @@
 //    tpq     = ticks per quarter note
 //
 
+#include "FeatureMatrix.h"
 #include "MidiFile.h"
 #include "Options.h"
 
@@ -28,6 +30,8 @@
 #include <vector>
 #include <iostream>
 #include <iomanip>
+#include <fstream>
+#include <string>
 
 using namespace std;
 using namespace smf;
@@ -39,12 +43,12 @@ using namespace smf;
 #define MSEC 4            /* time units are millisecodns (absolute)        */
 
 // Data which can be found in the final data array:
-#define OP_NOTE    1000   /* Note Event                  */
-#define OP_CONTROL 2000   /* Continuous-Controller Event */
-#define OP_INSTR   3000   /* Instrument Change Event     */
-#define OP_TEMPO   4000   /* Tempo Meta Event            */
-#define OP_METER   5000   /* Meter Meta Event            */
-#define OP_KEYSIG  6000   /* Key Signature Event         */
+#define OP_NOTE    FeatureMatrix::Note          /* Note Event                  */
+#define OP_CONTROL FeatureMatrix::Control       /* Continuous-Controller Event */
+#define OP_INSTR   FeatureMatrix::Instrument    /* Instrument Change Event     */
+#define OP_TEMPO   FeatureMatrix::Tempo         /* Tempo Meta Event            */
+#define OP_METER   FeatureMatrix::Meter         /* Meter Meta Event            */
+#define OP_KEYSIG  FeatureMatrix::KeySignature  /* Key Signature Event         */
 
 #define OP_NOTE_NAME    "NOTE"
 #define OP_CONTROL_NAME "CONT"
@@ -81,10 +85,6 @@ const char *GMinstrument[128] = {
    "applause",  "ringwhsl"
 };
 
-vector<int> legend_instr;
-vector<int> legend_opcode;
-vector<int> legend_controller;
-
 // user interface variables
 Options options;
 int     debugQ   = 0;           // use with --debug option
@@ -97,26 +97,23 @@ double  unused   = -1000.0;     // used with -u option
 char    arrayname[1024] = {0};  // used with -n option
 int     timetype = SEC;
 int     numQ     = 0;
+int     npyQ     = 0;           // used with --npy option
+int     rawQ     = 0;           // used with --raw option
+int     floatQ   = 0;           // used with -f option
 double  tempo    = 60.0;
-int     maxcount = 100000;
-vector<vector<double> > matlabarray;
 
 // function declarations:
-void      convertMidiFile       (MidiFile& midifile,
-                                 vector<vector<double> >& matlab);
+void      convertMidiFile       (MidiFile& midifile);
 //void    setTempo              (MidiFile& midifile, int index, double& tempo);
 void      checkOptions          (Options& opts, int argc, char** argv);
 void      example               (void);
 void      usage                 (const char* command);
 double    getTime               (int ticks, MidiFile& midifile);
-void      processMetaEvent      (MidiFile& midifile, int i,
-                                 vector<double>& event);
-void      printEvent            (vector<double>& event);
-void      printLegend           (MidiFile& midifile);
-void      printMatlabArray      (MidiFile& midifile,
-                                 vector<vector<double> >& matlab);
-void      sortArray             (vector<vector<double> >& matlab);
-int       eventcmp              (const void* a, const void* b);
+void      processMetaEvent      (MidiFile& midifile, int i);
+void      printEvent            (const double* event, int size);
+void      printLegend           (const FeatureMatrix& matrix,
+                                 vector<int>& opcodes);
+void      printMatlabArray      (const FeatureMatrix& matrix);
 void      printOpcodeVariables  (vector<int> opcodes);
 void      printOpName           (int code);
 
@@ -124,20 +121,60 @@ void      printOpName           (int code);
 //////////////////////////////////////////////////////////////////////////
 
 int main(int argc, char* argv[]) {
-   matlabarray.reserve(100000);
-   matlabarray.clear();
+   checkOptions(options, argc, argv);
 
-   legend_instr.resize(128);
-   legend_opcode.resize(128);
-   legend_controller.resize(128);
+   vector<string> filenames;
+   for (int i=1; i<=options.getArgCount(); i++) {
+      filenames.push_back(options.getArg(i));
+   }
 
-   checkOptions(options, argc, argv);
-   MidiFile midifile(options.getArg(1));
+   if (verboseQ) {
+      for (int i=0; i<(int)filenames.size(); i++) {
+         MidiFile midifile(filenames[i]);
+         convertMidiFile(midifile);
+      }
+      return 0;
+   }
+
+   FeatureMatrix settings;
+   settings.setUnused(unused);
+   settings.setSinglePrecision(floatQ);
+   switch (timetype) {
+      case TICK: settings.setTimeUnit(FeatureMatrix::Ticks);        break;
+      case BEAT: settings.setTimeUnit(FeatureMatrix::Beats);        break;
+      case SEC:  settings.setTimeUnit(FeatureMatrix::Seconds);      break;
+      case MSEC: settings.setTimeUnit(FeatureMatrix::Milliseconds); break;
+   }
 
-   convertMidiFile(midifile, matlabarray);
-   if (!verboseQ) {
-      printMatlabArray(midifile, matlabarray);
+   if (npyQ || rawQ) {
+      FeatureMatrix::Format format = npyQ ? FeatureMatrix::Npy : FeatureMatrix::Raw;
+      ofstream file;
+      if (options.getBoolean("output")) {
+         file.open(options.getString("output").c_str(), ios::binary);
+         if (!file.is_open()) {
+            cerr << "Error: cannot write " << options.getString("output") << endl;
+            return 1;
+         }
+      }
+      ostream& output = file.is_open() ? file : cout;
+      bool status;
+      if (filenames.size() == 1) {
+         FeatureMatrix matrix(settings);
+         status = matrix.load(filenames[0]) && matrix.write(output, format);
+      } else {
+         status = FeatureMatrix::writeFiles(filenames, settings, output, format);
+      }
+      return status ? 0 : 1;
    }
+
+   FeatureMatrix::processFiles(filenames, settings, [&](int index,
+         const FeatureMatrix& matrix, bool status) {
+      if (!status) {
+         cerr << "Error: cannot read " << filenames[index] << endl;
+         return;
+      }
+      printMatlabArray(matrix);
+   });
    return 0;
 }
 
@@ -183,16 +220,15 @@ void printOpcodeVariables(vector<int> opcodes) {
 
 //////////////////////////////
 //
-// convertMidiFile --
+// convertMidiFile -- print the events of the MIDI file in verbose form.
 //
 
-void convertMidiFile(MidiFile& midifile, vector<vector<double> >& matlab) {
+void convertMidiFile(MidiFile& midifile) {
    midifile.absoluteTicks();
    midifile.joinTracks();
    if (secQ || msecQ) {
       midifile.doTimeAnalysis();
    }
-   vector<double> event(7);
    vector<double> ontimes(128);
    vector<int> onvelocities(128);
    int i;
@@ -206,12 +242,9 @@ void convertMidiFile(MidiFile& midifile, vector<vector<double> >& matlab) {
    int key = 0;
    int vel = 0;
 
-   if (verboseQ) {
-      cout << "-1\ttpq\t" << midifile.getTicksPerQuarterNote() << endl;
-   }
+   cout << "-1\ttpq\t" << midifile.getTicksPerQuarterNote() << endl;
 
    for (i=0; i<midifile.getNumEvents(0); i++) {
-      event.assign(event.size(), unused);
       int command = midifile[0][i][0] & 0xf0;
       if (command == 0xf0) {
          command = midifile[0][i][0];
@@ -227,52 +260,24 @@ void convertMidiFile(MidiFile& midifile, vector<vector<double> >& matlab) {
          // note off command write to output
          key = midifile[0][i][1];
          offtime = getTime(midifile[0][i].tick, midifile);
-         legend_opcode[OP_NOTE/1000] = 1;
-
-         if (verboseQ) {
-            cout
-              << ontimes[key]
-              << "\tnote"
-              << "\tdur=" << offtime - ontimes[key]
-              << "\tpch=" << key
-              << "\tvel=" << onvelocities[key]
-              << "\tch="  << (midifile[0][i][0] & 0x0f)
-              << "\ttrack=" << midifile[0][i].track
-              << endl;
-         } else {
-            event[0] = ontimes[key];
-            event[1] = OP_NOTE;
-            event[2] = offtime - ontimes[key];
-            event[3] = key;
-            event[4] = onvelocities[key];
-            event[5] = (midifile[0][i][0] & 0x0f);
-            event[6] = midifile[0][i].track;
-         }
+         cout
+           << ontimes[key]
+           << "\tnote"
+           << "\tdur=" << offtime - ontimes[key]
+           << "\tpch=" << key
+           << "\tvel=" << onvelocities[key]
+           << "\tch="  << (midifile[0][i][0] & 0x0f)
+           << "\ttrack=" << midifile[0][i].track
+           << endl;
       } else if (command == 0xb0) {
-         legend_controller[midifile[0][i][1]] = 1;
-         legend_opcode[OP_CONTROL/1000] = 1;
-
-         if (verboseQ) {
-            cout << getTime(midifile[0][i].tick, midifile)
-                 << "\tcontrol"
-                 << "\ttype="  << (int)midifile[0][i][1]
-                 << "\tval="   << (int)midifile[0][i][2]
-                 << "\tch="    << (midifile[0][i][0] & 0x0f)
-                 << "\ttrack=" << midifile[0][i].track
-                 << "\n";
-         } else {
-            event[0] = getTime(midifile[0][i].tick, midifile);
-            event[1] = OP_CONTROL;
-            event[2] = (int)midifile[0][i][1];
-            event[3] = (int)midifile[0][i][2];
-            event[5] = (midifile[0][i][0] & 0x0f);
-            event[6] = midifile[0][i].track;
-         }
+         cout << getTime(midifile[0][i].tick, midifile)
+              << "\tcontrol"
+              << "\ttype="  << (int)midifile[0][i][1]
+              << "\tval="   << (int)midifile[0][i][2]
+              << "\tch="    << (midifile[0][i][0] & 0x0f)
+              << "\ttrack=" << midifile[0][i].track
+              << "\n";
       } else if (command == 0xc0) {
-         legend_instr[midifile[0][i][1]] = 1;
-         legend_opcode[OP_INSTR/1000] = 1;
-
-         if (verboseQ) {
          cout << getTime(midifile[0][i].tick, midifile)
               << "\tinstr"
               << "\tname="  << GMinstrument[midifile[0][i][1]]
@@ -280,37 +285,11 @@ void convertMidiFile(MidiFile& midifile, vector<vector<double> >& matlab) {
               << "\tch="    << (midifile[0][i][0] & 0x0f)
               << "\ttrack=" << midifile[0][i].track
               << "\n";
-         } else {
-            event[0] = getTime(midifile[0][i].tick, midifile);
-            event[1] = OP_INSTR;
-            event[2] = (int)midifile[0][i][1];
-            event[5] = (midifile[0][i][0] & 0x0f);
-            event[6] = midifile[0][i].track;
-         }
       } else if (command == 0xff) {
-         if (verboseQ) {
-            cout << getTime(midifile[0][i].tick, midifile)
-                 << "\t";
-         } else {
-            event[0] = getTime(midifile[0][i].tick, midifile);
-         }
-         processMetaEvent(midifile, i, event);
-         if (verboseQ) {
-            cout << "\n";
-         }
-      }
-
-      /* no longer needed
-      // check for tempo indication
-      if (midifile[0][i][0] == 0xff &&
-                 midifile[0][i][1] == 0x51) {
-         setTempo(midifile, i, tempo);
-
-      }
-      */
-
-      if (event[1] != unused) {
-         matlab.push_back(event);
+         cout << getTime(midifile[0][i].tick, midifile)
+              << "\t";
+         processMetaEvent(midifile, i);
+         cout << "\n";
       }
    }
 
@@ -320,19 +299,13 @@ void convertMidiFile(MidiFile& midifile, vector<vector<double> >& matlab) {
 
 //////////////////////////////
 //
-// processMetaEvent -- Handle meta events.
+// processMetaEvent -- Print meta events.
 //
 
-void processMetaEvent(MidiFile& midifile, int i, vector<double>& event) {
+void processMetaEvent(MidiFile& midifile, int i) {
    MidiEvent& mfevent = midifile[0][i];
 
    switch (mfevent[1]) {
-      case 0x51:  // tempo change
-         legend_opcode[OP_TEMPO/1000] = 1;
-         event[1] = OP_TEMPO;
-         event[2] = mfevent.getTempoBPM();
-         break;
-
       case 0x58:  // time signature
          // 58 04 nn dd cc bb
          //  nn=numerator of time sig.
@@ -340,56 +313,40 @@ void processMetaEvent(MidiFile& midifile, int i, vector<double>& event) {
          //  3=eighth, etc.
          //  cc=number of ticks in metronome click
          //  bb=number of 32nd notes to the quarter note
-         if (verboseQ) {
-            cout << "%meter\t" << (int)mfevent[2] << "/" << pow(2.0, mfevent[3]);
-         } else {
-            legend_opcode[OP_METER/1000] = 1;
-            event[1] = OP_METER;
-            event[2] = (int)mfevent[2];
-            event[3] = pow(2.0, mfevent[3]);
-         }
+         cout << "%meter\t" << (int)mfevent[2] << "/" << pow(2.0, mfevent[3]);
          break;
 
       case 0x59:  // key signature
          // 59 02 sf mi
          // sf=sharps/flats (-7=7 flats, 0=key of C, 7=7 sharps)
          // mi=major/minor (0=major, 1=minor)
-         if (verboseQ) {
-            cout << "%keysig\t";
-            if (mfevent[3]==0) {
-               switch (mfevent[2]) {
-                  case 0: cout << "C-major"; break;
-                  case 1: cout << "G-major"; break;
-                  case 2: cout << "D-major"; break;
-                  case 3: cout << "A-major"; break;
-                  case 4: cout << "E-major"; break;
-                  case 5: cout << "B-major"; break;
-                  case 6: cout << "F-sharp-major"; break;
-                  case 7: cout << "C-sharp-major"; break;
-               }
-            } else {
-               switch (mfevent[2]) {
-                  case 0: cout << "A-minor"; break;
-                  case 1: cout << "E-minor"; break;
-                  case 2: cout << "B-minor"; break;
-                  case 3: cout << "F-minor"; break;
-                  case 4: cout << "C-sharp-minor"; break;
-                  case 5: cout << "G-sharp-minor"; break;
-                  case 6: cout << "D-sharp-minor"; break;
-                  case 7: cout << "A-sharp-minor"; break;
-               }
+         cout << "%keysig\t";
+         if (mfevent[3]==0) {
+            switch (mfevent[2]) {
+               case 0: cout << "C-major"; break;
+               case 1: cout << "G-major"; break;
+               case 2: cout << "D-major"; break;
+               case 3: cout << "A-major"; break;
+               case 4: cout << "E-major"; break;
+               case 5: cout << "B-major"; break;
+               case 6: cout << "F-sharp-major"; break;
+               case 7: cout << "C-sharp-major"; break;
             }
          } else {
-            legend_opcode[OP_KEYSIG/1000] = 1;
-            event[1] = OP_KEYSIG;
-            event[2] = (int)mfevent[2];
-            event[3] = (int)mfevent[3];
+            switch (mfevent[2]) {
+               case 0: cout << "A-minor"; break;
+               case 1: cout << "E-minor"; break;
+               case 2: cout << "B-minor"; break;
+               case 3: cout << "F-minor"; break;
+               case 4: cout << "C-sharp-minor"; break;
+               case 5: cout << "G-sharp-minor"; break;
+               case 6: cout << "D-sharp-minor"; break;
+               case 7: cout << "A-sharp-minor"; break;
+            }
          }
          break;
       default:
-         if (verboseQ) {
-            cout << "%meta\t0x" << hex << (int)mfevent[1] << dec;
-         }
+         cout << "%meta\t0x" << hex << (int)mfevent[1] << dec;
    }
 }
 
@@ -473,6 +430,10 @@ void checkOptions(Options& opts, int argc, char* argv[]) {
    opts.define("b|beat|beats=b",                    "display time in beats");
    opts.define("num=b",                        "display opcodes as numbers");
    opts.define("v|verbose=b",                       "display verbose data");
+   opts.define("npy=b",                             "write NumPy array file");
+   opts.define("raw=b",                             "write raw little-endian data");
+   opts.define("f|float=b",                         "write floats rather than doubles");
+   opts.define("o|output=s",                        "output file for --npy/--raw");
 
    opts.define("author=b",  "author of program");
    opts.define("version=b", "compilation info");
@@ -480,7 +441,7 @@ void checkOptions(Options& opts, int argc, char* argv[]) {
    opts.define("h|help=b",  "short description");
 
    opts.define("debug=b",  "debug mode to find errors in input file");
-   opts.define("max=i:100000", "maximum number of notes expected in input");
+   opts.define("max=i:100000", "maximum number of notes expected (ignored)");
 
    opts.process(argc, argv);
 
@@ -503,10 +464,13 @@ void checkOptions(Options& opts, int argc, char* argv[]) {
 
    unused   = opts.getDouble("unused");
    debugQ   = opts.getBoolean("debug");
-   maxcount = opts.getInteger("max");
+   verboseQ = opts.getBoolean("verbose");
    numQ     = opts.getBoolean("num");
+   npyQ     = opts.getBoolean("npy");
+   rawQ     = opts.getBoolean("raw");
+   floatQ   = opts.getBoolean("float");
 
-   if (opts.getArgCount() != 1) {
+   if (opts.getArgCount() < 1) {
       usage(opts.getCommand().c_str());
       exit(1);
    }
@@ -564,7 +528,7 @@ void example(void) {
 //
 
 void usage(const char* command) {
-   cout << "Usage: " << command << " midifile" << endl;
+   cout << "Usage: " << command << " [--npy|--raw [-f] [-o file]] midifile(s)" << endl;
 }
 
 
@@ -706,16 +670,31 @@ const char *GMcontrollers[128] = {
 };
 
 
-void printLegend(MidiFile& midifile) {
+void printLegend(const FeatureMatrix& matrix, vector<int>& legend_opcode) {
    int sum = 0;
    int i;
 
+   // find the codes used in the data:
+   vector<int> legend_instr(128, 0);
+   vector<int> legend_controller(128, 0);
+   legend_opcode.assign(128, 0);
+   for (i=0; i<matrix.getRowCount(); i++) {
+      const double* row = matrix.getRow(i);
+      int opcode = (int)row[1];
+      legend_opcode[opcode/1000] = 1;
+      if (opcode == OP_INSTR) {
+         legend_instr[(int)row[2] & 0x7f] = 1;
+      } else if (opcode == OP_CONTROL) {
+         legend_controller[(int)row[2] & 0x7f] = 1;
+      }
+   }
+
    cout << "\n";
    cout << "%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%\n";
    cout << "%% DATA LEGEND                                               %%\n";
    cout << "%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%\n";
-   cout << "%%Filename: " << midifile.getFilename() << endl;
-   cout << "%%Ticks per quarter note: " << midifile.getTicksPerQuarterNote()
+   cout << "%%Filename: " << matrix.getFilename() << endl;
+   cout << "%%Ticks per quarter note: " << matrix.getTicksPerQuarterNote()
         << "\n";
    cout << "%%Time units used in column 1: ";
    switch (timetype) {
@@ -847,55 +826,22 @@ void printLegend(MidiFile& midifile) {
 // printMatlabArray -- print the Matlab array representing the MIDI file.
 //
 
-void printMatlabArray(MidiFile& midifile, vector<vector<double> >& matlab) {
+void printMatlabArray(const FeatureMatrix& matrix) {
    int i;
-   sortArray(matlab);
-   printLegend(midifile);
+   vector<int> legend_opcode;
+   printLegend(matrix, legend_opcode);
    if (!numQ) {
       printOpcodeVariables(legend_opcode);
    }
    cout << arrayname << " = [\n";
-   for (i=0; i<(int)matlab.size(); i++) {
-      printEvent(matlab[i]);
+   for (i=0; i<matrix.getRowCount(); i++) {
+      printEvent(matrix.getRow(i), matrix.getColumnCount());
    }
    cout << "];\n";
 }
 
 
 
-//////////////////////////////
-//
-// sortArray -- sort the input file into time order because
-//   the notes may be slightly out of time order.
-//
-
-void sortArray(vector<vector<double> >& matlab) {
-   qsort(matlab.data(), matlab.size(), sizeof(vector<double>), eventcmp);
-}
-
-
-
-//////////////////////////////
-//
-// eventcmp -- compare two events and determine which should come
-//    first in time.
-//
-
-int eventcmp(const void* a, const void* b) {
-   vector<double>& A = *((vector<double>*)a);
-   vector<double>& B = *((vector<double>*)b);
-
-   if (A[0] < B[0]) {
-      return -1;
-   } else if (A[0] > B[0]) {
-      return 1;
-   } else {
-      return 0;   // there is a tie if they come at the same time.
-   }
-}
-
-
-
 //////////////////////////////
 //
 // printOpName -- print the OpCode's symbolic name for better
@@ -936,9 +882,9 @@ void printOpName(int code) {
 // printEvent -- print the event
 //
 
-void printEvent(vector<double>& event) {
+void printEvent(const double* event, int size) {
    int i;
-   for (i=0; i<(int)event.size(); i++) {
+   for (i=0; i<size; i++) {
       if ((i == 1) && (!numQ)) {
          printOpName((int)event[i]);
          cout << ",\t";
@@ -951,7 +897,7 @@ void printEvent(vector<double>& event) {
       //       cout << "0";
       //    }
       // }
-      if (i<(int)event.size()-1) {
+      if (i<size-1) {
          cout << ",\t";
       }
    }
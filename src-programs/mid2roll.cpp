@@ -0,0 +1,116 @@
+//
+// Creation Date: Mon Oct 19 13:40:02 PDT 2026
+// Filename:      mid2roll.cpp
+// Web Address:   https://github.com/craigsapp/midifile/blob/master/src-programs/mid2roll.cpp
+// Syntax:        C++11
+// vim:           ts=3
+//
+// Description:   Render a MIDI file as a piano roll using the PianoRoll
+//                class: SVG by default, or a PGM/PPM raster image for
+//                thumbnails.  The -b option renders the image repeatedly
+//                and reports the number of renders per second.
+//
+
+#include "MidiFile.h"
+#include "PianoRoll.h"
+#include "Options.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+
+using namespace std;
+using namespace smf;
+
+bool render(PianoRoll& roll, ostream& out, Options& options);
+
+//////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char* argv[]) {
+	Options options;
+	options.define("o|output=s",       "Output filename (default: stdout)");
+	options.define("g|pgm=b",          "Output a grayscale PGM image");
+	options.define("c|ppm=b",          "Output a color PPM image");
+	options.define("w|width=i:1024",   "Width of PGM/PPM image");
+	options.define("h|height=i:256",   "Height of PGM/PPM image");
+	options.define("s|scale=d:1.0",    "Scaling factor for SVG image");
+	options.define("a|aspect-ratio=d:2.5", "Width of a second compared to a pitch row");
+	options.define("d|drum=b",         "Include drum notes (channel 10)");
+	options.define("p|pedal=b",        "Extend notes while the sustain pedal is down");
+	options.define("l|lod|level-of-detail=d:0.0", "Merge SVG notes closer than this many pixels");
+	options.define("b|benchmark=i:0",  "Number of renders for timing the output");
+	options.process(argc, argv);
+
+	MidiFile midifile;
+	if (options.getArgCount() == 0) {
+		midifile.read(cin);
+	} else {
+		midifile.read(options.getArg(1));
+	}
+	if (!midifile.status()) {
+		cerr << "Error: could not read MIDI file" << endl;
+		return 1;
+	}
+
+	PianoRoll roll;
+	roll.setScale(options.getDouble("scale"));
+	roll.setAspectRatio(options.getDouble("aspect-ratio"));
+	roll.setDrums(options.getBoolean("drum"));
+	roll.setSustain(options.getBoolean("pedal"));
+	roll.setLevelOfDetail(options.getDouble("level-of-detail"));
+
+	int count = options.getInteger("benchmark");
+	if (count > 0) {
+		auto start = chrono::steady_clock::now();
+		size_t bytes = 0;
+		for (int i=0; i<count; i++) {
+			stringstream out;
+			roll.load(midifile);
+			render(roll, out, options);
+			bytes += out.str().size();
+		}
+		auto end = chrono::steady_clock::now();
+		double seconds = chrono::duration<double>(end - start).count();
+		cout << "notes:\t\t"   << roll.getNoteCount() << endl;
+		cout << "renders:\t"   << count << endl;
+		cout << "seconds:\t"   << seconds << endl;
+		cout << "renders/sec:\t" << count / seconds << endl;
+		cout << "MB/sec:\t\t"  << bytes / seconds / 1000000.0 << endl;
+		return 0;
+	}
+
+	roll.load(midifile);
+	bool status;
+	if (options.getBoolean("output")) {
+		ofstream out(options.getString("output"), ios::binary);
+		status = render(roll, out, options);
+	} else {
+		status = render(roll, cout, options);
+	}
+	return status ? 0 : 1;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////
+//
+// render -- Write the piano roll in the requested image format.
+//
+
+bool render(PianoRoll& roll, ostream& out, Options& options) {
+	int width  = options.getInteger("width");
+	int height = options.getInteger("height");
+	if (options.getBoolean("ppm")) {
+		return roll.writePpm(out, width, height);
+	} else if (options.getBoolean("pgm")) {
+		return roll.writePgm(out, width, height);
+	} else {
+		return roll.writeSvg(out);
+	}
+}
+
+
+
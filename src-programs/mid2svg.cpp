@@ -2,6 +2,7 @@
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Fri Feb 19 22:25:22 PST 2016
 // Last Modified: Sat Feb 27 18:16:39 PST 2016
+// Last Modified: Wed Oct 21 13:02:51 PDT 2026 Added --pedal option.
 // Filename:      midifile/src-programs/mid2svg.cpp
 // Web Address:   https://github.com/craigsapp/midifile/blob/master/src-programs/mid2svg.cpp
 // Syntax:        C++; museinfo
@@ -10,6 +11,7 @@
 //
 
 #include "MidiFile.h"
+#include "PianoRoll.h"
 #include "Options.h"
 #include <sstream>
 #include <iostream>
@@ -53,8 +55,11 @@ double   MaxRest      = 4.0;       // used with --max-rest option
 double   EndSpace     = 0.0;       // used with -e option
 int      percmapQ     = 0;         // used with --perc option
 double   AspectRatio  = 2.5;       // used with -a option
+double   Detail       = 0.0;       // used with --lod option
+int      pedalQ       = 0;         // used with -p option
 vector<int> PercussionMap;         // used with --perc option
 vector<string> Shapes;
+vector<vector<const MidiEvent*>> SustainEnds;  // used with -p option
 
 // Function declarations:
 void           checkOptions          (Options& opts, int argc, char* argv[]);
@@ -72,6 +77,8 @@ vector<double> getTrackHues          (MidiFile& midifile);
 void           drawNote              (ostream& out, MidiFile& midifile,
                                       int i, int j, int dataQ,
                                       int minpitch, int maxpitch);
+void           drawTrackPath         (ostream& out, PianoRoll& roll,
+                                      int track);
 void           drawLines             (ostream& out, MidiFile& midifile,
                                       vector<double>& hues, Options& options);
 void           printLineToNextNote   (ostream& out, MidiFile& midifile,
@@ -261,6 +268,13 @@ void convertMidiFileToSvg(stringstream& output, MidiFile& midifile,
 
    midifile.linkNotePairs();    // first link note-ons to note-offs
    midifile.doTimeAnalysis();   // then create ticks to seconds mapping
+   if (pedalQ) {
+      // sounding ends of notes held by the sustain pedal
+      SustainEnds.resize(midifile.getTrackCount());
+      for (int i=0; i<midifile.getTrackCount(); i++) {
+         midifile[i].getSustainedNoteEnds(SustainEnds[i]);
+      }
+   }
 
    stringstream notes;
 
@@ -286,6 +300,17 @@ void convertMidiFileToSvg(stringstream& output, MidiFile& midifile,
 
    vector<double> trackhues = getTrackHues(midifile);
 
+   // In level-of-detail mode the notes of each track are merged into
+   // spans and drawn as a single path.  Otherwise each note is still
+   // drawn as its own shape by drawNote(), so that the per-note classes
+   // and the number format of the output stay as they were:
+   PianoRoll roll;
+   if (Detail > 0.0) {
+      roll.setDrums(drumQ);
+      roll.setSustain(pedalQ);
+      roll.load(midifile);
+   }
+
    if (lineQ) {
       drawLines(notes, midifile, trackhues, options);
    }
@@ -322,6 +347,11 @@ void convertMidiFileToSvg(stringstream& output, MidiFile& midifile,
              }
          }
          notes << " >\n";
+         if (Detail > 0.0) {
+            drawTrackPath(notes, roll, i);
+            notes << "\t\t</g>\n";
+            continue;
+         }
          for (int j=0; j<midifile[i].size(); j++) {
             if (!midifile[i][j].isNoteOn()) {
                continue;
@@ -363,6 +393,12 @@ void convertMidiFileToSvg(stringstream& output, MidiFile& midifile,
       }
       notes << " >\n";
 
+      if (Detail > 0.0) {
+         drawTrackPath(notes, roll, i);
+         notes << "\t\t</g>\n";
+         continue;
+      }
+
       for (int j=0; j<midifile[i].size(); j++) {
          if (!midifile[i][j].isNoteOn()) {
             continue;
@@ -739,7 +775,12 @@ void drawNote(ostream& out, MidiFile& midifile, int i, int j, int dataQ,
    int height = 1;
    tickstart  = midifile[i][j].tick;
    starttime  = midifile[i][j].seconds;
-   if (midifile[i][j].isLinked()) {
+   if (pedalQ && (SustainEnds[i][j] != NULL)) {
+      tickend  = SustainEnds[i][j]->tick;
+      tickdur  = tickend - tickstart;
+      endtime  = SustainEnds[i][j]->seconds;
+      duration = endtime - starttime;
+   } else if (midifile[i][j].isLinked()) {
       tickdur  = midifile[i][j].getTickDuration();
       tickend  = tickstart + tickdur;
       duration = midifile[i][j].getDurationInSeconds();
@@ -855,6 +896,33 @@ void drawNote(ostream& out, MidiFile& midifile, int i, int j, int dataQ,
 
 
 
+//////////////////////////////
+//
+// drawTrackPath -- Draw the notes of a track as a single path, merging
+//    notes in the same pitch row which overlap or are closer together
+//    than the level-of-detail threshold (in pixels).
+//
+
+void drawTrackPath(ostream& out, PianoRoll& roll, int track) {
+   vector<PianoRollNote> notes = roll.getTrackNotes(track);
+   for (auto& note : notes) {
+      if (note.channel == 9) {
+         note.key = PercussionMap[note.key];
+      }
+      if (diatonicQ) {
+         note.key = base12ToBase7(note.key);
+      }
+   }
+   vector<PianoRollNote> spans;
+   PianoRoll::mergeNotes(spans, notes, Detail / (Scale * AspectRatio));
+   string data;
+   PianoRoll::writeSvgPath(data, spans);
+   out << "\t\t\t<path vector-effect=\"non-scaling-stroke\""
+       << " class=\"notes\" d=\"" << data << "\" />\n";
+}
+
+
+
 //////////////////////////////
 //
 // getTrackShape --
@@ -2174,6 +2242,7 @@ void checkOptions(Options& opts, int argc, char* argv[]) {
    opts.define("bw|black-and-white=b", "Display as black and white (outlines only)");
    opts.define("diatonic=b",           "Vertical axis is base-7 pitch");
    opts.define("drum=b",               "Show drum track (channel 10)");
+   opts.define("p|pedal=b",            "Extend notes while sustain pedal is down");
    opts.define("pm|perc|percussion-map=s", "Map percussion notes to different pitch");
    opts.define("r|round|rounded=b",    "Round edges of note boxes");
    opts.define("b|border=d:1.0",       "Border around piano roll");
@@ -2186,6 +2255,8 @@ void checkOptions(Options& opts, int argc, char* argv[]) {
    opts.define("c|clef|clefs=b",       "Draw clefs");
    opts.define("v|velocity-brightness=b",  "Show velocity as brightness on note");
    opts.define("S|shapes=s:rectangle,rectangle", "shape of notes for each track");
+   opts.define("lod|level-of-detail=d:0.0 pixels",
+      "Merge notes in a pitch row closer than this and draw tracks as paths");
    opts.define("mr|rest|max-rest=d:4.0 seconds",
       "Maximum rest through which to draw lines");
 
@@ -2219,6 +2290,7 @@ void checkOptions(Options& opts, int argc, char* argv[]) {
 
    dataQ        =  opts.getBoolean("data");
    drumQ        =  opts.getBoolean("drum");
+   pedalQ       =  opts.getBoolean("pedal");
    darkQ        =  opts.getBoolean("dark");
    lineQ        =  opts.getBoolean("line");
    curveQ       =  opts.getBoolean("cline");
@@ -2243,6 +2315,7 @@ void checkOptions(Options& opts, int argc, char* argv[]) {
    AspectRatio  =  opts.getDouble("aspect-ratio");
    Opacity      =  opts.getDouble("opacity");
    MaxRest      =  opts.getDouble("max-rest");
+   Detail       =  opts.getDouble("level-of-detail");
    if (clefQ) {
       staffQ = 1;
       braceQ = 1;
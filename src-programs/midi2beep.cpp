@@ -11,11 +11,11 @@
 //
 
 #include "MidiFile.h"
+#include "MidiPlayer.h"
 #include "Options.h"
 
 #include <iostream>
 #include <cmath>
-#include <unistd.h>     // usleep()
 #include <signal.h>
 
 #ifdef __APPLE__
@@ -37,7 +37,7 @@ void beepOff(int)
     exit(0);
 }
 
-void beep(int fre, int usDuration)
+void beep(int fre)
 {
     if (fre > 0) {
         int ff = 1193180/fre;
@@ -48,10 +48,29 @@ void beep(int fre, int usDuration)
 
     int r = inb(0x61);
     if(fre > 0) outb(r|3, 0x61);
-    usleep(usDuration);
-    outb(r & 0xFC, 0x61);
+    else outb(r & 0xFC, 0x61);
 }
 
+// Plays the most recent note-on until its note-off arrives.
+class BeepSink : public MidiSink
+{
+public:
+    virtual void send(const MidiEvent& event, double seconds)
+    {
+        if (event.isNoteOn()) {
+            key = event.getKeyNumber();
+            int halfTonesFromA4 = key - 69; // 69 == A4 == 440Hz
+            beep(440 * pow(2, halfTonesFromA4/12.0));
+        } else if (event.isNoteOff() && event.getKeyNumber() == key) {
+            key = -1;
+            beep(0);
+        }
+    }
+
+private:
+    int key = -1;
+};
+
 int main(int argc, char** argv)
 {
     signal(SIGINT, beepOff);
@@ -77,40 +96,13 @@ int main(int argc, char** argv)
         return k;
     }
 
-    midifile.linkNotePairs();
-    midifile.joinTracks();
-    midifile.doTimeAnalysis();
-
-    midifile.absoluteTicks();
-
-    double lastNoteFinished = 0.0;
-    for (int track=0; track < midifile.getTrackCount(); track++) {
-        for (int i=0; i<midifile[track].size(); i++) {
-            MidiEvent* mev = &midifile[track][i];
-            if (!mev->isNoteOn() || mev->getLinkedEvent() == NULL) {
-                continue;
-            }
-
-            // pause, silence
-            int silence = static_cast<int>((midifile.getTimeInSeconds(mev->tick) - lastNoteFinished) * 1000 * 1000);
-            if(silence >0)
-            {
-                usleep(silence);
-            }
-
-            double duration = mev->getDurationInSeconds();
-
-            int halfTonesFromA4 = mev->getKeyNumber() - 69; // 69 == A4 == 440Hz
-            int frq = 440 * pow(2, halfTonesFromA4/12.0);
-
-            // play note
-            beep(frq, static_cast<int>(duration*1000*1000));
-
-            MidiEvent* off = mev->getLinkedEvent();
-            lastNoteFinished = midifile.getTimeInSeconds(off->tick);
-
-        }
-    }
+    // Note times are calculated in advance from the tempo map and played
+    // at absolute deadlines, so timing errors do not accumulate.
+    BeepSink sink;
+    MidiPlayer player(midifile);
+    player.setSink(&sink);
+    player.play();
+    beep(0);
 
     return 0;
 }
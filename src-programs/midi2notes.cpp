@@ -3,6 +3,8 @@
 // Creation Date: Tue Jan 22 22:09:46 PST 2002
 // Last Modified: Mon Jul 23 01:43:43 PDT 2007 (copied from mid2mat)
 // Last Modified: Mon Feb  9 21:26:32 PST 2015 Updated for C++11.
+// Last Modified: Tue Oct 20 14:31:08 PDT 2026 Write notes with NoteList.
+// Last Modified: Tue Oct 20 17:12:40 PDT 2026 Added --npy and --raw output.
 // Filename:      ...sig/examples/all/.cpp
 // Web Address:   http://sig.sapp.org/examples/museinfo/midi/.cpp
 // Syntax:        C++; museinfo
@@ -11,6 +13,8 @@
 //
 
 #include "MidiFile.h"
+#include "NoteList.h"
+#include "FeatureMatrix.h"
 #include "Options.h"
 
 #include <ctype.h>
@@ -18,6 +22,7 @@
 #include <stdio.h>
 #include <math.h>
 #include <iostream>
+#include <fstream>
 #include <iomanip>
 #include <vector>
 
@@ -74,6 +79,8 @@ int     tickQ    = 0;           // used with -t option
 int     beatQ    = 0;           // used with -b option
 int     secQ     = 0;           // used with -s option
 int     msecQ    = 0;           // used with -m option
+int     npyQ     = 0;           // used with --npy option
+int     rawQ     = 0;           // used with --raw option
 double  unused   = -1000.0;     // used with -u option
 char    arrayname[1024] = {0};  // used with -n option
 int     timetype = SEC;
@@ -99,9 +106,8 @@ void      printMatlabArray      (MidiFile& midifile,
 void      sortArray             (vector<vector<double> >& matlab);
 int       eventcmp              (const void* a, const void* b);
 
-void      printNotesData       (MidiFile& midifile,
-                                 vector<vector<double> >& matlab);
-void      printNotesEvent      (vector<double>& event);
+void      printNotesData       (MidiFile& midifile);
+int       writeFeatureMatrix   (MidiFile& midifile);
 void      setFilterOptions     (vector<int>& channelfilter, const char* exclude);
 
 
@@ -120,10 +126,13 @@ int main(int argc, char* argv[]) {
 
    checkOptions(options, argc, argv);
    MidiFile midifile(options.getArg(1));
-   convertMidiFile(midifile, matlabarray);
-   if (!verboseQ) {
+   if (verboseQ) {
+      convertMidiFile(midifile, matlabarray);
+   } else if (npyQ || rawQ) {
+      return writeFeatureMatrix(midifile);
+   } else {
       //printMatlabArray(midifile, matlabarray);
-      printNotesData(midifile, matlabarray);
+      printNotesData(midifile);
    }
    return 0;
 }
@@ -427,6 +436,10 @@ void checkOptions(Options& opts, int argc, char* argv[]) {
    opts.define("b|beat|beats=b",                    "display time in beats");
    opts.define("x|exclude=s",                       "exclude channel notes");
    opts.define("v|verbose=b",                       "display verbose data");
+   opts.define("npy=b",                  "write feature matrix as NumPy .npy file");
+   opts.define("raw=b",                  "write feature matrix as raw doubles");
+   opts.define("f|float=b",              "write 32-bit floats with --npy/--raw");
+   opts.define("o|output=s",             "output file for --npy/--raw");
 
    opts.define("author=b",  "author of program");
    opts.define("version=b", "compilation info");
@@ -474,6 +487,8 @@ void checkOptions(Options& opts, int argc, char* argv[]) {
    secQ  = opts.getBoolean("seconds");
    msecQ = opts.getBoolean("milliseconds");
    beatQ = opts.getBoolean("beats");
+   npyQ  = opts.getBoolean("npy");
+   rawQ  = opts.getBoolean("raw");
    strcpy(arrayname, opts.getString("name").c_str());
 
    if (tickQ) {
@@ -835,18 +850,71 @@ void printMatlabArray(MidiFile& midifile, vector<vector<double> >& matlab) {
 
 //////////////////////////////
 //
-// printNotesData  -- print the Matlab array representing the MIDI file.
+// printNotesData  -- print the notes in the MIDI file, sorted by start
+//     time, with times in thousandths of the time unit.  Drum notes
+//     (channel 10) and excluded channels are ignored.
 //
 
-void printNotesData(MidiFile& midifile, vector<vector<double> >& matlab) {
-   int i;
-   sortArray(matlab);
-   // cout << arrayname << " = [\n";
-   for (i=0; i<(int)matlab.size(); i++) {
-      printNotesEvent(matlab[i]);
+void printNotesData(MidiFile& midifile) {
+   NoteList notelist;
+   notelist.setFormat(NoteList::Notes);
+   notelist.setTempo(tempo);
+   switch (timetype) {
+      case TICK: notelist.setTimeUnit(NoteList::Ticks);        break;
+      case BEAT: notelist.setTimeUnit(NoteList::Beats);        break;
+      case SEC:  notelist.setTimeUnit(NoteList::Seconds);      break;
+      case MSEC: notelist.setTimeUnit(NoteList::Milliseconds); break;
+   }
+   for (int i=0; i<(int)channelfilter.size(); i++) {
+      if (channelfilter[i] == 0) {
+         notelist.excludeChannel(i);
+      }
+   }
+   notelist.excludeChannel(9);
+   notelist.setChannelColumn(debugQ);
+   notelist.write(cout, midifile);
+}
+
+
+
+//////////////////////////////
+//
+// writeFeatureMatrix -- write the mid2mat feature matrix of the MIDI
+//     file as binary data (to standard output or the -o file), using the
+//     same time unit and channel filtering as the notelist.
+//
+
+int writeFeatureMatrix(MidiFile& midifile) {
+   FeatureMatrix matrix;
+   switch (timetype) {
+      case TICK: matrix.setTimeUnit(FeatureMatrix::Ticks);        break;
+      case BEAT: matrix.setTimeUnit(FeatureMatrix::Beats);        break;
+      case SEC:  matrix.setTimeUnit(FeatureMatrix::Seconds);      break;
+      case MSEC: matrix.setTimeUnit(FeatureMatrix::Milliseconds); break;
+   }
+   for (int i=0; i<(int)channelfilter.size(); i++) {
+      if (channelfilter[i] == 0) {
+         matrix.excludeChannel(i);
+      }
    }
-   // cout << "];\n";
-   // printLegend(midifile);
+   matrix.excludeChannel(9);
+   matrix.setUnused(unused);
+   matrix.setSinglePrecision(options.getBoolean("float"));
+   matrix.load(midifile);
+
+   FeatureMatrix::Format format = npyQ ? FeatureMatrix::Npy : FeatureMatrix::Raw;
+   bool status;
+   if (options.getBoolean("output")) {
+      ofstream output(options.getString("output"), ios::binary);
+      if (!output.is_open()) {
+         cerr << "Error: cannot write " << options.getString("output") << endl;
+         return 1;
+      }
+      status = matrix.write(output, format);
+   } else {
+      status = matrix.write(cout, format);
+   }
+   return status ? 0 : 1;
 }
 
 
@@ -902,52 +970,3 @@ void printEvent(vector<double>& event) {
 
 
 
-//////////////////////////////
-//
-// printNotesEvent -- print the event
-//            event[0] = ontimes[key];
-//            event[1] = OP_NOTE;
-//            event[2] = offtime - ontimes[key];
-//            event[3] = key;
-//            event[4] = onvelocities[key];
-//            event[5] = (midifile[0][i][0] & 0x0f);
-//            event[6] = midifile[0][i].track;
-
-void printNotesEvent(vector<double>& event) {
-   if (int(event[1]+0.5) != OP_NOTE) {
-      // ignore items which are not notes.
-      return;
-   }
-   int ontime = int(event[0] * 1000 + 0.5);
-   if (ontime < 0) {
-      // ignore incomplete note events (no on times)
-      return;
-   }
-   if (channelfilter[int(event[7]+0.5)] == 0) {
-      // ignore excluded channel notes (for drum track exclusions)
-      return;
-   }
-   cout << "Note\t";
-   cout << ontime; // ontime in milliseconds
-   cout << '\t';
-   cout << int((event[0]+event[2]) * 1000 + 0.5); // endtime in milliseconds
-   cout << '\t';
-   cout << int(event[3] + 0.5); // Pitch (MIDI note);
-   if (debugQ) {
-      cout << "\tCH_" << (int)(event[7]+ 0.5) + 1;
-   }
-   cout << endl;
-
-/*   int i;
-   for (i=0; i<(int)event.size(); i++) {
-      cout << event[i];
-      if (i<(int)event.size()-1) {
-         cout << ",\t";
-      }
-   }
-   cout << ";\n";
-*/
-}
-
-
-
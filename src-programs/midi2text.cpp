@@ -3,6 +3,7 @@
 // Creation Date: Tue Jan 22 22:09:46 PST 2002
 // Last Modified: Tue Jan 22 22:09:48 PST 2002
 // Last Modified: Mon Feb  9 21:26:32 PST 2015 Updated for C++11.
+// Last Modified: Tue Oct 20 14:31:08 PDT 2026 Write with NoteList.
 // Filename:      ...sig/examples/all/midi2text.cpp
 // Web Address:   http://sig.sapp.org/examples/museinfo/midi/midi2text.cpp
 // Syntax:        C++; museinfo
@@ -11,13 +12,11 @@
 //
 
 #include "MidiFile.h"
+#include "NoteList.h"
 #include "Options.h"
 
-#include <ctype.h>
-#include <string.h>
-#include <stdio.h>
+#include <stdlib.h>
 #include <iostream>
-#include <vector>
 
 using namespace std;
 using namespace smf;
@@ -25,12 +24,9 @@ using namespace smf;
 // user interface variables
 Options options;
 int     debugQ = 0;             // use with --debug option
-int     maxcount = 100000;
-double  tempo = 60.0;
+double  tempo = 60.0;           // tempo until first tempo message
 
 // function declarations:
-void      convertMidiFileToText (MidiFile& midifile);
-void      setTempo              (MidiFile& midifile, int index, double& tempo);
 void      checkOptions          (Options& opts, int argc, char** argv);
 void      example               (void);
 void      usage                 (const char* command);
@@ -40,93 +36,15 @@ void      usage                 (const char* command);
 int main(int argc, char* argv[]) {
    checkOptions(options, argc, argv);
    MidiFile midifile(options.getArg(1));
-   convertMidiFileToText(midifile);
+   NoteList notelist;
+   notelist.setTempo(tempo);
+   notelist.write(cout, midifile);
    return 0;
 }
 
 //////////////////////////////////////////////////////////////////////////
 
 
-//////////////////////////////
-//
-// convertMidiFileToText --
-//
-
-void convertMidiFileToText(MidiFile& midifile) {
-   midifile.absoluteTicks();
-   midifile.joinTracks();
-
-   vector<double> ontimes(128);
-   vector<int> onvelocities(128);
-   int i;
-   for (i=0; i<128; i++) {
-      ontimes[i] = -1.0;
-      onvelocities[i] = -1;
-   }
-
-   double offtime = 0.0;
-
-   int key = 0;
-   int vel = 0;
-
-   for (i=0; i<midifile.getNumEvents(0); i++) {
-      int command = midifile[0][i][0] & 0xf0;
-      if (command == 0x90 && midifile[0][i][2] != 0) {
-         // store note-on velocity and time
-         key = midifile[0][i][1];
-         vel = midifile[0][i][2];
-         ontimes[key] = midifile[0][i].tick * 60.0 / tempo /
-               midifile.getTicksPerQuarterNote();
-         onvelocities[key] = vel;
-      } else if (command == 0x90 || command == 0x80) {
-         // note off command write to output
-         key = midifile[0][i][1];
-         offtime = midifile[0][i].tick * 60.0 /
-               midifile.getTicksPerQuarterNote() / tempo;
-         cout << "note\t" << ontimes[key]
-              << "\t" << offtime - ontimes[key]
-              << "\t" << key << "\t" << onvelocities[key] << endl;
-         onvelocities[key] = -1;
-         ontimes[key] = -1.0;
-      }
-
-      // check for tempo indication
-      if (midifile[0][i][0] == 0xff &&
-                 midifile[0][i][1] == 0x51) {
-         setTempo(midifile, i, tempo);
-      }
-   }
-
-}
-
-
-//////////////////////////////
-//
-// setTempo -- set the current tempo
-//
-
-void setTempo(MidiFile& midifile, int index, double& tempo) {
-   static int count = 0;
-   count++;
-
-   MidiEvent& mididata = midifile[0][index];
-
-   int microseconds = 0;
-   microseconds = microseconds | (mididata[3] << 16);
-   microseconds = microseconds | (mididata[4] << 8);
-   microseconds = microseconds | (mididata[5] << 0);
-
-   double newtempo = 60.0 / microseconds * 1000000.0;
-   if (count <= 1) {
-      tempo = newtempo;
-   } else if (tempo != newtempo) {
-      cout << "; WARNING: change of tempo from " << tempo
-           << " to " << newtempo << " ignored" << endl;
-   }
-}
-
-
-
 //////////////////////////////
 //
 // checkOptions --
@@ -139,7 +57,7 @@ void checkOptions(Options& opts, int argc, char* argv[]) {
    opts.define("h|help=b",  "short description");
 
    opts.define("debug=b",  "debug mode to find errors in input file");
-   opts.define("max=i:100000", "maximum number of notes expected in input");
+   opts.define("max=i:100000", "maximum number of notes expected (ignored)");
 
    opts.process(argc, argv);
 
@@ -161,7 +79,6 @@ void checkOptions(Options& opts, int argc, char* argv[]) {
    }
 
    debugQ = opts.getBoolean("debug");
-   maxcount = opts.getInteger("max");
 
    if (opts.getArgCount() != 1) {
       usage(opts.getCommand().c_str());
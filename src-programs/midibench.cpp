@@ -0,0 +1,332 @@
+//
+// Creation Date: Mon Oct 19 10:30:12 PDT 2026
+// Filename:      src-programs/midibench.cpp
+// Syntax:        C++11
+//
+// Description:   Benchmarks for the core MidiFile operations on a
+//                deterministic synthetic corpus: reading, writing,
+//                sortTracks, joinTracks, doTimeAnalysis, linkNotePairs
+//                and a round trip through the binasc text format.  The
+//                corpus only depends on the command-line options (the
+//                generator does not use the platform's random number
+//                distributions), so results can be compared between
+//                builds and releases.  Each case is run several times,
+//                and the results are written as JSON: the fastest and
+//                median times, ns/event, MB/s of Standard MIDI File data
+//                and heap allocations/event.
+//
+
+#include "MidiFile.h"
+#include "Options.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace smf;
+
+typedef chrono::steady_clock Clock;
+
+// Every heap allocation in the program is counted, so that the
+// allocations made by a benchmark case can be measured.
+static atomic<unsigned long long> allocationCount(0);
+
+void* operator new(size_t size) {
+   allocationCount.fetch_add(1, memory_order_relaxed);
+   void* pointer = malloc(size == 0 ? 1 : size);
+   if (!pointer) {
+      throw bad_alloc();
+   }
+   return pointer;
+}
+
+void* operator new[](size_t size) {
+   return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept {
+   free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+   free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+   free(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+   free(pointer);
+}
+
+class BenchResult {
+   public:
+      string             name;
+      long long          events;
+      long long          bytes;
+      vector<long long>  times;       // nanoseconds, one for each run
+      unsigned long long allocations; // in the first run
+};
+
+void      generateCorpus    (MidiFile& midifile, int tracks, int notes,
+                             unsigned int seed);
+BenchResult runCase         (const string& name, int repeat, long long events,
+                             long long bytes, function<void(void)> setup,
+                             function<void(void)> body);
+void      printJson         (ostream& out, Options& options, int repeat,
+                             long long events, long long bytes,
+                             const vector<BenchResult>& results);
+
+///////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+   Options options;
+   options.define("t|tracks=i:8",   "Number of note tracks in the corpus");
+   options.define("n|notes=i:4000", "Number of notes in each track");
+   options.define("s|seed=i:4995",  "Seed of the corpus generator");
+   options.define("r|repeat=i:5",   "Number of runs of each case");
+   options.define("o|output=s",     "Output JSON file (default: stdout)");
+   options.process(argc, argv);
+
+   int repeat = max(1, options.getInteger("repeat"));
+
+   // The corpus, with the tracks in the order the events were added
+   // (note-offs after their note-ons) and in time order.
+   MidiFile unsorted;
+   generateCorpus(unsorted, options.getInteger("tracks"),
+         options.getInteger("notes"), options.getInteger("seed"));
+   MidiFile sorted = unsorted;
+   sorted.sortTracks();
+
+   long long events = 0;
+   for (int i=0; i<sorted.getTrackCount(); i++) {
+      events += sorted[i].size();
+   }
+   stringstream smfstream;
+   sorted.write(smfstream);
+   string smf = smfstream.str();
+   long long bytes = smf.size();
+
+   stringstream binascstream;
+   sorted.writeBinasc(binascstream);
+   string binasc = binascstream.str();
+
+   vector<BenchResult> results;
+   MidiFile work;
+   string text;
+
+   results.push_back(runCase("read", repeat, events, bytes,
+      [&]() { work.clear(); },
+      [&]() {
+         stringstream input(smf);
+         work.read(input);
+      }));
+   if (work.getTrackCount() != sorted.getTrackCount()) {
+      cerr << "Error: could not read the corpus back" << endl;
+      return 1;
+   }
+
+   results.push_back(runCase("write", repeat, events, bytes,
+      [&]() { work = sorted; },
+      [&]() {
+         stringstream output;
+         work.write(output);
+         text = output.str();
+      }));
+
+   results.push_back(runCase("sortTracks", repeat, events, bytes,
+      [&]() { work = unsorted; },
+      [&]() { work.sortTracks(); }));
+
+   results.push_back(runCase("joinTracks", repeat, events, bytes,
+      [&]() { work = sorted; },
+      [&]() { work.joinTracks(); }));
+
+   results.push_back(runCase("doTimeAnalysis", repeat, events, bytes,
+      [&]() { work = sorted; },
+      [&]() { work.doTimeAnalysis(); }));
+
+   results.push_back(runCase("linkNotePairs", repeat, events, bytes,
+      [&]() { work = sorted; },
+      [&]() { work.linkNotePairs(); }));
+
+   results.push_back(runCase("binascWrite", repeat, events, bytes,
+      [&]() { work = sorted; },
+      [&]() {
+         stringstream output;
+         work.writeBinasc(output);
+         text = output.str();
+      }));
+
+   results.push_back(runCase("binascRead", repeat, events, bytes,
+      [&]() { work.clear(); },
+      [&]() {
+         stringstream input(binasc);
+         work.read(input);
+      }));
+
+   // The round trip through binasc has to give back the same file.
+   stringstream roundtrip;
+   work.write(roundtrip);
+   if (roundtrip.str() != smf) {
+      cerr << "Error: binasc round trip changed the MIDI file" << endl;
+      return 1;
+   }
+
+   if (options.getBoolean("output")) {
+      ofstream output(options.getString("output"));
+      printJson(output, options, repeat, events, bytes, results);
+   } else {
+      printJson(cout, options, repeat, events, bytes, results);
+   }
+   return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////
+//
+// generateCorpus -- Fill a MidiFile (in absolute ticks) with a tempo
+//    track and note tracks of overlapping notes, controllers and pitch
+//    bends.  Note-offs are added straight after their note-ons, so the
+//    tracks are not in time order.  A linear congruential generator is
+//    used so that the corpus is the same on every platform.
+//
+
+void generateCorpus(MidiFile& midifile, int tracks, int notes,
+      unsigned int seed) {
+   unsigned int state = seed;
+   auto next = [&](int range) {
+      state = state * 1103515245u + 12345u;
+      return (int)((state >> 16) % (unsigned int)range);
+   };
+
+   midifile.clear();
+   midifile.absoluteTicks();
+   midifile.setTPQ(480);
+   midifile.addTracks(tracks);
+   midifile.addTrackName(0, 0, "midibench");
+   midifile.addTimeSignature(0, 0, 4, 4);
+   for (int track=1; track<=tracks; track++) {
+      int channel = (track - 1) % 16;
+      int tick = 0;
+      midifile.addTrackName(track, 0, "track " + to_string(track));
+      midifile.addPatchChange(track, 0, channel, next(128));
+      for (int i=0; i<notes; i++) {
+         tick += 60 * next(5);
+         int key = 36 + next(48);
+         int duration = 60 + 60 * next(8);
+         midifile.addNoteOn(track, tick, channel, key, 40 + next(80));
+         midifile.addNoteOff(track, tick + duration, channel, key);
+         if (next(16) == 0) {
+            midifile.addController(track, tick, channel, 7, next(128));
+         }
+         if (next(32) == 0) {
+            midifile.addPitchBend(track, tick + 30, channel,
+                  next(201) / 100.0 - 1.0);
+         }
+         if (track == 1 && next(64) == 0) {
+            midifile.addTempo(0, tick, 60 + next(120));
+         }
+      }
+   }
+}
+
+
+
+//////////////////////////////
+//
+// runCase -- Time body() repeat times, calling setup() (which is not
+//    timed) before each run.  Allocations are counted in the first run.
+//
+
+BenchResult runCase(const string& name, int repeat, long long events,
+      long long bytes, function<void(void)> setup,
+      function<void(void)> body) {
+   BenchResult result;
+   result.name = name;
+   result.events = events;
+   result.bytes = bytes;
+   result.allocations = 0;
+   for (int i=0; i<repeat; i++) {
+      setup();
+      unsigned long long allocations = allocationCount.load();
+      Clock::time_point start = Clock::now();
+      body();
+      Clock::time_point stop = Clock::now();
+      if (i == 0) {
+         result.allocations = allocationCount.load() - allocations;
+      }
+      result.times.push_back(chrono::duration_cast<chrono::nanoseconds>(
+            stop - start).count());
+   }
+   cerr << name << ":\t"
+        << *min_element(result.times.begin(), result.times.end()) / 1000000.0
+        << " ms" << endl;
+   return result;
+}
+
+
+
+//////////////////////////////
+//
+// printJson -- Write the corpus settings, the number of runs of each
+//    case and the results as a JSON object.
+//
+
+void printJson(ostream& out, Options& options, int repeat, long long events,
+      long long bytes, const vector<BenchResult>& results) {
+   char buffer[64];
+   auto number = [&](double value) {
+      snprintf(buffer, sizeof(buffer), "%.3f", value);
+      return string(buffer);
+   };
+
+   out << "{\n";
+   out << "  \"benchmark\": \"midibench\",\n";
+   out << "  \"corpus\": {\n";
+   out << "    \"tracks\": " << options.getInteger("tracks") << ",\n";
+   out << "    \"notes\": " << options.getInteger("notes") << ",\n";
+   out << "    \"seed\": " << options.getInteger("seed") << ",\n";
+   out << "    \"events\": " << events << ",\n";
+   out << "    \"bytes\": " << bytes << "\n";
+   out << "  },\n";
+   out << "  \"repeat\": " << repeat << ",\n";
+   out << "  \"results\": [\n";
+   for (int i=0; i<(int)results.size(); i++) {
+      const BenchResult& result = results[i];
+      vector<long long> times = result.times;
+      sort(times.begin(), times.end());
+      long long fastest = times[0];
+      long long median = times[times.size() / 2];
+      out << "    {\n";
+      out << "      \"name\": \"" << result.name << "\",\n";
+      out << "      \"events\": " << result.events << ",\n";
+      out << "      \"bytes\": " << result.bytes << ",\n";
+      out << "      \"ns_min\": " << fastest << ",\n";
+      out << "      \"ns_median\": " << median << ",\n";
+      out << "      \"ns_per_event\": "
+          << number((double)fastest / result.events) << ",\n";
+      out << "      \"mb_per_s\": "
+          << number(fastest == 0 ? 0.0 : result.bytes * 1000.0 / fastest)
+          << ",\n";
+      out << "      \"allocations\": " << result.allocations << ",\n";
+      out << "      \"allocations_per_event\": "
+          << number((double)result.allocations / result.events) << "\n";
+      out << "    }" << (i + 1 < (int)results.size() ? "," : "") << "\n";
+   }
+   out << "  ]\n";
+   out << "}\n";
+}
@@ -2,6 +2,7 @@
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Thu Jul 22 18:59:27 PDT 2010
 // Last Modified: Thu Jul 22 18:59:30 PDT 2010
+// Last Modified: Wed Oct 21 17:20:05 PDT 2026 Binary search for start/stop.
 // Filename:      ...sig/doc/examples/all/midiexcerpt/midiexcerpt.cpp
 // Syntax:        C++
 //
@@ -209,11 +210,9 @@ void extractMidi(MidiFile& outputfile, MidiFile& inputfile, double starttime,
 //
 
 int getStartIndex(MidiFile& midifile, int starttick) {
-   int i;
-   for (i=0; i<midifile.getNumEvents(0); i++) {
-      if (starttick <= midifile.getEvent(0,i).time) {
-         return i;
-      }
+   int index = midifile[0].lowerBound(starttick);
+   if (index < midifile[0].size()) {
+      return index;
    }
 
    // something bad happened
@@ -229,11 +228,12 @@ int getStartIndex(MidiFile& midifile, int starttick) {
 //
 
 int getStopIndex(MidiFile& midifile, int startindex, int stoptick) {
-   int i;
-   for (i=startindex; i<midifile.getNumEvents(0); i++) {
-      if (stoptick <= midifile.getEvent(0,i).time) {
-         return i-1;
-      }
+   int index = midifile[0].lowerBound(stoptick);
+   if (index < startindex) {
+      index = startindex;
+   }
+   if (index < midifile[0].size()) {
+      return index-1;
    }
 
    // something bad happened
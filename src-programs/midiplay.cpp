@@ -0,0 +1,90 @@
+//
+// Creation Date: Mon Oct 19 16:20:31 PDT 2026
+// Filename:      midiplay.cpp
+// Web Address:   https://github.com/craigsapp/midifile/blob/master/src-programs/midiplay.cpp
+// Syntax:        C++11
+// vim:           ts=3
+//
+// Description:   Play a MIDI file in real time with MidiPlayer, sending
+//                the raw MIDI bytes to a file, named pipe or MIDI device
+//                (such as /dev/snd/midiC1D0).  Without an output file the
+//                events are recorded in memory, which is useful for
+//                measuring the timing accuracy of the player.  Timing
+//                statistics are printed at the end of playback.
+//
+
+#include "MidiFile.h"
+#include "MidiPlayer.h"
+#include "Options.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace smf;
+
+//////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char* argv[]) {
+	Options options;
+	options.define("o|output=s",     "Raw MIDI output file, FIFO or device");
+	options.define("s|speed=d:1.0",  "Playback speed (2.0 = twice as fast)");
+	options.define("r|recording=b",  "Print recorded event times");
+	options.define("q|quiet=b",      "Do not print timing statistics");
+	options.process(argc, argv);
+
+	if (options.getArgCount() != 1) {
+		cerr << "Usage: " << options.getCommand() << " [-o output] file.mid" << endl;
+		return 1;
+	}
+
+	MidiFile midifile;
+	if (!midifile.read(options.getArg(1))) {
+		cerr << "Error: could not read MIDI file" << endl;
+		return 1;
+	}
+
+	MidiPlayer player(midifile);
+	player.setSpeed(options.getDouble("speed"));
+
+	MidiStreamSink stream;
+	MidiRecorderSink recorder;
+	if (options.getBoolean("output")) {
+		if (!stream.open(options.getString("output"))) {
+			return 1;
+		}
+		player.setSink(&stream);
+	} else {
+		player.setSink(&recorder);
+	}
+
+	if (!player.play()) {
+		return 1;
+	}
+
+	if (options.getBoolean("recording")) {
+		cout << "scheduled\tactual\tmessage\n";
+		for (int i=0; i<recorder.getEventCount(); i++) {
+			const MidiEvent& event = recorder.getEvent(i);
+			cout << recorder.getScheduledTime(i) << "\t"
+			     << recorder.getActualTime(i) << "\t";
+			for (int j=0; j<(int)event.size(); j++) {
+				cout << hex << (int)event[j] << dec << (j < (int)event.size() - 1 ? " " : "");
+			}
+			cout << "\n";
+		}
+	}
+
+	if (!options.getBoolean("quiet")) {
+		cerr << "events:\t\t"       << player.getJitterCount()            << endl;
+		cerr << "mean jitter:\t"    << player.getMeanJitter() * 1.0e6      << " us" << endl;
+		cerr << "min jitter:\t"     << player.getMinJitter() * 1.0e6       << " us" << endl;
+		cerr << "max jitter:\t"     << player.getMaxJitter() * 1.0e6       << " us" << endl;
+		cerr << "jitter std dev:\t" << player.getJitterDeviation() * 1.0e6 << " us" << endl;
+		cerr << "queue overruns:\t" << player.getOverrunCount()           << endl;
+	}
+
+	return 0;
+}
+
+
+
@@ -2,6 +2,7 @@
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Jul 26 13:10:22 PDT 2010
 // Last Modified: Mon Feb  9 20:34:40 PST 2015 Updated for C++11.
+// Last Modified: Wed Oct 21 09:26:15 PDT 2026 Join tracks with TrackMerger.
 // Filename:      ...sig/doc/examples/all/miditime/miditime.cpp
 // Syntax:        C++
 //
@@ -11,6 +12,7 @@
 
 #include "Options.h"
 #include "MidiFile.h"
+#include "TrackMerger.h"
 #include <stdlib.h>
 #include <iostream>
 
@@ -55,15 +57,15 @@ int main(int argc, char** argv) {
 //
 
 void processMidiFile(MidiFile& midifile) {
-   midifile.absoluteTicks();
-   midifile.joinTracks();
-   int eventcount = midifile.getEventCount(0);
-   MidiEvent *ptr;
-   for (int i=0; i<eventcount; i++) {
-      ptr = &(midifile[0][i]);
+   midifile.doTimeAnalysis();
+   // visit all tracks in time order without joining them
+   TrackMerger merger(midifile);
+   while (merger.next()) {
+      const MidiEvent* ptr = &merger.getEvent();
       int track       = ptr->track;
-      int timeinticks = ptr->tick;
-      double timeinsecs  = midifile.getTimeInSeconds(0, i);
+      int timeinticks = merger.getTick();
+      int i           = merger.getPosition();
+      double timeinsecs  = midifile.getTimeInSeconds(timeinticks);
       int attack = ((*ptr)[0] & 0xf0) == 0x90;
       if (onsetQ && !attack) {
          continue;
@@ -0,0 +1,76 @@
+//
+// Creation Date: Tue Oct 20 09:12:05 PDT 2026
+// Filename:      src-programs/notelisttest.cpp
+// Syntax:        C++11
+//
+// Description:   Checks NoteList::write() on a file with many tempo
+//                changes.  In the text format every tempo which differs
+//                from the first is listed in a warning line.  A long run
+//                of them with no notes in between fills the output
+//                buffer several times over, so the buffer has to be
+//                written out after warning lines as well as after note
+//                lines.  Returns 0 if the output
+//                has one line for every note and ignored tempo.
+//
+
+#include "MidiFile.h"
+#include "NoteList.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace std;
+using namespace smf;
+
+///////////////////////////////////////////////////////////////////////////
+
+int main(void) {
+   const int count = 20000;
+
+   MidiFile midifile;
+   midifile.absoluteTicks();
+   midifile.setTPQ(120);
+   for (int i=0; i<count; i++) {
+      // alternating tempos, so every second one is listed
+      midifile.addTempo(0, i * 10, (i % 2) ? 100.0 : 120.0);
+   }
+   for (int i=0; i<count; i++) {
+      // notes after the tempo changes
+      int tick = count * 10 + i * 120;
+      midifile.addNoteOn(0, tick, 0, 60, 64);
+      midifile.addNoteOff(0, tick + 10, 0, 60);
+   }
+   midifile.sortTracks();
+
+   NoteList notelist;
+   notelist.setFormat(NoteList::Text);
+   stringstream output;
+   if (!notelist.write(output, midifile)) {
+      cerr << "Error: could not write the notelist" << endl;
+      return 1;
+   }
+
+   int notes = 0;
+   int warnings = 0;
+   int others = 0;
+   string line;
+   while (getline(output, line)) {
+      if (line.compare(0, 5, "note\t") == 0) {
+         notes++;
+      } else if (line.compare(0, 32, "; WARNING: change of tempo from ") == 0) {
+         warnings++;
+      } else {
+         others++;
+      }
+   }
+
+   cout << "notes:\t\t" << notes << endl;
+   cout << "tempo warnings:\t" << warnings << endl;
+   if (notes != count || warnings != count / 2 || others != 0 ||
+         notelist.getLineCount() != count + count / 2) {
+      cerr << "Error: unexpected notelist output" << endl;
+      return 1;
+   }
+   return 0;
+}
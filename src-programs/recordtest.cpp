@@ -0,0 +1,158 @@
+//
+// Creation Date: Tue Oct 20 10:05:47 PDT 2026
+// Filename:      src-programs/recordtest.cpp
+// Syntax:        C++11
+//
+// Description:   Latency test for MidiRecorder.  A synthetic producer
+//                thread plays the role of a MIDI input callback, sending
+//                note-on/note-off pairs (and an occasional system
+//                exclusive message) at a fixed rate.  The time taken by
+//                each call is collected into a histogram, for both
+//                MidiRecorder::record() and for adding events directly
+//                with MidiFile::addEvent().  The recorded MIDI file is
+//                written to standard output (or the file given with -o).
+//
+
+#include "MidiRecorder.h"
+#include "Options.h"
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <functional>
+
+using namespace std;
+using namespace smf;
+
+typedef chrono::steady_clock Clock;
+
+void   produce          (int count, double rate, vector<long long>& histogram,
+                         function<void(const uchar*, int, double)> callback);
+void   printHistogram   (const string& title, vector<long long>& histogram);
+
+///////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+   Options options;
+   options.define("n|count=i:100000", "Number of messages to send");
+   options.define("r|rate=d:10000",   "Messages per second (0 = no waiting)");
+   options.define("t|tempo=d:90",     "Tempo of recording (quarter notes per minute)");
+   options.define("o|output=s",       "Output MIDI file");
+   options.process(argc, argv);
+
+   int    count = options.getInteger("count");
+   double rate  = options.getDouble("rate");
+
+   // Baseline: add events directly to a MidiFile from the input thread.
+   MidiFile direct;
+   direct.absoluteTicks();
+   vector<long long> directhist;
+   vector<uchar> message;
+   produce(count, rate, directhist, [&](const uchar* data, int size,
+         double seconds) {
+      message.assign(data, data + size);
+      direct.addEvent(0, (int)(seconds * 960), message);
+   });
+   printHistogram("MidiFile::addEvent", directhist);
+
+   // MidiRecorder: the input thread only copies into the ring buffer.
+   MidiFile midifile;
+   midifile.setTPQ(480);
+   midifile.addTempo(0, 0, options.getDouble("tempo"));
+   MidiRecorder recorder;
+   recorder.setChannelTracks(true);
+   recorder.start(midifile);
+   vector<long long> recordhist;
+   produce(count, rate, recordhist, [&](const uchar* data, int size,
+         double seconds) {
+      recorder.record(data, size, seconds);
+   });
+   recorder.stop();
+   printHistogram("MidiRecorder::record", recordhist);
+   cerr << "recorded messages:\t" << recorder.getRecordedCount() << endl;
+   cerr << "dropped messages:\t"  << recorder.getDroppedCount()  << endl;
+
+   if (options.getBoolean("output")) {
+      midifile.write(options.getString("output"));
+   } else {
+      midifile.write(cout);
+   }
+   return 0;
+}
+
+
+
+//////////////////////////////
+//
+// produce -- Send count messages to the callback from a separate thread at
+//     the given rate, and measure the time taken by each call in a
+//     histogram with power-of-two nanosecond bins.
+//
+
+void produce(int count, double rate, vector<long long>& histogram,
+      function<void(const uchar*, int, double)> callback) {
+   histogram.assign(40, 0);
+   thread producer([&]() {
+      uchar sysex[12] = {0xf0, 0x43, 0x12, 0x00, 0x43, 0x12, 0x00, 0x42,
+            0x12, 0x00, 0x43, 0xf7};
+      uchar note[3];
+      Clock::time_point start = Clock::now();
+      for (int i=0; i<count; i++) {
+         double seconds = rate > 0.0 ? i / rate : 0.0;
+         if (rate > 0.0) {
+            this_thread::sleep_until(start + chrono::nanoseconds(
+                  (long long)(seconds * 1.0e9)));
+         }
+         int channel = (i / 2) % 16;
+         note[0] = (i % 2 ? 0x80 : 0x90) | channel;
+         note[1] = 36 + (i / 2) % 60;
+         note[2] = i % 2 ? 0 : 64;
+
+         Clock::time_point before = Clock::now();
+         if (i % 1000 == 999) {
+            callback(sysex, sizeof(sysex), seconds);
+         } else {
+            callback(note, 3, seconds);
+         }
+         long long ns = chrono::duration_cast<chrono::nanoseconds>(
+               Clock::now() - before).count();
+         int bin = 0;
+         while ((ns > 1) && (bin < (int)histogram.size() - 1)) {
+            ns /= 2;
+            bin++;
+         }
+         histogram[bin]++;
+      }
+   });
+   producer.join();
+}
+
+
+
+//////////////////////////////
+//
+// printHistogram -- Print the call time histogram.
+//
+
+void printHistogram(const string& title, vector<long long>& histogram) {
+   cerr << title << " call latency:" << endl;
+   long long total = 0;
+   int maxbin = 0;
+   for (int i=0; i<(int)histogram.size(); i++) {
+      total += histogram[i];
+      if (histogram[i]) {
+         maxbin = i;
+      }
+   }
+   for (int i=0; i<=maxbin; i++) {
+      if (histogram[i] == 0) {
+         continue;
+      }
+      cerr << "\t< " << (1LL << (i + 1)) << " ns:\t" << histogram[i]
+           << "\t(" << 100.0 * histogram[i] / total << "%)" << endl;
+   }
+}
+
+
+
@@ -39,18 +39,8 @@ int main(int argc, char* argv[]) {
 		exit(1);
 	}
 
-	int tpq = midifile.getTicksPerQuarterNote();
 	int newtpq = options.getInteger("tpq");
-	double factor = (double)newtpq / (double)tpq;
-
-	for (int track=0; track<midifile.getTrackCount(); track++) {
-		for (int event=0; event < midifile.getEventCount(track); event++) {
-			MidiEvent& ev = midifile.getEvent(track, event);
-			ev.tick = int(ev.tick * factor + 0.5);
-		}
-	}
-
-	midifile.setTPQ(newtpq);
+	midifile.rescaleTicks(newtpq);
 
 	if (options.getArgCount() > 1) {
 		midifile.write(options.getArg(2));
@@ -78,22 +78,7 @@ int main(int argc, char** argv) {
 
 void doStretch(MidiFile& midifile, double bars, double duration) {
     int ppqn = midifile.getTicksPerQuarterNote();
-    int new_ppqn = max( 24576, ppqn );
-    midifile.setTicksPerQuarterNote( new_ppqn );
-    double tick_mult = (double)new_ppqn / (double)ppqn;
-    tick_mult /= bars;
-
-    for (int t = 0; t < midifile.size(); ++t) {
-	MidiEventList &track = midifile[t];
-	for (int e = 0; e < track.size(); ++e) {
-	    MidiEvent &event = track[e];
-	    event.tick *= (int)(event.tick * tick_mult);
-	    if (event.getMetaType() == 0x51) {
-		double tempo = event.getTempoMicroseconds();
-		tempo *= bars;
-		tempo *= duration;
-		event.setTempoMicroseconds( (int)tempo );
-	    }
-	}
-    }
+    midifile.rescaleTicks(max(24576, ppqn));
+    midifile.stretch(1.0 / bars, true);
+    midifile.stretchTempo(duration);
 }